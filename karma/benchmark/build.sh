@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# This script builds the karma benchmark
+
+# The benchmark builds its own optimized copy of the karma library without
+# the sanitizers, so it does not depend on the build script in the include
+# directory and does not replace the library archive in the karma/lib directory
+
+# After the execution the karma benchmark executable "karma_bench" can be found
+# in the current directory
+
+SCRIPT_DIR=$(cd -- "$(dirname -- "${BASH_SOURCE[0]}")" &>/dev/null && pwd)
+
+CMAKE_ARGS=(
+  -S "${SCRIPT_DIR}"
+  -B "${SCRIPT_DIR}/build"
+)
+
+if [[ -n ${COMPILER+x} ]]; then
+  CMAKE_ARGS+=(-DCMAKE_CXX_COMPILER="${COMPILER}")
+fi
+
+cmake "${CMAKE_ARGS[@]}" &&
+  cmake --build "${SCRIPT_DIR}/build" -j 9
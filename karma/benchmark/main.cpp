@@ -0,0 +1,486 @@
+#include <algorithm>    // for sort, none_of
+#include <chrono>       // for nanoseconds, steady_clock, duration_cast
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint64_t
+#include <cstdlib>      // for EXIT_SUCCESS, EXIT_FAILURE
+#include <exception>    // for exception
+#include <filesystem>   // for path, create_directories
+#include <fstream>      // for ofstream, ifstream
+#include <iomanip>      // for setw, setprecision, fixed
+#include <iostream>     // for cout, cerr
+#include <map>          // for map
+#include <memory>       // for make_shared
+#include <optional>     // for optional
+#include <span>         // for span
+#include <sstream>      // for ostringstream
+#include <stdexcept>    // for runtime_error
+#include <string>       // for string, stod
+#include <string_view>  // for string_view
+#include <utility>      // for pair
+#include <vector>       // for vector
+
+#include <karma>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using Clock       = std::chrono::steady_clock;
+using Nanoseconds = std::chrono::nanoseconds;
+using Config      = karma::Executor::Config;
+
+// the directories are provided by the CMakeLists.txt file, so that
+// the benchmark does not depend on the current working directory
+const fs::path kKarmaDir = fs::path(KARMA_BENCHMARK_DIR).parent_path();
+const fs::path kBuildDir = KARMA_BENCHMARK_BUILD_DIR;
+
+const fs::path kDefaultBaseline =
+    fs::path(KARMA_BENCHMARK_DIR) / "baseline.json";
+const fs::path kDefaultOutput = kBuildDir / "results.json";
+
+constexpr double kDefaultMinTime   = 0.5;
+constexpr double kDefaultThreshold = 10;
+
+// every case is executed at least this many times to get a stable median
+// even for the cases that take longer than the minimum time at once
+constexpr size_t kMinRuns = 3;
+constexpr size_t kMaxRuns = 1000;
+
+struct Case {
+    // the path of the Karma assembler file relative
+    // to the karma directory without the extension
+    std::string name;
+
+    // the canned standard input of the program
+    std::string input;
+};
+
+// all the programs with an entrypoint from the programs directory
+// (the files of the printing library are included by the playgrounds),
+// a new program must be added here to be benchmarked
+const std::vector<Case> kPrograms = {
+    {"programs/docs_samples/01_hello_world",          ""},
+    {"programs/docs_samples/02_square_no_function",   "12345"},
+    {"programs/docs_samples/03_square_function",      "12345"},
+    {"programs/docs_samples/04_factorial_loop",       "12"},
+    {"programs/docs_samples/05_factorial_recursion",  "12"},
+    {"programs/playgrounds/factorial_loop",           "12"},
+    {"programs/playgrounds/factorial_recursion",      "12"},
+    {"programs/playgrounds/fibonacci_loop",           "40"},
+    {"programs/playgrounds/fibonacci_recursion",      "20"},
+    {"programs/playgrounds/hello_world_char_by_char", ""},
+    {"programs/playgrounds/hello_world_smart",        ""},
+    {"programs/playgrounds/printf",                   ""},
+    {"programs/playgrounds/square",                   "12345"},
+    {"programs/playgrounds/threads",                  "60000"},
+    {"programs/print/playgrounds/double",             "3.14159265 10 8"},
+    {"programs/print/playgrounds/int32",              "-123456 16"},
+    {"programs/print/playgrounds/int64",              ""},
+    {"programs/print/playgrounds/printf",             ""},
+    {"programs/print/playgrounds/uint32",             "123456 2"},
+    {"programs/print/playgrounds/uint64",             ""},
+};
+
+// the synthetic kernels stressing the specific parts of the executor
+const std::vector<Case> kKernels = {
+    {"benchmark/kernels/loop",      "300000"},
+    {"benchmark/kernels/recursion", "24"},
+    {"benchmark/kernels/memory",    "65536 8"},
+    {"benchmark/kernels/print",     "1000"},
+};
+
+struct Engine {
+    std::string name;
+    Config::Engine engine;
+
+    // the routines of the printing library are run natively
+    // (see Config::SetIntrinsics), so their output is checked
+    // against the one of the interpreted routines
+    bool intrinsics{false};
+};
+
+const std::vector<Engine> kEngines = {
+    {"mapped", Config::MAPPED},
+    {"table",  Config::TABLE},
+    {"jit",    Config::JIT},
+    {"native", Config::NATIVE},
+    {"intrin", Config::TABLE, true},
+};
+
+struct Options {
+    std::string engine{"all"};
+    std::string filter;
+
+    double min_time{kDefaultMinTime};
+    double threshold{kDefaultThreshold};
+
+    fs::path output{kDefaultOutput};
+    fs::path baseline{kDefaultBaseline};
+};
+
+struct Result {
+    std::string name;
+    std::string engine;
+
+    size_t runs{0};
+    uint64_t instructions{0};
+
+    // compiling and loading are done once per case,
+    // the setup and the run times are the medians over the runs
+    Nanoseconds compile{0};
+    Nanoseconds load{0};
+    Nanoseconds setup{0};
+    Nanoseconds run{0};
+
+    [[nodiscard]] double InstructionsPerSecond() const {
+        if (run.count() == 0) {
+            return 0;
+        }
+
+        return static_cast<double>(instructions) * 1e9 /
+               static_cast<double>(run.count());
+    }
+};
+
+struct BaselineEntry {
+    double instructions_per_second{0};
+    double setup_ns{0};
+};
+
+using Baseline = std::map<std::pair<std::string, std::string>, BaselineEntry>;
+
+Nanoseconds Since(Clock::time_point start) {
+    return std::chrono::duration_cast<Nanoseconds>(Clock::now() - start);
+}
+
+Nanoseconds Median(std::vector<Nanoseconds> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+void PrintUsage() {
+    std::cerr
+        << "usage: karma_bench [options]\n"
+           "  --engine <mapped|table|jit|native|intrin|all>  the engines to "
+           "benchmark (default: all)\n"
+           "  --filter <substring>                           only benchmark "
+           "the cases with the substring in the name\n"
+           "  --min-time <seconds>                           the minimal time "
+           "to execute each case for (default: 0.5)\n"
+           "  --output <path>                                the JSON results "
+           "file (default: build/results.json)\n"
+           "  --baseline <path>                              the JSON results "
+           "to compare against (default: baseline.json)\n"
+           "  --threshold <percent>                          the slowdown to "
+           "report as a regression (default: 10)\n";
+}
+
+std::optional<Options> ParseOptions(int argc, char** argv) {
+    Options options;
+
+    const std::vector<std::string_view> args(argv + 1, argv + argc);
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (i + 1 == args.size()) {
+            return std::nullopt;
+        }
+
+        const std::string_view flag = args[i];
+        const std::string value{args[++i]};
+
+        try {
+            if (flag == "--engine") {
+                options.engine = value;
+            } else if (flag == "--filter") {
+                options.filter = value;
+            } else if (flag == "--min-time") {
+                options.min_time = std::stod(value);
+            } else if (flag == "--output") {
+                options.output = value;
+            } else if (flag == "--baseline") {
+                options.baseline = value;
+            } else if (flag == "--threshold") {
+                options.threshold = std::stod(value);
+            } else {
+                return std::nullopt;
+            }
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    if (options.engine != "all" &&
+        std::none_of(kEngines.begin(), kEngines.end(), [&](const auto& engine) {
+            return engine.name == options.engine;
+        })) {
+        return std::nullopt;
+    }
+
+    return options;
+}
+
+// the results file is written by this program with a single case per line,
+// so reading it does not need a general purpose JSON parser
+std::optional<std::string> Field(std::string_view line, std::string_view key) {
+    std::string pattern = "\"";
+    pattern.append(key).append("\": ");
+
+    size_t begin = line.find(pattern);
+    if (begin == std::string_view::npos) {
+        return std::nullopt;
+    }
+    begin += pattern.size();
+
+    if (line[begin] == '"') {
+        ++begin;
+        return std::string(line.substr(begin, line.find('"', begin) - begin));
+    }
+
+    const size_t end = line.find_first_of(",}", begin);
+    return std::string(line.substr(begin, end - begin));
+}
+
+Baseline ReadBaseline(const fs::path& path) {
+    Baseline baseline;
+
+    std::ifstream in(path);
+    std::string line;
+
+    while (std::getline(in, line)) {
+        const auto name   = Field(line, "name");
+        const auto engine = Field(line, "engine");
+        const auto ips    = Field(line, "instructions_per_second");
+        const auto setup  = Field(line, "setup_ns");
+
+        if (!name || !engine || !ips || !setup) {
+            continue;
+        }
+
+        baseline[{*name, *engine}] = {std::stod(*ips), std::stod(*setup)};
+    }
+
+    return baseline;
+}
+
+void WriteResults(const fs::path& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+
+    out << "{\n  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+
+        out << "    {\"name\": \"" << result.name << "\", "
+            << "\"engine\": \"" << result.engine << "\", "
+            << "\"runs\": " << result.runs << ", "
+            << "\"instructions\": " << result.instructions << ", "
+            << "\"compile_ns\": " << result.compile.count() << ", "
+            << "\"load_ns\": " << result.load.count() << ", "
+            << "\"setup_ns\": " << result.setup.count() << ", "
+            << "\"run_ns\": " << result.run.count() << ", "
+            << "\"instructions_per_second\": " << std::fixed
+            << std::setprecision(0) << result.InstructionsPerSecond() << "}"
+            << (i + 1 == results.size() ? "" : ",") << '\n';
+    }
+
+    out << "  ]\n}\n";
+}
+
+// the relative change of the value compared to the baseline in percents
+std::string Change(double value, double baseline) {
+    if (baseline == 0) {
+        return "-";
+    }
+
+    std::ostringstream out;
+    out << std::showpos << std::fixed << std::setprecision(1)
+        << (value / baseline - 1) * 100 << '%';
+    return out.str();
+}
+
+// compiles the case once and executes it with each of the requested engines
+// for at least the minimum time, all the engines must produce the same output
+std::vector<Result> Benchmark(const Case& bench_case, const Options& options) {
+    const fs::path src  = kKarmaDir / (bench_case.name + ".krm");
+    const fs::path exec = kBuildDir / "execs" / (bench_case.name + ".a");
+
+    fs::create_directories(exec.parent_path());
+
+    auto start = Clock::now();
+    karma::Compiler::MustCompile(src.string(), exec.string());
+    const Nanoseconds compile = Since(start);
+
+    start                = Clock::now();
+    const auto program   = karma::Executor::Program::MustLoad(exec.string());
+    const Nanoseconds load = Since(start);
+
+    // the native module is translated (and compiled by the C compiler)
+    // only if the native engine is benchmarked
+    fs::path module = exec;
+    module.replace_extension(".so");
+
+    if (options.engine == "all" || options.engine == "native") {
+        karma::Translator::MustTranslate(exec.string(), module.string());
+    }
+
+    std::vector<Result> results;
+    std::optional<std::string> expected_output;
+
+    for (const auto& [engine_name, engine, intrinsics] : kEngines) {
+        if (options.engine != "all" && options.engine != engine_name) {
+            continue;
+        }
+
+        Result result{
+            .name    = bench_case.name,
+            .engine  = engine_name,
+            .compile = compile,
+            .load    = load,
+        };
+
+        std::vector<Nanoseconds> setups;
+        std::vector<Nanoseconds> runs;
+        Nanoseconds total{0};
+
+        karma::Executor executor;
+
+        const auto enough = [&] {
+            return result.runs >= kMaxRuns ||
+                   (result.runs >= kMinRuns &&
+                    std::chrono::duration<double>(total).count() >=
+                        options.min_time);
+        };
+
+        while (!enough()) {
+            const auto output =
+                std::make_shared<karma::Executor::StringOutput>();
+            const auto stats =
+                std::make_shared<karma::Executor::ExecutionStats>();
+
+            Config config;
+            config.SetEngine(engine);
+            config.SetIntrinsics(intrinsics);
+            config.SetNativeModule(module.string());
+            config.SetInput(std::make_shared<karma::Executor::SpanInput>(
+                std::span<const char>(bench_case.input)));
+            config.SetOutput(output);
+            config.SetStats(stats);
+
+            executor.MustExecute(program, config);
+
+            if (!expected_output) {
+                expected_output = output->Data();
+            } else if (*expected_output != output->Data()) {
+                throw std::runtime_error("the output of the " + engine_name +
+                                         " engine differs from the expected");
+            }
+
+            setups.push_back(stats->setup.wall);
+            runs.push_back(stats->run.wall);
+            total += stats->setup.wall + stats->run.wall;
+
+            result.instructions = stats->instructions;
+            ++result.runs;
+        }
+
+        result.setup = Median(setups);
+        result.run   = Median(runs);
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void PrintHeader() {
+    std::cout << std::left << std::setw(48) << "case" << std::setw(8)
+              << "engine" << std::right << std::setw(6) << "runs"
+              << std::setw(12) << "instr" << std::setw(12) << "run ms"
+              << std::setw(12) << "Minstr/s" << std::setw(12) << "setup us"
+              << std::setw(10) << "vs base" << '\n';
+}
+
+// returns whether the result is a regression compared to the baseline
+bool PrintResult(const Result& result,
+                 const Baseline& baseline,
+                 double threshold) {
+    const auto it = baseline.find({result.name, result.engine});
+
+    std::string change = "-";
+    bool regression    = false;
+
+    if (it != baseline.end()) {
+        const double base = it->second.instructions_per_second;
+
+        change     = Change(result.InstructionsPerSecond(), base);
+        regression = base != 0 && result.InstructionsPerSecond() <
+                                      base * (1 - threshold / 100);
+    }
+
+    std::cout << std::left << std::setw(48) << result.name << std::setw(8)
+              << result.engine << std::right << std::setw(6) << result.runs
+              << std::setw(12) << result.instructions << std::fixed
+              << std::setprecision(3) << std::setw(12)
+              << static_cast<double>(result.run.count()) / 1e6
+              << std::setprecision(1) << std::setw(12)
+              << result.InstructionsPerSecond() / 1e6 << std::setw(12)
+              << static_cast<double>(result.setup.count()) / 1e3
+              << std::setw(10) << change << (regression ? " !" : "") << '\n';
+
+    return regression;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    const Baseline baseline = ReadBaseline(options->baseline);
+
+    std::vector<Case> cases = kPrograms;
+    cases.insert(cases.end(), kKernels.begin(), kKernels.end());
+
+    std::vector<Result> results;
+    size_t failures    = 0;
+    size_t regressions = 0;
+
+    PrintHeader();
+
+    for (const Case& bench_case : cases) {
+        if (bench_case.name.find(options->filter) == std::string::npos) {
+            continue;
+        }
+
+        try {
+            for (const Result& result : Benchmark(bench_case, *options)) {
+                regressions +=
+                    PrintResult(result, baseline, options->threshold);
+                results.push_back(result);
+            }
+        } catch (const std::exception& e) {
+            std::cout << bench_case.name << ": " << e.what() << '\n';
+            ++failures;
+        }
+    }
+
+    WriteResults(options->output, results);
+
+    std::cout << "\nthe results are written to " << options->output.string()
+              << '\n';
+
+    if (baseline.empty()) {
+        std::cout << "no baseline found at " << options->baseline.string()
+                  << '\n';
+    } else {
+        std::cout << regressions << " regression(s) by more than "
+                  << std::defaultfloat << std::setprecision(6)
+                  << options->threshold << "% compared to "
+                  << options->baseline.string() << '\n';
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -16,8 +16,14 @@ struct CompileError;
 
 }  // namespace errors::compiler
 
+class Executor;
+
 class Compiler {
    private:
+    // compiles the programs directly into the memory
+    // (see Executor::Program::MustCompile)
+    friend class Executor;
+
     friend struct errors::compiler::Error;
     friend struct errors::compiler::InternalError;
     friend struct errors::compiler::CompileError;
@@ -3,10 +3,12 @@
 #include <cstddef>   // for size_t
 #include <optional>  // for optional
 #include <ostream>   // for ostream
+#include <string>    // for string
 #include <utility>   // for move
 #include <vector>    // for vector
 
 #include "exec/exec.hpp"
+#include "exec/symbols.hpp"
 #include "specs/architecture.hpp"
 #include "utils/vector.hpp"
 
@@ -25,6 +27,13 @@ void Compiler::Data::Merge(Data&& other) {
 
     utils::vector::Append(code_, used.code_);
     utils::vector::Append(constants_, used.constants_);
+
+    for (const SourceLine& line : used.lines_) {
+        lines_.push_back(
+            {.file = line.file + files_.size(), .line = line.line});
+    }
+
+    utils::vector::Append(files_, used.files_);
 }
 
 void Compiler::Data::CheckEntrypoint() {
@@ -72,6 +81,26 @@ void Compiler::Data::SubstituteLabels() {
     entrypoint_.SetAddress(static_cast<arch::Address>(*definition));
 }
 
+Exec::Symbols Compiler::Data::PrepareSymbols() const {
+    Exec::Symbols symbols;
+
+    for (auto& [definition, label] : labels_.GetDefinitions()) {
+        symbols.labels.push_back(
+            {.address = static_cast<arch::Address>(definition),
+             .name    = std::move(label)});
+    }
+
+    symbols.files = files_;
+
+    for (size_t idx = 0; idx < lines_.size(); ++idx) {
+        symbols.lines.push_back({.address = static_cast<arch::Address>(idx),
+                                 .file    = lines_[idx].file,
+                                 .line    = lines_[idx].line});
+    }
+
+    return symbols;
+}
+
 Compiler::Data Compiler::Data::MergeAll(std::vector<Data>& all) {
     Data res;
     for (auto& data : all) {
@@ -89,7 +118,11 @@ Exec::Data Compiler::Data::ToExecData(std::ostream& log) && {
     SubstituteLabels();
     log << "[compiler]: successfully substituted labels\n";
 
-    return {
+    log << "[compiler]: preparing the debug info\n";
+    std::string symbols = Exec::EncodeSymbols(PrepareSymbols());
+    log << "[compiler]: successfully prepared the debug info\n";
+
+    Exec::Data data{
         // we have checked the presence of the entrypoint in the beginning
         // of this function, and the labels substitution never unsets it
         // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
@@ -98,6 +131,9 @@ Exec::Data Compiler::Data::ToExecData(std::ostream& log) && {
         std::move(code_),
         std::move(constants_),
     };
+    data.symbols = std::move(symbols);
+
+    return data;
 }
 
 }  // namespace karma
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>  // for size_t
 #include <ostream>  // for ostream
+#include <string>   // for string
 #include <vector>   // for vector
 
 #include "compiler/compiler.hpp"
@@ -22,11 +24,22 @@ class Compiler::Data : detail::utils::traits::NonCopyableMovable {
     using InternalError = errors::compiler::InternalError::Builder;
     using CompileError  = errors::compiler::CompileError::Builder;
 
+   private:
+    struct SourceLine {
+        // the index of the file in the files_ vector
+        size_t file{0};
+        size_t line{0};
+    };
+
    private:
     void Merge(Data&& other);
     void CheckEntrypoint();
     void SubstituteLabels();
 
+    // the debug info of the program, the code size
+    // must already be set for the labels
+    [[nodiscard]] Exec::Symbols PrepareSymbols() const;
+
    public:
     static Data MergeAll(std::vector<Data>&);
 
@@ -37,6 +50,11 @@ class Compiler::Data : detail::utils::traits::NonCopyableMovable {
     Entrypoint entrypoint_;
     std::vector<detail::specs::arch::Word> code_;
     std::vector<detail::specs::arch::Word> constants_;
+
+    // the paths of the compiled files and the source line
+    // of each command of the code_ vector
+    std::vector<std::string> files_;
+    std::vector<SourceLine> lines_;
 };
 
 }  // namespace karma
@@ -551,6 +551,7 @@ void Compiler::FileCompiler::ProcessCurrLine(bool is_first_line) {
     }
 
     data_.code_.push_back(MustParseCommand());
+    data_.lines_.push_back({.file = 0, .line = file_->LineNum()});
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -558,6 +559,10 @@ void Compiler::FileCompiler::ProcessCurrLine(bool is_first_line) {
 ////////////////////////////////////////////////////////////////////////////////
 
 Compiler::Data Compiler::FileCompiler::PrepareData() && {
+    // the lines of the commands refer to the only file of the data
+    // until it is merged with the others
+    data_.files_.push_back(file_->Path().string());
+
     file_->Open();
 
     SkipIncludes();
@@ -1,7 +1,7 @@
 #include "impl.hpp"
 
 #include <algorithm>   // for min
-#include <exception>   // for exception
+#include <exception>   // for exception, exception_ptr, rethrow_exception
 #include <filesystem>  // for path
 #include <iostream>    // for ostream, cerr
 #include <memory>      // for std::unique_ptr
@@ -62,6 +62,10 @@ Exec::Data Compiler::Impl::PrepareExecData(const Files& files,
     std::vector<Data> files_data(files.size());
     std::vector<std::thread> workers;
 
+    // an exception escaping a thread terminates the process, so the errors
+    // of the workers are rethrown once all of them are joined
+    std::vector<std::exception_ptr> worker_errors(n_workers);
+
     const size_t rough_n_files_per_worker = files.size() / n_workers;
     const size_t n_workers_more_files     = files.size() % n_workers;
 
@@ -75,12 +79,19 @@ Exec::Data Compiler::Impl::PrepareExecData(const Files& files,
             ++n_files_per_worker;
         }
 
-        workers.emplace_back(
-            [files_start, data_start, n_files_per_worker, &log]() {
+        workers.emplace_back([files_start,
+                              data_start,
+                              n_files_per_worker,
+                              &error = worker_errors[idx],
+                              &log]() {
+            try {
                 CompileRoutine({files_start, n_files_per_worker},
                                {data_start, n_files_per_worker},
                                log);
-            });
+            } catch (...) {
+                error = std::current_exception();
+            }
+        });
 
         files_start += static_cast<DiffT>(n_files_per_worker);
         data_start += static_cast<DiffT>(n_files_per_worker);
@@ -90,6 +101,12 @@ Exec::Data Compiler::Impl::PrepareExecData(const Files& files,
         worker.join();
     }
 
+    for (const std::exception_ptr& error : worker_errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
     return Data::MergeAll(files_data).ToExecData(log);
 }
 
@@ -97,10 +114,9 @@ Exec::Data Compiler::Impl::PrepareExecData(const Files& files,
 ///                             Compile from file                            ///
 ////////////////////////////////////////////////////////////////////////////////
 
-void Compiler::Impl::CompileImpl(const std::string& src,
-                                 const std::string& dst,
-                                 size_t n_workers,
-                                 std::ostream& log) {
+Exec::Data Compiler::Impl::CompileDataImpl(const std::string& src,
+                                           size_t n_workers,
+                                           std::ostream& log) {
     log << "[compiler]: parsing includes\n";
 
     const Files files = IncludesManager().GetFiles(src);
@@ -108,7 +124,14 @@ void Compiler::Impl::CompileImpl(const std::string& src,
     log << "[compiler]: successfully parsed includes, obtained " << files.size()
         << " files\n";
 
-    const Exec::Data data = PrepareExecData(files, n_workers, log);
+    return PrepareExecData(files, n_workers, log);
+}
+
+void Compiler::Impl::CompileImpl(const std::string& src,
+                                 const std::string& dst,
+                                 size_t n_workers,
+                                 std::ostream& log) {
+    const Exec::Data data = CompileDataImpl(src, n_workers, log);
 
     std::string exec_path = dst;
     if (exec_path.empty()) {
@@ -127,14 +150,12 @@ void Compiler::Impl::CompileImpl(const std::string& src,
     log << "[compiler]: successfully written exec data to file\n";
 }
 
-void Compiler::Impl::MustCompile(const std::string& src,
-                                 const std::string& dst,
-                                 size_t n_workers,
-                                 std::ostream& log) {
+template <typename Function>
+auto Compiler::Impl::WrapErrors(Function function, std::ostream& log) {
     using std::string_literals::operator""s;
 
     try {
-        CompileImpl(src, dst, n_workers, log);
+        return function();
     } catch (const errors::compiler::Error& e) {
         log << "[compiler]: error: " << e.what() << '\n';
         throw e;
@@ -156,6 +177,24 @@ void Compiler::Impl::MustCompile(const std::string& src,
     }
 }
 
+size_t Compiler::Impl::DefaultWorkers() {
+    return kDefaultWorkers;
+}
+
+void Compiler::Impl::MustCompile(const std::string& src,
+                                 const std::string& dst,
+                                 size_t n_workers,
+                                 std::ostream& log) {
+    WrapErrors([&] { CompileImpl(src, dst, n_workers, log); }, log);
+}
+
+Exec::Data Compiler::Impl::MustCompile(const std::string& src,
+                                       size_t n_workers,
+                                       std::ostream& log) {
+    return WrapErrors([&] { return CompileDataImpl(src, n_workers, log); },
+                      log);
+}
+
 void Compiler::Impl::Compile(const std::string& src,
                              const std::string& dst,
                              size_t n_workers,
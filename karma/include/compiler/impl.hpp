@@ -27,12 +27,31 @@ class Compiler::Impl : detail::utils::traits::Static {
                                       size_t n_workers,
                                       std::ostream& log);
 
+    static Exec::Data CompileDataImpl(const std::string& src,
+                                      size_t n_workers,
+                                      std::ostream& log);
+
     static void CompileImpl(const std::string& src,
                             const std::string& dst,
                             size_t n_workers,
                             std::ostream& log);
 
+    // converts all the exceptions thrown by the function
+    // into the errors of the compiler block
+    template <typename Function>
+    static auto WrapErrors(Function, std::ostream& log);
+
    public:
+    [[nodiscard]] static size_t DefaultWorkers();
+
+    // the same as the MustCompile method, but return the compiled
+    // exec data instead of writing it to the executable file, which is
+    // used to execute the program without the intermediate file
+    // (see Executor::Program::MustCompile)
+    static Exec::Data MustCompile(const std::string& src,
+                                  size_t n_workers,
+                                  std::ostream& log);
+
     static void MustCompile(const std::string& src,
                             const std::string& dst,
                             size_t n_workers,
@@ -1,9 +1,12 @@
 #include "labels.hpp"
 
-#include <cctype>    // for is_digit
-#include <cstddef>   // for size_t
-#include <optional>  // for optional
-#include <string>    // for string
+#include <algorithm>  // for sort
+#include <cctype>     // for is_digit
+#include <cstddef>    // for size_t
+#include <optional>   // for optional
+#include <string>     // for string
+#include <utility>    // for pair
+#include <vector>     // for vector
 
 #include "compiler/compiler.hpp"
 #include "specs/syntax.hpp"
@@ -101,6 +104,24 @@ std::optional<size_t> Compiler::Labels::TryGetDefinition(
     return std::nullopt;
 }
 
+std::vector<std::pair<size_t, std::string>>
+Compiler::Labels::GetDefinitions() const {
+    std::vector<std::pair<size_t, std::string>> definitions;
+    definitions.reserve(commands_labels_.size() + constants_labels_.size());
+
+    for (const auto& [label, definition] : commands_labels_) {
+        definitions.emplace_back(definition.first, label);
+    }
+
+    for (const auto& [label, definition] : constants_labels_) {
+        definitions.emplace_back(code_size_ + definition.first, label);
+    }
+
+    std::sort(definitions.begin(), definitions.end());
+
+    return definitions;
+}
+
 void Compiler::Labels::RecordCommandLabel(const std::string& label,
                                           size_t definition,
                                           const std::string& pos) {
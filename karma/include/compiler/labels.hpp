@@ -41,6 +41,12 @@ class Compiler::Labels : detail::utils::traits::NonCopyableMovable {
     [[nodiscard]] std::optional<size_t> TryGetDefinition(
         const std::string& label) const;
 
+    // the addresses and the names of all the defined labels sorted by
+    // the address and then by the name, which are put to the debug info
+    // of the program, the code size must already be set
+    [[nodiscard]] std::vector<std::pair<size_t, std::string>> GetDefinitions()
+        const;
+
     void RecordCommandLabel(const std::string& label,
                             size_t definition,
                             const std::string& pos);
@@ -16,8 +16,14 @@ struct DisassembleError;
 
 }  // namespace errors::disassembler
 
+class Executor;
+
 class Disassembler {
    private:
+    // the executor profiler reports the executed commands
+    // the same way as they are disassembled
+    friend class Executor;
+
     friend struct errors::disassembler::Error;
     friend struct errors::disassembler::InternalError;
     friend struct errors::disassembler::DisassembleError;
@@ -6,12 +6,14 @@
 #include <fstream>      // for ofstream
 #include <iomanip>      // for setprecision
 #include <iostream>     // for cerr
+#include <optional>     // for optional
 #include <sstream>      // for ostringstream
 #include <string>       // for string
 #include <type_traits>  // for make_signed_t
 
 #include "disassembler/labels.hpp"
 #include "exec/exec.hpp"
+#include "exec/symbols.hpp"
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
 #include "specs/constants.hpp"
@@ -317,7 +319,7 @@ void Disassembler::Impl::DisassembleCode(const Segment& code,
         out << "    " << GetCommandString(code[command_num], labels) << '\n';
     }
 
-    out << "end " << Labels::MainLabel() << '\n';
+    out << "end " << labels.EntrypointLabel() << '\n';
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -335,6 +337,20 @@ void Disassembler::Impl::DisassembleImpl(const std::string& src,
 
     Labels labels;
 
+    // the original labels are used if the program has the debug info
+    if (!data.symbols.empty()) {
+        log << "[disassembler]: decoding the debug info\n";
+
+        if (std::optional<Exec::Symbols> symbols =
+                Exec::DecodeSymbols(data.symbols)) {
+            labels.RecordSymbols(*symbols, data);
+            log << "[disassembler]: successfully decoded the debug info\n";
+        } else {
+            log << "[disassembler]: the debug info is corrupted, "
+                   "generating the labels\n";
+        }
+    }
+
     log << "[disassembler]: disassembling constants\n";
 
     DisassembleConstants(data.constants, out, labels, data.code.size());
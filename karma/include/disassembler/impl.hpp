@@ -14,6 +14,10 @@
 namespace karma {
 
 class Disassembler::Impl : detail::utils::traits::Static {
+   private:
+    // see the Disassembler class
+    friend class Executor;
+
    private:
     using InternalError    = errors::disassembler::InternalError::Builder;
     using DisassembleError = errors::disassembler::DisassembleError::Builder;
@@ -1,5 +1,6 @@
 #include "labels.hpp"
 
+#include <cstddef>   // for size_t
 #include <optional>  // for optional, nullopt
 #include <set>       // for set
 #include <string>    // for string, to_string
@@ -7,6 +8,7 @@
 #include "disassembler/disassembler.hpp"
 #include "disassembler/errors.hpp"
 #include "exec/exec.hpp"
+#include "exec/symbols.hpp"
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
 
@@ -15,9 +17,45 @@ namespace karma {
 namespace arch = detail::specs::arch;
 namespace cmd  = detail::specs::cmd;
 
+std::string Disassembler::Labels::GenerateLabel(const std::string& prefix,
+                                                size_t& counter) {
+    std::string label;
+    do {
+        label = prefix + std::to_string(++counter);
+    } while (taken_.contains(label));
+
+    taken_.insert(label);
+
+    return label;
+}
+
+void Disassembler::Labels::RecordSymbols(const Exec::Symbols& symbols,
+                                         const Exec::Data& data) {
+    const size_t code_end      = data.code.size();
+    const size_t constants_end = code_end + data.constants.size();
+
+    for (const Exec::Symbols::Label& label : symbols.labels) {
+        if (label.address >= constants_end || taken_.contains(label.name)) {
+            continue;
+        }
+
+        LabelsMap& labels =
+            label.address < code_end ? command_labels_ : constant_labels_;
+
+        // only the first of the labels defined at the same address is used
+        if (labels.try_emplace(label.address, label.name).second) {
+            taken_.insert(label.name);
+        }
+    }
+}
+
 std::string Disassembler::Labels::RecordConstantLabel(arch::Address address) {
+    if (constant_labels_.contains(address)) {
+        return constant_labels_.at(address);
+    }
+
     std::string label =
-        kConstantLabelPrefix + std::to_string(constant_labels_.size() + 1);
+        GenerateLabel(kConstantLabelPrefix, n_generated_constant_labels_);
 
     constant_labels_[address] = label;
 
@@ -64,23 +102,33 @@ void Disassembler::Labels::PrepareCommandLabels(const Exec::Data& data) {
         }
     }
 
-    command_labels_[data.entrypoint] = kMainLabel;
+    // the entrypoint has a special label unless it is labeled
+    // in the debug info of the program
+    if (command_labels_.contains(data.entrypoint)) {
+        entrypoint_label_ = command_labels_.at(data.entrypoint);
+    } else {
+        if (taken_.contains(kMainLabel)) {
+            entrypoint_label_ =
+                GenerateLabel(kCommandLabelPrefix, n_generated_command_labels_);
+        } else {
+            taken_.insert(kMainLabel);
+        }
+
+        command_labels_[data.entrypoint] = entrypoint_label_;
+    }
 
     for (const arch::Address address : command_labels_addresses) {
-        // the entrypoint has a special label
-        if (address == data.entrypoint) {
+        if (command_labels_.contains(address)) {
             continue;
         }
 
-        // indexing labels with command_labels_.size() will start with 1
-        // since we have already written the entrypoint label
         command_labels_[address] =
-            kCommandLabelPrefix + std::to_string(command_labels_.size());
+            GenerateLabel(kCommandLabelPrefix, n_generated_command_labels_);
     }
 }
 
-std::string Disassembler::Labels::MainLabel() {
-    return kMainLabel;
+std::string Disassembler::Labels::EntrypointLabel() const {
+    return entrypoint_label_;
 }
 
 std::optional<std::string> Disassembler::Labels::TryGetLabel(
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstddef>        // for size_t
 #include <optional>       // for optional
 #include <string>         // for string
 #include <unordered_map>  // for unordered_map
+#include <unordered_set>  // for unordered_set
 
 #include "disassembler/disassembler.hpp"
 #include "exec/exec.hpp"
+#include "exec/symbols.hpp"
 #include "specs/architecture.hpp"
 #include "utils/traits.hpp"
 
@@ -19,11 +22,21 @@ class Disassembler::Labels : detail::utils::traits::NonCopyableMovable {
 
     using DisassembleError = errors::disassembler::DisassembleError::Builder;
 
+   private:
+    // the next label with the prefix, which is not taken by the labels
+    // from the debug info of the program
+    std::string GenerateLabel(const std::string& prefix, size_t& counter);
+
    public:
+    // records the labels from the debug info of the program (if any),
+    // so that the original labels are used instead of the generated ones,
+    // must be called before the other Record/Prepare methods
+    void RecordSymbols(const Exec::Symbols&, const Exec::Data&);
+
     std::string RecordConstantLabel(detail::specs::arch::Address);
     void PrepareCommandLabels(const Exec::Data&);
 
-    static std::string MainLabel();
+    [[nodiscard]] std::string EntrypointLabel() const;
     [[nodiscard]] std::optional<std::string> TryGetLabel(
         detail::specs::arch::Address) const;
 
@@ -34,6 +47,12 @@ class Disassembler::Labels : detail::utils::traits::NonCopyableMovable {
 
     LabelsMap command_labels_;
     LabelsMap constant_labels_;
+
+    std::unordered_set<std::string> taken_;
+    size_t n_generated_constant_labels_{0};
+    size_t n_generated_command_labels_{0};
+
+    std::string entrypoint_label_{kMainLabel};
 };
 
-}  // namespace karma
\ No newline at end of file
+}  // namespace karma
@@ -19,10 +19,12 @@ FE FE::Builder::FailedToOpen(const std::string& path) {
     return {ss.str(), path};
 }
 
-FE FE::Builder::TooSmallForHeader(size_t size, const std::string& path) {
+FE FE::Builder::TooSmallForHeader(size_t size,
+                                  size_t header_size,
+                                  const std::string& path) {
     std::ostringstream ss;
-    ss << "exec size is " << size << ", which is less than "
-       << exec::kHeaderSize << " bytes required for the header";
+    ss << "exec size is " << size << ", which is less than " << header_size
+       << " bytes required for the header";
     return {ss.str(), path};
 }
 
@@ -76,4 +78,65 @@ FE FE::Builder::InvalidProcessorID(arch::Word processor_id,
     return {ss.str(), path};
 }
 
+FE FE::Builder::UnsupportedVersion(arch::Word version,
+                                   const std::string& path) {
+    std::ostringstream ss;
+    ss << "exec file has version " << version
+       << ", supported version: " << exec::kVersion;
+    return {ss.str(), path};
+}
+
+FE FE::Builder::SectionTableOutOfFile(size_t n_sections,
+                                      size_t exec_size,
+                                      const std::string& path) {
+    std::ostringstream ss;
+    ss << "the section table of " << n_sections
+       << " sections does not fit into the exec file of size " << exec_size;
+    return {ss.str(), path};
+}
+
+FE FE::Builder::SectionOutOfFile(arch::Word kind,
+                                 size_t offset,
+                                 size_t stored_size,
+                                 size_t exec_size,
+                                 const std::string& path) {
+    std::ostringstream ss;
+    ss << "section " << kind << " is stored at offset " << offset
+       << " and takes " << stored_size
+       << " bytes, which does not fit into the exec file of size "
+       << exec_size;
+    return {ss.str(), path};
+}
+
+FE FE::Builder::InvalidSectionSize(arch::Word kind,
+                                   size_t size,
+                                   const std::string& path) {
+    std::ostringstream ss;
+    ss << "section " << kind << " has size " << size
+       << ", which is not a whole number of words or does not fit into "
+          "the memory";
+    return {ss.str(), path};
+}
+
+FE FE::Builder::DuplicateSection(arch::Word kind, const std::string& path) {
+    std::ostringstream ss;
+    ss << "section " << kind << " is specified more than once";
+    return {ss.str(), path};
+}
+
+FE FE::Builder::UnknownEncoding(arch::Word kind,
+                                arch::Word encoding,
+                                const std::string& path) {
+    std::ostringstream ss;
+    ss << "section " << kind << " is stored in unknown encoding " << encoding;
+    return {ss.str(), path};
+}
+
+FE FE::Builder::CorruptedSection(arch::Word kind, const std::string& path) {
+    std::ostringstream ss;
+    ss << "the contents of section " << kind
+       << " do not match its size specified in the section table";
+    return {ss.str(), path};
+}
+
 }  // namespace karma::errors::exec
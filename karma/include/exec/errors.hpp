@@ -13,6 +13,7 @@ struct ExecFileError::Builder : detail::utils::traits::Static {
     static ExecFileError FailedToOpen(const std::string& path);
 
     static ExecFileError TooSmallForHeader(size_t size,
+                                           size_t header_size,
                                            const std::string& path);
 
     static ExecFileError TooBigForMemory(size_t size, const std::string& path);
@@ -30,6 +31,33 @@ struct ExecFileError::Builder : detail::utils::traits::Static {
 
     static ExecFileError InvalidProcessorID(
         detail::specs::arch::Word processor_id, const std::string& path);
+
+    static ExecFileError UnsupportedVersion(detail::specs::arch::Word version,
+                                            const std::string& path);
+
+    static ExecFileError SectionTableOutOfFile(size_t n_sections,
+                                               size_t exec_size,
+                                               const std::string& path);
+
+    static ExecFileError SectionOutOfFile(detail::specs::arch::Word kind,
+                                          size_t offset,
+                                          size_t stored_size,
+                                          size_t exec_size,
+                                          const std::string& path);
+
+    static ExecFileError InvalidSectionSize(detail::specs::arch::Word kind,
+                                            size_t size,
+                                            const std::string& path);
+
+    static ExecFileError DuplicateSection(detail::specs::arch::Word kind,
+                                          const std::string& path);
+
+    static ExecFileError UnknownEncoding(detail::specs::arch::Word kind,
+                                         detail::specs::arch::Word encoding,
+                                         const std::string& path);
+
+    static ExecFileError CorruptedSection(detail::specs::arch::Word kind,
+                                          const std::string& path);
 };
 
 }  // namespace karma::errors::exec
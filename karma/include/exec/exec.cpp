@@ -1,22 +1,163 @@
 #include "exec.hpp"
 
-#include <bit>      // for bit_cast
-#include <cstddef>  // for size_t
-#include <fstream>  // for ifstream, ofstream
-#include <string>   // for string
-#include <vector>   // for vector
+#include <fcntl.h>     // for open, O_RDONLY, O_CLOEXEC
+#include <sys/mman.h>  // for mmap, munmap, PROT_READ, MAP_PRIVATE
+#include <sys/stat.h>  // for fstat, stat
+#include <unistd.h>    // for close
+
+#include <algorithm>    // for find_if, fill_n
+#include <array>        // for array
+#include <cstddef>      // for size_t, ptrdiff_t
+#include <cstdint>      // for uint8_t
+#include <cstring>      // for memcpy
+#include <fstream>      // for ofstream
+#include <optional>     // for optional, nullopt
+#include <span>         // for span
+#include <string>       // for string
+#include <string_view>  // for string_view
+#include <vector>       // for vector
 
 #include "exec/errors.hpp"
+#include "exec/symbols.hpp"
 #include "specs/architecture.hpp"
-#include "specs/commands.hpp"
 #include "specs/exec.hpp"
 
 namespace karma {
 
 namespace arch = detail::specs::arch;
-namespace cmd  = detail::specs::cmd;
 namespace exec = detail::specs::exec;
 
+namespace {
+
+constexpr uint8_t kVarintPayloadBits = 7;
+constexpr uint8_t kVarintPayloadMask = 0x7f;
+constexpr uint8_t kVarintContinue    = 0x80;
+
+void AppendWord(std::string& dst, arch::Word word) {
+    char bytes[arch::kWordSize];
+    std::memcpy(bytes, &word, arch::kWordSize);
+    dst.append(bytes, arch::kWordSize);
+}
+
+void AppendVarint(std::string& dst, arch::Word value) {
+    while (value > kVarintPayloadMask) {
+        dst.push_back(static_cast<char>((value & kVarintPayloadMask) |
+                                        kVarintContinue));
+        value >>= kVarintPayloadBits;
+    }
+
+    dst.push_back(static_cast<char>(value));
+}
+
+// returns false if the varint is truncated or does not fit into a word
+bool ReadVarint(std::span<const char> src, size_t& position, arch::Word& dst) {
+    dst = 0;
+
+    for (size_t shift = 0; shift < arch::kWordSize * 8;
+         shift += kVarintPayloadBits) {
+        if (position >= src.size()) {
+            return false;
+        }
+
+        const auto byte = static_cast<uint8_t>(src[position++]);
+        dst |= static_cast<arch::Word>(byte & kVarintPayloadMask) << shift;
+
+        if ((byte & kVarintContinue) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::string EncodeRaw(std::span<const arch::Word> words) {
+    std::string dst(words.size() * arch::kWordSize, '\0');
+    if (!words.empty()) {
+        std::memcpy(dst.data(), words.data(), dst.size());
+    }
+
+    return dst;
+}
+
+std::string EncodeVarint(std::span<const arch::Word> words) {
+    std::string dst;
+
+    for (size_t start = 0; start < words.size();) {
+        size_t end = start + 1;
+        while (end < words.size() && words[end] == words[start]) {
+            ++end;
+        }
+
+        AppendVarint(dst, static_cast<arch::Word>(end - start));
+        AppendVarint(dst, words[start]);
+
+        start = end;
+    }
+
+    return dst;
+}
+
+// the executable file mapped into the memory for reading,
+// which is unmapped and closed once the file is read
+class MappedFile {
+   public:
+    explicit MappedFile(const std::string& path)
+        : fd_(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+        struct stat file_stat {};
+        if (fd_ < 0 || fstat(fd_, &file_stat) != 0) {
+            return;
+        }
+
+        size_ = static_cast<size_t>(file_stat.st_size);
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            munmap(data_, size_);
+        }
+
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&)                 = delete;
+    MappedFile& operator=(MappedFile&&)      = delete;
+
+    [[nodiscard]] bool IsOpen() const {
+        return fd_ >= 0;
+    }
+
+    [[nodiscard]] size_t Size() const {
+        return size_;
+    }
+
+    // maps the whole file, is only called once the size is validated,
+    // so the file is not empty and the mapping is never of zero length
+    bool Map() {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+
+        data_ = data;
+        return true;
+    }
+
+    [[nodiscard]] const char* Data() const {
+        return static_cast<const char*>(data_);
+    }
+
+   private:
+    int fd_{-1};
+    size_t size_{0};
+    void* data_{nullptr};
+};
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 ///                                   Write                                  ///
 ////////////////////////////////////////////////////////////////////////////////
@@ -29,45 +170,97 @@ void Exec::Write(const Data& data, const std::string& exec_path) {
         throw ExecFileError::Builder::FailedToOpen(exec_path);
     }
 
-    auto write_word = [&binary](arch::Word word) {
-        binary.write(std::bit_cast<char*>(&word), 4);
+    // the trailing zero words of the constants are not stored at all
+    const auto last_nonzero = std::find_if(data.constants.rbegin(),
+                                           data.constants.rend(),
+                                           [](arch::Word word) {
+                                               return word != 0;
+                                           });
+    const std::span<const arch::Word> constants(data.constants.begin(),
+                                                last_nonzero.base());
+    const size_t n_zeros = data.constants.size() - constants.size();
+
+    struct StoredSection {
+        SectionEntry entry;
+        std::string contents;
     };
 
-    // intro string
-    binary << "ThisIsKarmaExec" << '\0';
+    std::vector<StoredSection> sections;
+
+    // each section is stored in the more compact of the encodings
+    auto add_section = [&sections](exec::Section kind,
+                                   std::span<const arch::Word> words) {
+        StoredSection& section = sections.emplace_back();
 
-    auto get_segment_size =
-        [](const std::vector<arch::Word>& vec) -> arch::Word {
-        return static_cast<arch::Word>(vec.size()) *
-               static_cast<arch::Word>(arch::kWordSize);
+        section.entry.kind = kind;
+        section.entry.size =
+            static_cast<arch::Word>(words.size() * arch::kWordSize);
+
+        section.entry.encoding = exec::VARINT;
+        section.contents       = EncodeVarint(words);
+
+        if (section.contents.size() >= section.entry.size) {
+            section.entry.encoding = exec::RAW;
+            section.contents       = EncodeRaw(words);
+        }
     };
 
-    // code size (in bytes)
-    write_word(get_segment_size(data.code));
+    add_section(exec::CODE, data.code);
+    add_section(exec::CONSTANTS, constants);
 
-    // constants size (in bytes)
-    write_word(get_segment_size(data.constants));
+    // the zeros are only described by their number
+    if (n_zeros > 0) {
+        StoredSection& section = sections.emplace_back();
 
-    // entrypoint address
-    write_word(data.entrypoint);
+        section.entry.kind = exec::ZEROS;
+        section.entry.size =
+            static_cast<arch::Word>(n_zeros * arch::kWordSize);
+    }
 
-    // initial stack pointer
-    write_word(static_cast<arch::Word>(arch::kMemorySize - 1));
+    // the debug info is already encoded compactly (see the EncodeSymbols
+    // method), so it is always stored raw
+    if (!data.symbols.empty()) {
+        StoredSection& section = sections.emplace_back();
 
-    // target processor ID
-    write_word(exec::kProcessorID);
+        section.entry.kind     = exec::SYMBOLS;
+        section.entry.encoding = exec::RAW;
+        section.entry.size = static_cast<arch::Word>(data.symbols.size());
+        section.contents   = data.symbols;
+    }
 
-    // empty
-    binary << std::string(exec::kCodeSegmentPos - exec::kMetaInfoEndPos, '0');
+    std::string header;
 
-    // code
-    for (const cmd::Bin command : data.code) {
-        write_word(command);
+    // intro string
+    header += exec::kVersionedIntroString;
+    header += '\0';
+
+    AppendWord(header, exec::kVersion);
+    AppendWord(header, exec::kProcessorID);
+    AppendWord(header, data.entrypoint);
+    AppendWord(header, data.initial_stack);
+    AppendWord(header, static_cast<arch::Word>(sections.size()));
+
+    // the contents of the sections follow the section table
+    size_t offset =
+        exec::kVersionedHeaderSize + sections.size() * exec::kSectionEntrySize;
+
+    for (StoredSection& section : sections) {
+        section.entry.stored_size =
+            static_cast<arch::Word>(section.contents.size());
+        section.entry.offset =
+            section.contents.empty() ? 0 : static_cast<arch::Word>(offset);
+        offset += section.contents.size();
+
+        AppendWord(header, section.entry.kind);
+        AppendWord(header, section.entry.encoding);
+        AppendWord(header, section.entry.size);
+        AppendWord(header, section.entry.stored_size);
+        AppendWord(header, section.entry.offset);
     }
 
-    // constants
-    for (const cmd::Bin command : data.constants) {
-        write_word(command);
+    binary << header;
+    for (const StoredSection& section : sections) {
+        binary << section.contents;
     }
 }
 
@@ -76,20 +269,41 @@ void Exec::Write(const Data& data, const std::string& exec_path) {
 ////////////////////////////////////////////////////////////////////////////////
 
 Exec::Data Exec::Read(const std::string& exec_path) {
-    // set the input position indicator to the end (using std::ios::ate)
-    // after opening the file to get the size of the exec file,
-    // which is used later to verify that the exec is not malformed
-    std::ifstream binary(exec_path, std::ios::binary | std::ios::ate);
+    // the file is mapped rather than read via a stream, so that
+    // the segments are copied from the page cache at once
+    MappedFile binary(exec_path);
 
     // check that the file was found
-    if (binary.fail()) {
+    if (!binary.IsOpen()) {
+        throw ExecFileError::Builder::FailedToOpen(exec_path);
+    }
+
+    if (binary.Size() > 0 && !binary.Map()) {
         throw ExecFileError::Builder::FailedToOpen(exec_path);
     }
 
+    const std::span<const char> exec(binary.Data(), binary.Size());
+
+    if (exec.size() >= exec::kIntroSize &&
+        std::string(exec.data(), exec::kIntroSize - 1) ==
+            exec::kVersionedIntroString &&
+        exec[exec::kIntroSize - 1] == '\0') {
+        return ReadVersioned(exec, exec_path);
+    }
+
+    // the errors of the files in neither layout are reported
+    // in terms of the original one
+    return ReadOriginal(exec, exec_path);
+}
+
+Exec::Data Exec::ReadOriginal(std::span<const char> exec,
+                              const std::string& exec_path) {
     // check that the exec size is not too small to contain a valid header
-    auto exec_size = static_cast<size_t>(binary.tellg());
+    const size_t exec_size = exec.size();
     if (exec_size < exec::kHeaderSize) {
-        throw ExecFileError::Builder::TooSmallForHeader(exec_size, exec_path);
+        throw ExecFileError::Builder::TooSmallForHeader(exec_size,
+                                                        exec::kHeaderSize,
+                                                        exec_path);
     }
 
     // check that the combined code and constants segments sizes
@@ -100,21 +314,21 @@ Exec::Data Exec::Read(const std::string& exec_path) {
             exec_path);
     }
 
-    // reset input position indicator
-    binary.seekg(0);
+    size_t position = 0;
 
-    auto read_word = [&binary]() -> arch::Word {
+    auto read_word = [&exec, &position]() -> arch::Word {
         // the value is modified via ptr
         // NOLINTNEXTLINE(misc-const-correctness)
         arch::Word word{};
-        binary.read(std::bit_cast<char*>(&word), 4);
+        std::memcpy(&word, exec.data() + position, arch::kWordSize);
+        position += arch::kWordSize;
         return word;
     };
 
     // read the first 16 bytes, which should represent
     // the introductory string (including the final '\0')
-    std::string intro(exec::kIntroSize, '\0');
-    binary.read(intro.data(), static_cast<std::streamsize>(exec::kIntroSize));
+    std::string intro(exec.data(), exec::kIntroSize);
+    position += exec::kIntroSize;
 
     // check that the introductory string is valid
     if (intro.back() != '\0') {
@@ -155,15 +369,18 @@ Exec::Data Exec::Read(const std::string& exec_path) {
     }
 
     // jump to the code segment
-    binary.seekg(exec::kCodeSegmentPos);
+    position = exec::kCodeSegmentPos;
 
     // segments sizes is denoted in bytes, so we need to divide
     // it by arch::kWordSize to get the number of machine words
 
-    auto read_segment = [&read_word](size_t byte_size) {
+    auto read_segment = [&exec, &position](size_t byte_size) {
         std::vector<arch::Word> dst(byte_size / arch::kWordSize);
-        for (arch::Word& word : dst) {
-            word = read_word();
+        if (!dst.empty()) {
+            std::memcpy(dst.data(),
+                        exec.data() + position,
+                        dst.size() * arch::kWordSize);
+            position += dst.size() * arch::kWordSize;
         }
 
         return dst;
@@ -178,4 +395,352 @@ Exec::Data Exec::Read(const std::string& exec_path) {
     return data;
 }
 
+Exec::Data Exec::ReadVersioned(std::span<const char> exec,
+                               const std::string& exec_path) {
+    const size_t exec_size = exec.size();
+    if (exec_size < exec::kVersionedHeaderSize) {
+        throw ExecFileError::Builder::TooSmallForHeader(
+            exec_size,
+            exec::kVersionedHeaderSize,
+            exec_path);
+    }
+
+    size_t position = exec::kIntroSize;
+
+    auto read_word = [&exec, &position]() -> arch::Word {
+        // the value is modified via ptr
+        // NOLINTNEXTLINE(misc-const-correctness)
+        arch::Word word{};
+        std::memcpy(&word, exec.data() + position, arch::kWordSize);
+        position += arch::kWordSize;
+        return word;
+    };
+
+    const arch::Word version = read_word();
+    if (version != exec::kVersion) {
+        throw ExecFileError::Builder::UnsupportedVersion(version, exec_path);
+    }
+
+    const arch::Word processor_id = read_word();
+    if (processor_id != exec::kProcessorID) {
+        throw ExecFileError::Builder::InvalidProcessorID(processor_id,
+                                                         exec_path);
+    }
+
+    Data data;
+    data.entrypoint    = read_word();
+    data.initial_stack = read_word();
+
+    const size_t n_sections = read_word();
+    if (n_sections > (exec_size - exec::kVersionedHeaderSize) /
+                         exec::kSectionEntrySize) {
+        throw ExecFileError::Builder::SectionTableOutOfFile(n_sections,
+                                                            exec_size,
+                                                            exec_path);
+    }
+
+    size_t n_zeros = 0;
+    std::array<bool, exec::SYMBOLS + 1> seen{};
+
+    for (size_t idx = 0; idx < n_sections; ++idx) {
+        SectionEntry entry;
+        entry.kind        = read_word();
+        entry.encoding    = read_word();
+        entry.size        = read_word();
+        entry.stored_size = read_word();
+        entry.offset      = read_word();
+
+        // the sections of the unknown kinds are skipped,
+        // so that the new optional sections can be added
+        if (entry.kind < exec::CODE || entry.kind > exec::SYMBOLS) {
+            continue;
+        }
+
+        if (seen.at(entry.kind)) {
+            throw ExecFileError::Builder::DuplicateSection(entry.kind,
+                                                           exec_path);
+        }
+
+        seen.at(entry.kind) = true;
+
+        switch (entry.kind) {
+            case exec::CODE: {
+                data.code = ReadSection(exec, entry, exec_path);
+                break;
+            }
+
+            case exec::CONSTANTS: {
+                data.constants = ReadSection(exec, entry, exec_path);
+                break;
+            }
+
+            case exec::ZEROS: {
+                if (entry.size % arch::kWordSize != 0) {
+                    throw ExecFileError::Builder::InvalidSectionSize(
+                        entry.kind,
+                        entry.size,
+                        exec_path);
+                }
+
+                // the zeros are only described by their number
+                n_zeros = entry.size / arch::kWordSize;
+                break;
+            }
+
+            case exec::SYMBOLS: {
+                if (entry.encoding != exec::RAW) {
+                    throw ExecFileError::Builder::UnknownEncoding(
+                        entry.kind,
+                        entry.encoding,
+                        exec_path);
+                }
+
+                if (entry.size != entry.stored_size) {
+                    throw ExecFileError::Builder::CorruptedSection(entry.kind,
+                                                                   exec_path);
+                }
+
+                // the debug info is only copied as is,
+                // it is decoded once it is needed
+                const std::span<const char> src =
+                    GetStoredContents(exec, entry, exec_path);
+                data.symbols.assign(src.begin(), src.end());
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
+    }
+
+    const size_t total_size =
+        data.code.size() + data.constants.size() + n_zeros;
+    if (total_size > arch::kMemorySize) {
+        throw ExecFileError::Builder::TooBigForMemory(total_size, exec_path);
+    }
+
+    data.constants.resize(data.constants.size() + n_zeros);
+
+    return data;
+}
+
+std::span<const char> Exec::GetStoredContents(std::span<const char> exec,
+                                              const SectionEntry& entry,
+                                              const std::string& exec_path) {
+    if (entry.offset > exec.size() ||
+        entry.stored_size > exec.size() - entry.offset) {
+        throw ExecFileError::Builder::SectionOutOfFile(entry.kind,
+                                                       entry.offset,
+                                                       entry.stored_size,
+                                                       exec.size(),
+                                                       exec_path);
+    }
+
+    return exec.subspan(entry.offset, entry.stored_size);
+}
+
+std::vector<arch::Word> Exec::ReadSection(std::span<const char> exec,
+                                          const SectionEntry& entry,
+                                          const std::string& exec_path) {
+    if (entry.size % arch::kWordSize != 0 ||
+        entry.size / arch::kWordSize > arch::kMemorySize) {
+        throw ExecFileError::Builder::InvalidSectionSize(entry.kind,
+                                                         entry.size,
+                                                         exec_path);
+    }
+
+    const std::span<const char> src =
+        GetStoredContents(exec, entry, exec_path);
+    std::vector<arch::Word> dst(entry.size / arch::kWordSize);
+
+    switch (entry.encoding) {
+        case exec::RAW: {
+            if (src.size() != entry.size) {
+                throw ExecFileError::Builder::CorruptedSection(entry.kind,
+                                                               exec_path);
+            }
+
+            if (!dst.empty()) {
+                std::memcpy(dst.data(), src.data(), src.size());
+            }
+
+            break;
+        }
+
+        case exec::VARINT: {
+            size_t position = 0;
+
+            for (size_t filled = 0; filled < dst.size();) {
+                arch::Word length{};
+                arch::Word word{};
+
+                if (!ReadVarint(src, position, length) ||
+                    !ReadVarint(src, position, word) || length == 0 ||
+                    length > dst.size() - filled) {
+                    throw ExecFileError::Builder::CorruptedSection(entry.kind,
+                                                                   exec_path);
+                }
+
+                std::fill_n(dst.begin() + static_cast<std::ptrdiff_t>(filled),
+                            length,
+                            word);
+                filled += length;
+            }
+
+            if (position != src.size()) {
+                throw ExecFileError::Builder::CorruptedSection(entry.kind,
+                                                               exec_path);
+            }
+
+            break;
+        }
+
+        default: {
+            throw ExecFileError::Builder::UnknownEncoding(entry.kind,
+                                                          entry.encoding,
+                                                          exec_path);
+        }
+    }
+
+    return dst;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                  Symbols                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+std::string Exec::EncodeSymbols(const Symbols& symbols) {
+    std::string dst;
+
+    auto append_size = [&dst](size_t value) {
+        AppendVarint(dst, static_cast<arch::Word>(value));
+    };
+
+    auto append_string = [&dst, &append_size](const std::string& str) {
+        append_size(str.size());
+        dst += str;
+    };
+
+    append_size(symbols.files.size());
+    for (const std::string& file : symbols.files) {
+        append_string(file);
+    }
+
+    // the addresses are stored as the differences with the previous ones,
+    // which take a single byte for the consecutive commands
+
+    arch::Address prev = 0;
+
+    append_size(symbols.labels.size());
+    for (const Symbols::Label& label : symbols.labels) {
+        append_size(label.address - prev);
+        append_string(label.name);
+        prev = label.address;
+    }
+
+    prev = 0;
+
+    append_size(symbols.lines.size());
+    for (const Symbols::Line& line : symbols.lines) {
+        append_size(line.address - prev);
+        append_size(line.file);
+        append_size(line.line);
+        prev = line.address;
+    }
+
+    return dst;
+}
+
+std::optional<Exec::Symbols> Exec::DecodeSymbols(std::string_view encoded) {
+    const std::span<const char> src(encoded.data(), encoded.size());
+    size_t position = 0;
+
+    auto read_size = [&src, &position](size_t& dst) {
+        arch::Word word{};
+        if (!ReadVarint(src, position, word)) {
+            return false;
+        }
+
+        dst = word;
+        return true;
+    };
+
+    auto read_string = [&src, &position, &read_size](std::string& dst) {
+        size_t size = 0;
+        if (!read_size(size) || size > src.size() - position) {
+            return false;
+        }
+
+        dst.assign(src.data() + position, size);
+        position += size;
+        return true;
+    };
+
+    // the address must stay in the memory and keep the entries sorted
+    auto read_address = [&read_size](arch::Address prev, arch::Address& dst) {
+        size_t delta = 0;
+        if (!read_size(delta) || delta >= arch::kMemorySize - prev) {
+            return false;
+        }
+
+        dst = static_cast<arch::Address>(prev + delta);
+        return true;
+    };
+
+    Symbols symbols;
+    size_t count = 0;
+
+    // each entry takes at least a byte, which limits the counts
+    // before the vectors are reserved for them
+
+    if (!read_size(count) || count > src.size()) {
+        return std::nullopt;
+    }
+
+    symbols.files.resize(count);
+    for (std::string& file : symbols.files) {
+        if (!read_string(file)) {
+            return std::nullopt;
+        }
+    }
+
+    if (!read_size(count) || count > src.size()) {
+        return std::nullopt;
+    }
+
+    arch::Address prev = 0;
+
+    symbols.labels.resize(count);
+    for (Symbols::Label& label : symbols.labels) {
+        if (!read_address(prev, label.address) || !read_string(label.name)) {
+            return std::nullopt;
+        }
+
+        prev = label.address;
+    }
+
+    if (!read_size(count) || count > src.size()) {
+        return std::nullopt;
+    }
+
+    prev = 0;
+
+    symbols.lines.resize(count);
+    for (Symbols::Line& line : symbols.lines) {
+        if (!read_address(prev, line.address) || !read_size(line.file) ||
+            !read_size(line.line) || line.file >= symbols.files.size()) {
+            return std::nullopt;
+        }
+
+        prev = line.address;
+    }
+
+    if (position != src.size()) {
+        return std::nullopt;
+    }
+
+    return symbols;
+}
+
 }  // namespace karma
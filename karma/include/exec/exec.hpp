@@ -1,7 +1,10 @@
 #pragma once
 
-#include <string>  // for string
-#include <vector>  // for vector
+#include <optional>     // for optional
+#include <span>         // for span
+#include <string>       // for string
+#include <string_view>  // for string_view
+#include <vector>       // for vector
 
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
@@ -22,6 +25,8 @@ class Exec : detail::utils::traits::Static {
     using ExecFileError = errors::exec::ExecFileError;
 
    public:
+    struct Symbols;
+
     struct Data : detail::utils::traits::NonCopyableMovable {
         Data() = default;
 
@@ -40,10 +45,53 @@ class Exec : detail::utils::traits::Static {
 
         std::vector<detail::specs::cmd::Bin> code;
         std::vector<detail::specs::arch::Word> constants;
+
+        // the SYMBOLS section as it is stored in the executable file
+        // (empty if the program has no debug info), which is only decoded
+        // by the DecodeSymbols method once the debug info is actually needed
+        std::string symbols;
     };
 
+    // writes the versioned layout (see the exec directory README)
     static void Write(const Data& data, const std::string& exec_path);
+
+    // reads both the versioned and the original layouts
     static Data Read(const std::string& exec_path);
+
+    static std::string EncodeSymbols(const Symbols&);
+
+    // returns std::nullopt if the section is corrupted, which is not
+    // an error, because the program can be executed without its debug info
+    static std::optional<Symbols> DecodeSymbols(std::string_view);
+
+   private:
+    // an entry of the section table of the versioned layout,
+    // the sizes are denoted in bytes
+    struct SectionEntry {
+        detail::specs::arch::Word kind{0};
+        detail::specs::arch::Word encoding{0};
+        detail::specs::arch::Word size{0};
+        detail::specs::arch::Word stored_size{0};
+        detail::specs::arch::Word offset{0};
+    };
+
+   private:
+    static Data ReadOriginal(std::span<const char> exec,
+                             const std::string& exec_path);
+    static Data ReadVersioned(std::span<const char> exec,
+                              const std::string& exec_path);
+
+    // checks that the stored contents of the section are inside the file
+    static std::span<const char> GetStoredContents(
+        std::span<const char> exec,
+        const SectionEntry&,
+        const std::string& exec_path);
+
+    // decodes the words of the section stored in the versioned layout
+    static std::vector<detail::specs::arch::Word> ReadSection(
+        std::span<const char> exec,
+        const SectionEntry&,
+        const std::string& exec_path);
 };
 
 namespace errors::exec {
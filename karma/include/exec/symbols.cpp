@@ -0,0 +1,90 @@
+#include "symbols.hpp"
+
+#include <algorithm>  // for lower_bound, upper_bound
+#include <iterator>   // for prev
+#include <optional>   // for optional, nullopt
+#include <string>     // for string, to_string
+
+#include "specs/architecture.hpp"
+
+namespace karma {
+
+namespace arch = detail::specs::arch;
+
+bool Exec::Symbols::Empty() const {
+    return labels.empty() && lines.empty();
+}
+
+std::optional<std::string> Exec::Symbols::TryGetLabel(
+    arch::Address address) const {
+    const auto it =
+        std::lower_bound(labels.begin(),
+                         labels.end(),
+                         address,
+                         [](const Label& label, arch::Address addr) {
+                             return label.address < addr;
+                         });
+
+    if (it == labels.end() || it->address != address) {
+        return std::nullopt;
+    }
+
+    return it->name;
+}
+
+std::optional<std::string> Exec::Symbols::TryGetNearestLabel(
+    arch::Address address) const {
+    auto it = std::upper_bound(labels.begin(),
+                               labels.end(),
+                               address,
+                               [](arch::Address addr, const Label& label) {
+                                   return addr < label.address;
+                               });
+
+    if (it == labels.begin()) {
+        return std::nullopt;
+    }
+
+    // the first of the labels defined at the found address
+    const arch::Address nearest = std::prev(it)->address;
+    while (it != labels.begin() && std::prev(it)->address == nearest) {
+        --it;
+    }
+
+    if (nearest == address) {
+        return it->name;
+    }
+
+    return it->name + '+' + std::to_string(address - nearest);
+}
+
+std::optional<std::string> Exec::Symbols::TryGetSourceLine(
+    arch::Address address) const {
+    const auto it = std::lower_bound(lines.begin(),
+                                     lines.end(),
+                                     address,
+                                     [](const Line& line, arch::Address addr) {
+                                         return line.address < addr;
+                                     });
+
+    if (it == lines.end() || it->address != address ||
+        it->file >= files.size()) {
+        return std::nullopt;
+    }
+
+    return files[it->file] + ':' + std::to_string(it->line);
+}
+
+std::optional<std::string> Exec::Symbols::TryDescribe(
+    arch::Address address) const {
+    std::optional<std::string> label = TryGetNearestLabel(address);
+    std::optional<std::string> line  = TryGetSourceLine(address);
+
+    if (label && line) {
+        return *label + " (" + *line + ')';
+    }
+
+    return label ? label : line;
+}
+
+}  // namespace karma
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <optional>  // for optional
+#include <string>    // for string
+#include <vector>    // for vector
+
+#include "exec/exec.hpp"
+#include "specs/architecture.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the debug info of a program (the SYMBOLS section of the versioned layout),
+// which maps the addresses to the labels defined at them and the addresses
+// of the commands to the source lines they were compiled from
+struct Exec::Symbols : detail::utils::traits::NonCopyableMovable {
+    struct Label {
+        detail::specs::arch::Address address{0};
+        std::string name;
+    };
+
+    struct Line {
+        detail::specs::arch::Address address{0};
+
+        // the index of the source file in the files vector
+        size_t file{0};
+        size_t line{0};
+    };
+
+    [[nodiscard]] bool Empty() const;
+
+    // the first label defined at exactly the address
+    [[nodiscard]] std::optional<std::string> TryGetLabel(
+        detail::specs::arch::Address) const;
+
+    // the nearest label defined at or before the address followed
+    // by the offset of the address from it (if any), e.g. "loop+3",
+    // which is the function a command belongs to for the code addresses
+    [[nodiscard]] std::optional<std::string> TryGetNearestLabel(
+        detail::specs::arch::Address) const;
+
+    // the source file and line of the command at the address, e.g. "a.krm:12"
+    [[nodiscard]] std::optional<std::string> TryGetSourceLine(
+        detail::specs::arch::Address) const;
+
+    // both of the above, e.g. "loop+3 (a.krm:12)"
+    [[nodiscard]] std::optional<std::string> TryDescribe(
+        detail::specs::arch::Address) const;
+
+    // sorted by the address and then by the name
+    std::vector<Label> labels;
+
+    std::vector<std::string> files;
+
+    // sorted by the address, an entry per a command of the code segment
+    std::vector<Line> lines;
+};
+
+}  // namespace karma
@@ -1,5 +1,21 @@
 #include "common_executor.hpp"
 
+#include <algorithm>    // for fill_n, find, mismatch
+#include <bit>          // for bit_cast
+#include <chrono>       // for nanoseconds
+#include <csignal>      // for sigset_t, sigfillset, sigwait, sigtimedwait
+#include <cstring>      // for memmove
+#include <ctime>        // for timespec
+#include <mutex>        // for mutex, unique_lock
+#include <optional>     // for optional, nullopt
+#include <string>       // for string
+#include <thread>       // for sleep_for
+#include <type_traits>  // for make_signed_t
+
+#include "executor/intrinsics.hpp"
+#include "executor/paged_memory.hpp"
+#include "executor/stats.hpp"
+#include "executor/threads.hpp"
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
 #include "specs/flags.hpp"
@@ -7,11 +23,12 @@
 
 namespace karma {
 
-namespace utils = detail::utils;
-namespace arch  = detail::specs::arch;
-namespace cmd   = detail::specs::cmd;
-namespace args  = cmd::args;
-namespace flags = detail::specs::flags;
+namespace utils   = detail::utils;
+namespace arch    = detail::specs::arch;
+namespace cmd     = detail::specs::cmd;
+namespace args    = cmd::args;
+namespace flags   = detail::specs::flags;
+namespace syscall = cmd::syscall;
 
 arch::TwoWords Executor::CommonExecutor::GetTwoRegisters(args::Register low) {
     return utils::types::Join(RReg(low), RReg(low + 1));
@@ -69,6 +86,100 @@ void Executor::CommonExecutor::Pop(args::Receiver recv,
         RMem(++WReg(arch::kStackRegister, kInternalUse)) + mod;
 }
 
+void Executor::CommonExecutor::CopyMemory(args::Address dst,
+                                          args::Address src,
+                                          arch::Word size) {
+    // both ranges are checked before any of them is accessed
+    const arch::Word* from = RMemRange(src, size);
+    arch::Word* to         = WMemRange(dst, size);
+
+    if (!IsMultithreaded()) {
+        // the ranges may overlap
+        std::memmove(to, from, size * sizeof(arch::Word));
+        return;
+    }
+
+    // the words shared with the other threads are copied one by one
+    // in the direction the overlapping ranges are copied correctly in
+    if (to < from) {
+        for (size_t i = 0; i < size; ++i) {
+            PagedMemory::Store(to[i], PagedMemory::Load(from[i]));
+        }
+    } else {
+        for (size_t i = size; i-- > 0;) {
+            PagedMemory::Store(to[i], PagedMemory::Load(from[i]));
+        }
+    }
+}
+
+void Executor::CommonExecutor::FillMemory(args::Address dst,
+                                          arch::Word value,
+                                          arch::Word size) {
+    arch::Word* data = WMemRange(dst, size);
+
+    if (!IsMultithreaded()) {
+        std::fill_n(data, size, value);
+        return;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        PagedMemory::Store(data[i], value);
+    }
+}
+
+void Executor::CommonExecutor::CompareMemory(args::Address lhs,
+                                             args::Address rhs,
+                                             arch::Word size) {
+    const arch::Word* lhs_data = RMemRange(lhs, size);
+    const arch::Word* rhs_data = RMemRange(rhs, size);
+
+    if (IsMultithreaded()) {
+        // each word shared with the other threads is loaded once,
+        // so the flags are written for the same values as are compared
+        for (size_t i = 0; i < size; ++i) {
+            const arch::Word lhs_word = PagedMemory::Load(lhs_data[i]);
+            const arch::Word rhs_word = PagedMemory::Load(rhs_data[i]);
+
+            if (lhs_word != rhs_word) {
+                WriteComparisonToFlags(lhs_word, rhs_word);
+                return;
+            }
+        }
+
+        Flags() = flags::kEqual;
+        return;
+    }
+
+    const auto [lhs_it, rhs_it] =
+        std::mismatch(lhs_data, lhs_data + size, rhs_data);
+
+    if (lhs_it == lhs_data + size) {
+        Flags() = flags::kEqual;
+        return;
+    }
+
+    WriteComparisonToFlags(*lhs_it, *rhs_it);
+}
+
+args::Address Executor::CommonExecutor::FindInMemory(args::Address begin,
+                                                     arch::Word value,
+                                                     arch::Word size) {
+    const arch::Word* data = RMemRange(begin, size);
+
+    arch::Word found = 0;
+    if (IsMultithreaded()) {
+        while (found < size && PagedMemory::Load(data[found]) != value) {
+            ++found;
+        }
+    } else {
+        found =
+            static_cast<arch::Word>(std::find(data, data + size, value) - data);
+    }
+
+    WriteComparisonToFlags(found, size);
+    return begin + found;
+}
+
 void Executor::CommonExecutor::PrepareCall() {
     Push(RReg(arch::kCallFrameRegister, kInternalUse));
 
@@ -77,6 +188,8 @@ void Executor::CommonExecutor::PrepareCall() {
 }
 
 arch::Address Executor::CommonExecutor::Call(args::Address callee) {
+    ++Stats().calls;
+
     // remember the return address to return from this function
     const arch::Address ret = RReg(arch::kInstructionRegister, kInternalUse);
 
@@ -92,10 +205,54 @@ arch::Address Executor::CommonExecutor::Call(args::Address callee) {
     // next executed instruction is the first one from the callee
     WReg(arch::kInstructionRegister, kInternalUse) = callee;
 
+    // the intrinsic routine returns right away, as if it has been interpreted
+    if (RunIntrinsic(callee, ret)) {
+        Return();
+    }
+
     return ret;
 }
 
+bool Executor::CommonExecutor::RunIntrinsic(args::Address callee,
+                                            args::Address ret) {
+    const Intrinsics* intrinsics = GetIntrinsics();
+    if (intrinsics == nullptr) {
+        return false;
+    }
+
+    // the reads of the interpreted routine are not counted in the statistics
+    // as well as its other commands
+    const auto read =
+        [this](arch::Address address) -> std::optional<arch::Word> {
+        if (!CanRMem(address)) {
+            return std::nullopt;
+        }
+
+        return RMem(address, kInternalUse);
+    };
+
+    const auto routine = intrinsics->TryGet(callee, ret, read);
+    if (!routine || StackSpace() < Intrinsics::kStackReserve) {
+        return false;
+    }
+
+    std::string text;
+    if (!Intrinsics::Run(*routine,
+                         RReg(arch::kCallFrameRegister, kInternalUse),
+                         read,
+                         text)) {
+        return false;
+    }
+
+    Output().WriteChars(text);
+    ++Stats().intrinsic_calls;
+
+    return true;
+}
+
 void Executor::CommonExecutor::Return() {
+    ++Stats().returns;
+
     // move the stack to before the function local variables
     WReg(arch::kStackRegister, kInternalUse) =
         RReg(arch::kCallFrameRegister, kInternalUse);
@@ -115,4 +272,211 @@ void Executor::CommonExecutor::Return() {
     Pop(arch::kCallFrameRegister, 0, kInternalUse);
 }
 
+Executor::MaybeReturnCode Executor::CommonExecutor::Halt() {
+    // the program may be waiting for a signal in response to its output
+    {
+        const std::unique_lock<std::mutex> devices = LockDevices();
+        Output().Flush();
+    }
+
+    // the sliced executions never block the thread running them,
+    // so the slice is stopped instead, and the next one continues
+    // the execution as if the signal has been received
+    if (IsSliced()) {
+        Interrupt(Storage::HALTED);
+        return 0;
+    }
+
+    sigset_t wset{};
+    sigfillset(&wset);
+
+    // the other threads may stop the execution while the thread waits,
+    // so the signal is waited for by the intervals, between which
+    // the thread checks for it (the same as for the input, see Syscall)
+    if (IsMultithreaded()) {
+        const timespec interval{
+            .tv_sec  = 0,
+            .tv_nsec = std::chrono::nanoseconds(Threads::kPollInterval).count(),
+        };
+
+        while (sigtimedwait(&wset, nullptr, &interval) < 0) {
+            if (!Synchronize()) {
+                Interrupt(Storage::RESCHEDULED);
+                return 0;
+            }
+        }
+
+        return {};
+    }
+
+    int sig{};
+    sigwait(&wset, &sig);
+
+    return {};
+}
+
+Executor::MaybeReturnCode Executor::CommonExecutor::Suspend(
+    Storage::Interruption interruption) {
+    WReg(arch::kInstructionRegister, kInternalUse)--;
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    --Retired()[cmd::SYSCALL];
+
+    Interrupt(interruption);
+    return 0;
+}
+
+Executor::MaybeReturnCode Executor::CommonExecutor::Syscall(
+    args::Register reg, syscall::Code code) {
+    std::unique_lock<std::mutex> devices = LockDevices();
+
+    // the threads of a stopped execution do not use the devices anymore,
+    // so nothing is printed after the main thread has exited
+    if (Stopped()) {
+        return Suspend(Storage::RESCHEDULED);
+    }
+
+    const bool reads_input = code == syscall::SCANINT ||
+                             code == syscall::SCANDOUBLE ||
+                             code == syscall::GETCHAR;
+
+    // the sliced executions do not wait for the input either, the system
+    // call is not considered executed and is executed again by the next slice
+    if (reads_input && IsSliced() && !Input().Ready()) {
+        return Suspend(Storage::BLOCKED_ON_INPUT);
+    }
+
+    // the threads of a multithreaded execution wait for the input without
+    // locking the devices, so the other threads are able to use them
+    // and to stop the execution meanwhile, only the devices able to tell
+    // if the input is available (see the InputDevice::Ready method)
+    // are waited for this way
+    if (reads_input && IsMultithreaded()) {
+        while (!Input().Ready()) {
+            devices.unlock();
+            std::this_thread::sleep_for(Threads::kPollInterval);
+
+            const bool running = Synchronize();
+            devices.lock();
+
+            if (!running) {
+                return Suspend(Storage::RESCHEDULED);
+            }
+        }
+    }
+
+    // the same for a thread joining the one, which has not finished yet,
+    // the system call is executed again once the thread waited for finishes
+    // (see the Threads::Wait method)
+    std::optional<arch::Word> joined;
+    if (code == syscall::JOIN) {
+        joined = TryJoin(RReg(reg));
+
+        if (!joined) {
+            return Suspend(Storage::RESCHEDULED);
+        }
+    }
+
+    ++Stats().syscalls[code];
+
+    switch (code) {
+        case syscall::EXIT: {
+            // the system call of a spawned thread only finishes the thread
+            // rather than the whole execution (see the Threads class)
+            Output().Flush();
+            Exit();
+            return RReg(reg);
+        }
+
+        case syscall::SCANINT: {
+            // flush the output before reading the input
+            // to keep the prompts of the program interactive
+            Output().Flush();
+
+            ++Stats().input_values;
+            WReg(reg) = static_cast<arch::Word>(Input().ReadInt());
+            break;
+        }
+
+        case syscall::SCANDOUBLE: {
+            Output().Flush();
+
+            ++Stats().input_values;
+            const arch::Double val = Input().ReadDouble();
+            PutTwoRegisters(std::bit_cast<arch::TwoWords>(val), reg);
+            break;
+        }
+
+        case syscall::PRINTINT: {
+            using Int = std::make_signed_t<arch::Word>;
+            Output().Write(static_cast<Int>(RReg(reg)));
+            break;
+        }
+
+        case syscall::PRINTDOUBLE: {
+            const arch::TwoWords words = GetTwoRegisters(reg);
+            Output().Write(std::bit_cast<arch::Double>(words));
+            break;
+        }
+
+        case syscall::GETCHAR: {
+            Output().Flush();
+
+            ++Stats().input_values;
+            WReg(reg) = static_cast<arch::Word>(Input().ReadChar());
+            break;
+        }
+
+        case syscall::PUTCHAR: {
+            if (RReg(reg) > syscall::kMaxChar) {
+                throw ExecutionError::InvalidPutCharValue(RReg(reg));
+            }
+
+            Output().Write(static_cast<syscall::Char>(RReg(reg)));
+            break;
+        }
+
+        case syscall::SNAPSHOT: {
+            // the receiver register allows for the program to tell
+            // the executions resumed from the snapshot from the others
+            if (!ReachSnapshot()) {
+                WReg(reg) = 0;
+                break;
+            }
+
+            WReg(reg) = 1;
+
+            // the state is captured by the Impl class once the execution
+            // is stopped, the return code is ignored in this case
+            Output().Flush();
+            return 0;
+        }
+
+        case syscall::SPAWN: {
+            WReg(reg) = Spawn(RReg(reg), RReg(reg + 1));
+
+            // the engine is stopped for the execution to continue
+            // in the turns of the threads (see the Impl class)
+            Interrupt(Storage::RESCHEDULED);
+            return 0;
+        }
+
+        case syscall::JOIN: {
+            WReg(reg) = *joined;
+            break;
+        }
+
+        case syscall::YIELD: {
+            Interrupt(Storage::RESCHEDULED);
+            return 0;
+        }
+
+        default: {
+            throw ExecutionError::UnknownSyscallCode(code);
+        }
+    }
+
+    return {};
+}
+
 }  // namespace karma
@@ -5,6 +5,7 @@
 #include "executor/errors.hpp"
 #include "executor/executor.hpp"
 #include "executor/executor_base.hpp"
+#include "executor/storage.hpp"
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
 #include "specs/flags.hpp"
@@ -57,9 +58,47 @@ class Executor::CommonExecutor : public ExecutorBase {
              detail::specs::arch::Word,
              bool internal_usage = false);
 
+    // the bulk memory commands, each range is the specified number
+    // of the words starting at the address
+
+    void CopyMemory(detail::specs::cmd::args::Address dst,
+                    detail::specs::cmd::args::Address src,
+                    detail::specs::arch::Word size);
+    void FillMemory(detail::specs::cmd::args::Address dst,
+                    detail::specs::arch::Word value,
+                    detail::specs::arch::Word size);
+
+    // writes the comparison of the first differing words to the flags
+    void CompareMemory(detail::specs::cmd::args::Address lhs,
+                       detail::specs::cmd::args::Address rhs,
+                       detail::specs::arch::Word size);
+
+    // returns the address of the first word equal to the value or the address
+    // following the range, and writes its comparison to the latter one
+    // to the flags
+    detail::specs::cmd::args::Address FindInMemory(
+        detail::specs::cmd::args::Address begin,
+        detail::specs::arch::Word value,
+        detail::specs::arch::Word size);
+
     void PrepareCall();
     detail::specs::cmd::args::Address Call(detail::specs::cmd::args::Address);
     void Return();
+
+    // runs the called routine natively if it is an intrinsic one and its
+    // caller allows for it (see the Intrinsics class), returns false
+    // if it is to be interpreted
+    bool RunIntrinsic(detail::specs::cmd::args::Address callee,
+                      detail::specs::cmd::args::Address ret);
+
+    // stops the current slice or the turn of the current thread before
+    // the system call being executed, so that it is executed again
+    // by the next slice or the next turn of the thread
+    MaybeReturnCode Suspend(Storage::Interruption);
+
+    MaybeReturnCode Halt();
+    MaybeReturnCode Syscall(detail::specs::cmd::args::Register,
+                            detail::specs::cmd::syscall::Code);
 };
 
 }  // namespace karma
@@ -2,11 +2,14 @@
 
 #include <algorithm>      // for min
 #include <iostream>       // for ostream, ios
+#include <memory>         // for shared_ptr, make_shared
 #include <optional>       // for optional
+#include <string>         // for string
 #include <unordered_set>  // for erase_if
 #include <utility>        // for move
 
 #include "executor/executor.hpp"
+#include "executor/io.hpp"
 #include "specs/architecture.hpp"
 
 namespace karma {
@@ -119,6 +122,52 @@ void Config::UnboundStack() {
     max_stack_size_ = std::nullopt;
 }
 
+void Config::SetEngine(Engine engine) {
+    engine_ = engine;
+}
+
+void Config::SetNativeModule(std::string path) {
+    native_module_ = std::move(path);
+}
+
+void Config::SetHugePages(bool huge_pages) {
+    huge_pages_ = huge_pages;
+}
+
+void Config::SetIntrinsics(bool intrinsics) {
+    intrinsics_ = intrinsics;
+}
+
+void Config::SetInput(std::shared_ptr<InputDevice> input) {
+    input_ = std::move(input);
+}
+
+void Config::SetOutput(std::shared_ptr<OutputDevice> output) {
+    output_ = std::move(output);
+}
+
+void Config::SetProfile(std::shared_ptr<OutputDevice> profile) {
+    profile_ = std::move(profile);
+}
+
+void Config::SetFoldedStacks(std::shared_ptr<OutputDevice> folded_stacks) {
+    folded_stacks_ = std::move(folded_stacks);
+}
+
+void Config::SetTrace(std::shared_ptr<OutputDevice> trace) {
+    trace_ = std::move(trace);
+}
+
+void Config::SetStats(std::shared_ptr<ExecutionStats> stats) {
+    stats_ = std::move(stats);
+}
+
+void Config::SetOutputBuffering(OutputBuffering buffering,
+                                size_t buffer_size) {
+    output_buffering_   = buffering;
+    output_buffer_size_ = buffer_size;
+}
+
 Config Config::Strict() {
     Config config;
 
@@ -155,6 +204,57 @@ Config& Config::operator&=(const Config& rhs) {
         BoundStack(*rhs.max_stack_size_);
     }
 
+    // the engine does not affect the semantics of an execution,
+    // so there is no "strictest" choice, and the explicitly
+    // specified engine of the right hand side takes precedence
+    if (rhs.engine_) {
+        engine_ = rhs.engine_;
+    }
+
+    // the same is true for the native module, the output buffering,
+    // the huge pages, the intrinsics, the devices, the profiling
+    // and the statistics
+    if (!rhs.native_module_.empty()) {
+        native_module_ = rhs.native_module_;
+    }
+
+    if (rhs.output_buffering_) {
+        output_buffering_   = rhs.output_buffering_;
+        output_buffer_size_ = rhs.output_buffer_size_;
+    }
+
+    if (rhs.huge_pages_) {
+        huge_pages_ = rhs.huge_pages_;
+    }
+
+    if (rhs.intrinsics_) {
+        intrinsics_ = rhs.intrinsics_;
+    }
+
+    if (rhs.input_) {
+        input_ = rhs.input_;
+    }
+
+    if (rhs.output_) {
+        output_ = rhs.output_;
+    }
+
+    if (rhs.profile_) {
+        profile_ = rhs.profile_;
+    }
+
+    if (rhs.folded_stacks_) {
+        folded_stacks_ = rhs.folded_stacks_;
+    }
+
+    if (rhs.trace_) {
+        trace_ = rhs.trace_;
+    }
+
+    if (rhs.stats_) {
+        stats_ = rhs.stats_;
+    }
+
     return *this;
 }
 
@@ -204,6 +304,60 @@ size_t Config::MinStackAddress() const {
     return arch::kMemorySize - MaxStackSize();
 }
 
+Config::Engine Config::GetEngine() const {
+    return engine_.value_or(kDefaultEngine);
+}
+
+const std::string& Config::GetNativeModule() const {
+    return native_module_;
+}
+
+Config::OutputBuffering Config::GetOutputBuffering() const {
+    return output_buffering_.value_or(kDefaultOutputBuffering);
+}
+
+size_t Config::OutputBufferSize() const {
+    return output_buffer_size_;
+}
+
+bool Config::UsesHugePages() const {
+    return huge_pages_.value_or(kDefaultHugePages);
+}
+
+bool Config::UsesIntrinsics() const {
+    return intrinsics_.value_or(kDefaultIntrinsics);
+}
+
+bool Config::InputIsSet() const {
+    return input_ != nullptr;
+}
+
+std::shared_ptr<Executor::InputDevice> Config::GetInput() const {
+    static const auto kStandardInput = std::make_shared<StreamInput>();
+    return input_ ? input_ : kStandardInput;
+}
+
+std::shared_ptr<Executor::OutputDevice> Config::GetOutput() const {
+    static const auto kStandardOutput = std::make_shared<StreamOutput>();
+    return output_ ? output_ : kStandardOutput;
+}
+
+std::shared_ptr<Executor::OutputDevice> Config::GetProfile() const {
+    return profile_;
+}
+
+std::shared_ptr<Executor::OutputDevice> Config::GetFoldedStacks() const {
+    return folded_stacks_;
+}
+
+std::shared_ptr<Executor::OutputDevice> Config::GetTrace() const {
+    return trace_;
+}
+
+std::shared_ptr<Executor::ExecutionStats> Config::GetStats() const {
+    return stats_;
+}
+
 // NOLINTNEXTLINE(fuchsia-overloaded-operator)
 std::ostream& operator<<(std::ostream& out, const Config& config) {
     auto print_registers = [&out](const Config::Registers& registers) {
@@ -255,6 +409,59 @@ std::ostream& operator<<(std::ostream& out, const Config& config) {
         out << "\n    max size: " << *config.max_stack_size_;
     }
 
+    out << "\nengine: ";
+    switch (config.GetEngine()) {
+        case Config::MAPPED: {
+            out << "mapped";
+            break;
+        }
+
+        case Config::TABLE: {
+            out << "table";
+            break;
+        }
+
+        case Config::JIT: {
+            out << "jit";
+            break;
+        }
+
+        case Config::NATIVE: {
+            out << "native\n    module: " << config.native_module_;
+            break;
+        }
+    }
+
+    out << "\noutput buffering: ";
+    switch (config.GetOutputBuffering()) {
+        case Config::UNBUFFERED: {
+            out << "unbuffered";
+            break;
+        }
+
+        case Config::LINE: {
+            out << "line";
+            break;
+        }
+
+        case Config::FULL: {
+            out << "full\n    buffer size: " << config.OutputBufferSize();
+            break;
+        }
+    }
+
+    out << "\nhuge pages: " << (config.UsesHugePages() ? "on" : "off");
+    out << "\nintrinsics: " << (config.UsesIntrinsics() ? "on" : "off");
+
+    out << "\ninput: " << (config.input_ ? "custom" : "standard")
+        << "\noutput: " << (config.output_ ? "custom" : "standard");
+
+    out << "\nprofile: " << (config.profile_ ? "on" : "off")
+        << "\nfolded stacks: " << (config.folded_stacks_ ? "on" : "off")
+        << "\ntrace: " << (config.trace_ ? "on" : "off");
+
+    out << "\nstats: " << (config.stats_ ? "on" : "off");
+
     return out;
 }
 
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cstddef>        // for size_t
-#include <cstdint>        // for uint32_t
+#include <cstdint>        // for uint32_t, uint8_t
+#include <memory>         // for shared_ptr
 #include <optional>       // for optional, nullopt
+#include <string>         // for string
 #include <unordered_set>  // for unordered_set
 
 #include "executor.hpp"
@@ -14,6 +16,38 @@ class Executor::Config {
     // NOLINTNEXTLINE(fuchsia-overloaded-operator)
     friend std::ostream& operator<<(std::ostream&, const Config&);
 
+   public:
+    enum Engine : uint8_t {
+        // dispatch each command through the per-format maps
+        // of std::functions (see the RM|RR|RI|JExecutor classes)
+        MAPPED,
+
+        // dispatch each command through a single dense opcode-indexed
+        // jump table with all the commands handlers in one translation unit
+        // (see the TableExecutor class)
+        TABLE,
+
+        // the same as TABLE, but the hot basic blocks are compiled
+        // to the native x86-64 code (see the JitExecutor class)
+        JIT,
+
+        // the same as TABLE, but the commands are executed by the native
+        // module produced by the translator from the executed program
+        // ahead of time (see the NativeExecutor and the Translator classes)
+        NATIVE,
+    };
+
+    enum OutputBuffering : uint8_t {
+        // flush the output after each printing system call
+        UNBUFFERED,
+
+        // flush the output after each printed newline character
+        LINE,
+
+        // flush the output once the buffer reaches the specified size
+        FULL,
+    };
+
    private:
     using Registers = std::unordered_set<uint32_t>;
 
@@ -66,6 +100,44 @@ class Executor::Config {
     void BoundStack(size_t stack_size);
     void UnboundStack();
 
+    void SetEngine(Engine);
+
+    // the path to the native module executed by the NATIVE engine,
+    // the module must be translated from the executed program
+    void SetNativeModule(std::string path);
+
+    void SetOutputBuffering(OutputBuffering,
+                            size_t buffer_size = kDefaultOutputBufferSize);
+
+    // back the memory of the Karma computer with the huge pages,
+    // the regular pages are used by default
+    void SetHugePages(bool);
+
+    // run the routines of the printing library (see the programs/print
+    // directory) natively rather than interpreting them, producing the same
+    // output, the routines are interpreted by default
+    void SetIntrinsics(bool);
+
+    // the devices used by the input and the output system calls,
+    // the std::cin and std::cout wrappers are used by default
+    void SetInput(std::shared_ptr<InputDevice>);
+    void SetOutput(std::shared_ptr<OutputDevice>);
+
+    // count the commands executed per address and per command code
+    // and write the report to the specified device after the execution,
+    // the executions are not profiled by default (nullptr)
+    void SetProfile(std::shared_ptr<OutputDevice>);
+
+    // record the calls of the functions and write the call stacks
+    // in the folded format (for the flame graphs) and the calls
+    // in the Chrome trace format to the specified devices respectively
+    void SetFoldedStacks(std::shared_ptr<OutputDevice>);
+    void SetTrace(std::shared_ptr<OutputDevice>);
+
+    // store the statistics of the execution to the specified object
+    // after the execution is finished (see the ExecutionStats struct)
+    void SetStats(std::shared_ptr<ExecutionStats>);
+
     static Config Strict();
     static Config ExtraStrict();
 
@@ -86,11 +158,63 @@ class Executor::Config {
     [[nodiscard]] size_t MaxStackSize() const;
     [[nodiscard]] size_t MinStackAddress() const;
 
+    [[nodiscard]] Engine GetEngine() const;
+
+    // empty if the native module is not specified
+    [[nodiscard]] const std::string& GetNativeModule() const;
+
+    [[nodiscard]] OutputBuffering GetOutputBuffering() const;
+    [[nodiscard]] size_t OutputBufferSize() const;
+
+    [[nodiscard]] bool UsesHugePages() const;
+    [[nodiscard]] bool UsesIntrinsics() const;
+
+    // true if the input device is explicitly set rather than the default one
+    [[nodiscard]] bool InputIsSet() const;
+
+    [[nodiscard]] std::shared_ptr<InputDevice> GetInput() const;
+    [[nodiscard]] std::shared_ptr<OutputDevice> GetOutput() const;
+
+    // nullptr if the respective report is not requested
+
+    [[nodiscard]] std::shared_ptr<OutputDevice> GetProfile() const;
+    [[nodiscard]] std::shared_ptr<OutputDevice> GetFoldedStacks() const;
+    [[nodiscard]] std::shared_ptr<OutputDevice> GetTrace() const;
+
+    // nullptr if the statistics are not requested
+    [[nodiscard]] std::shared_ptr<ExecutionStats> GetStats() const;
+
    private:
+    static constexpr Engine kDefaultEngine = TABLE;
+
+    static constexpr OutputBuffering kDefaultOutputBuffering = UNBUFFERED;
+    static constexpr size_t kDefaultOutputBufferSize         = 1 << 16;
+
+    static constexpr bool kDefaultHugePages  = false;
+    static constexpr bool kDefaultIntrinsics = false;
+
     AccessConfig write_;
     AccessConfig read_write_;
 
     std::optional<size_t> max_stack_size_;
+
+    std::optional<Engine> engine_;
+    std::string native_module_;
+
+    std::optional<OutputBuffering> output_buffering_;
+    size_t output_buffer_size_{kDefaultOutputBufferSize};
+
+    std::optional<bool> huge_pages_;
+    std::optional<bool> intrinsics_;
+
+    std::shared_ptr<InputDevice> input_;
+    std::shared_ptr<OutputDevice> output_;
+
+    std::shared_ptr<OutputDevice> profile_;
+    std::shared_ptr<OutputDevice> folded_stacks_;
+    std::shared_ptr<OutputDevice> trace_;
+
+    std::shared_ptr<ExecutionStats> stats_;
 };
 
 // NOLINTNEXTLINE(fuchsia-overloaded-operator)
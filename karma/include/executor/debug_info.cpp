@@ -0,0 +1,53 @@
+#include "debug_info.hpp"
+
+#include <mutex>     // for call_once
+#include <optional>  // for optional
+#include <span>      // for span
+#include <string>    // for string
+#include <utility>   // for move
+
+#include "exec/exec.hpp"
+#include "exec/symbols.hpp"
+#include "executor/intrinsics.hpp"
+#include "specs/architecture.hpp"
+
+namespace karma {
+
+namespace arch = detail::specs::arch;
+
+Executor::DebugInfo::DebugInfo(std::string encoded)
+    : encoded_(std::move(encoded)) {}
+
+const Exec::Symbols& Executor::DebugInfo::Symbols() const {
+    std::call_once(decoded_, [this]() {
+        if (std::optional<Exec::Symbols> symbols =
+                Exec::DecodeSymbols(encoded_)) {
+            symbols_ = std::move(*symbols);
+        }
+
+        // the encoded debug info is not needed anymore
+        encoded_.clear();
+        encoded_.shrink_to_fit();
+    });
+
+    return symbols_;
+}
+
+std::optional<std::string> Executor::DebugInfo::TryDescribe(
+    arch::Address address) const {
+    return Symbols().TryDescribe(address);
+}
+
+const Executor::Intrinsics& Executor::DebugInfo::Intrinsics(
+    std::span<const arch::Word> code,
+    std::span<const arch::Word> constants,
+    arch::Address entrypoint) const {
+    std::call_once(resolved_, [&]() {
+        intrinsics_ =
+            Executor::Intrinsics(Symbols(), code, constants, entrypoint);
+    });
+
+    return intrinsics_;
+}
+
+}  // namespace karma
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>     // for once_flag
+#include <optional>  // for optional
+#include <span>      // for span
+#include <string>    // for string
+
+#include "exec/exec.hpp"
+#include "exec/symbols.hpp"
+#include "executor/executor.hpp"
+#include "executor/intrinsics.hpp"
+#include "specs/architecture.hpp"
+
+namespace karma {
+
+// the debug info of a loaded program, which is decoded on the first use,
+// i.e. only once an execution of the program reports the profile or fails,
+// so that neither loading the program nor executing it pays for it otherwise
+//
+// is shared by the program and the snapshots captured from its executions
+class Executor::DebugInfo {
+   public:
+    explicit DebugInfo(std::string encoded);
+
+    // the executor must not fail because of its debug info,
+    // so the corrupted one is treated as missing
+    [[nodiscard]] const Exec::Symbols& Symbols() const;
+
+    // the nearest label and the source line of the address
+    // (see the Exec::Symbols::TryDescribe method)
+    [[nodiscard]] std::optional<std::string> TryDescribe(
+        detail::specs::arch::Address) const;
+
+    // the routines of the printing library found by the debug info
+    // in the initial code and constants segments of the program (see
+    // the Intrinsics class), are only resolved on the first use as well,
+    // i.e. once an execution enables the intrinsics
+    [[nodiscard]] const Executor::Intrinsics& Intrinsics(
+        std::span<const detail::specs::arch::Word> code,
+        std::span<const detail::specs::arch::Word> constants,
+        detail::specs::arch::Address entrypoint) const;
+
+   private:
+    mutable std::string encoded_;
+
+    mutable std::once_flag decoded_;
+    mutable Exec::Symbols symbols_;
+
+    mutable std::once_flag resolved_;
+    mutable Executor::Intrinsics intrinsics_;
+};
+
+}  // namespace karma
@@ -0,0 +1,294 @@
+#include "decode_cache.hpp"
+
+#include <algorithm>         // for find, min
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint8_t, uint64_t
+#include <initializer_list>  // for initializer_list
+#include <optional>          // for optional, nullopt
+#include <span>              // for span
+#include <vector>            // for vector
+
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+
+namespace karma {
+
+namespace arch = detail::specs::arch;
+namespace cmd  = detail::specs::cmd;
+
+namespace {
+
+// the commands after which the next executed command
+// is not necessarily the following one
+bool EndsBlock(cmd::Code code) {
+    switch (code) {
+        case cmd::HALT:
+        case cmd::SYSCALL:
+        case cmd::JMP:
+        case cmd::JNE:
+        case cmd::JEQ:
+        case cmd::JLE:
+        case cmd::JL:
+        case cmd::JGE:
+        case cmd::JG:
+        case cmd::CALL:
+        case cmd::CALLI:
+        case cmd::RET: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+}  // namespace
+
+Executor::DecodeCache::Instruction Executor::DecodeCache::Decode(
+    cmd::Bin command) {
+    // an unknown command is decoded with no operands, the respective
+    // execution error is thrown only when (and if) it is executed
+    const cmd::args::AnyArgs args = cmd::parse::Any(command);
+
+    return {
+        .code    = cmd::GetCode(command),
+        .recv    = args.recv,
+        .src     = args.src,
+        .operand = args.operand,
+    };
+}
+
+void Executor::DecodeCache::Prepare(const std::vector<cmd::Bin>& code) {
+    ++generation_;
+    modified_ = false;
+    invalidations_.clear();
+
+    valid_.assign(code.size(), 1);
+    codes_.resize(code.size());
+    recv_.resize(code.size());
+    src_.resize(code.size());
+    operands_.resize(code.size());
+    verified_.assign(code.size(), 0);
+    fusions_.assign(code.size(), NO_FUSION);
+
+    for (size_t address = 0; address < code.size(); ++address) {
+        const Instruction instr = Decode(code[address]);
+
+        codes_[address]    = static_cast<uint8_t>(instr.code);
+        recv_[address]     = static_cast<uint8_t>(instr.recv);
+        src_[address]      = static_cast<uint8_t>(instr.src);
+        operands_[address] = instr.operand;
+    }
+
+    for (size_t address = 0; address < code.size(); ++address) {
+        fusions_[address] = Fuse(static_cast<arch::Address>(address));
+    }
+
+    block_lengths_.assign(code.size(), 1);
+    for (size_t address = code.size(); address-- > 1;) {
+        const size_t prev = address - 1;
+        if (!EndsBlock(static_cast<cmd::Code>(codes_[prev]))) {
+            block_lengths_[prev] = static_cast<uint8_t>(
+                std::min<size_t>(block_lengths_[address] + 1, kMaxBlockLength));
+        }
+    }
+
+    leaders_.assign(code.size(), 0);
+    for (size_t address = 0; address < code.size(); ++address) {
+        cmd::MarkLeaders(static_cast<cmd::Code>(codes_[address]),
+                         operands_[address],
+                         static_cast<arch::Address>(address),
+                         leaders_);
+    }
+}
+
+void Executor::DecodeCache::Prepare(const DecodeCache& decoded) {
+    ++generation_;
+
+    // the assignment reuses the already allocated memory,
+    // so an executor running the same program again does not allocate
+    valid_         = decoded.valid_;
+    codes_         = decoded.codes_;
+    recv_          = decoded.recv_;
+    src_           = decoded.src_;
+    operands_      = decoded.operands_;
+    verified_      = decoded.verified_;
+    fusions_       = decoded.fusions_;
+    block_lengths_ = decoded.block_lengths_;
+    leaders_       = decoded.leaders_;
+    modified_      = decoded.modified_;
+
+    invalidations_.clear();
+}
+
+bool Executor::DecodeCache::Contains(arch::Address address) const {
+    return address < valid_.size() && valid_[address] != 0;
+}
+
+Executor::DecodeCache::Instruction Executor::DecodeCache::Get(
+    arch::Address address) const {
+    return {
+        .code     = static_cast<cmd::Code>(codes_[address]),
+        .recv     = recv_[address],
+        .src      = src_[address],
+        .operand  = operands_[address],
+        .verified = verified_[address] != 0,
+        .fusion   = static_cast<Fusion>(fusions_[address]),
+    };
+}
+
+void Executor::DecodeCache::Put(arch::Address address,
+                                const Instruction& instr) {
+    // the commands outside the initial code segment are written
+    // at runtime, they are not cached and are decoded on each execution
+    if (address >= valid_.size()) {
+        return;
+    }
+
+    valid_[address]    = 1;
+    codes_[address]    = static_cast<uint8_t>(instr.code);
+    recv_[address]     = static_cast<uint8_t>(instr.recv);
+    src_[address]      = static_cast<uint8_t>(instr.src);
+    operands_[address] = instr.operand;
+    verified_[address] = instr.verified ? 1 : 0;
+
+    Refuse(address);
+}
+
+void Executor::DecodeCache::Invalidate(arch::Address address) {
+    if (address < valid_.size()) {
+        valid_[address] = 0;
+        ++generation_;
+        modified_ = true;
+
+        // the older invalidations are forgotten all at once,
+        // so that the log is only appended to
+        if (invalidations_.size() == kMaxInvalidations) {
+            invalidations_.clear();
+        }
+
+        invalidations_.push_back(address);
+
+        Refuse(address);
+    }
+}
+
+void Executor::DecodeCache::Invalidate(arch::Address address, size_t size) {
+    // the range is clipped to the cached commands first,
+    // so writing the data outside of the code costs nothing
+    const size_t end = std::min(static_cast<size_t>(address) + size,
+                                valid_.size());
+
+    for (size_t curr = address; curr < end; ++curr) {
+        Invalidate(static_cast<arch::Address>(curr));
+    }
+}
+
+void Executor::DecodeCache::SetVerified(arch::Address address,
+                                        bool verified) {
+    verified_[address] = verified ? 1 : 0;
+}
+
+size_t Executor::DecodeCache::BlockLength(arch::Address address) const {
+    // the commands outside the initial code segment are batched one by one
+    return address < block_lengths_.size() ? block_lengths_[address] : 1;
+}
+
+const std::vector<uint8_t>& Executor::DecodeCache::Leaders() const {
+    return leaders_;
+}
+
+size_t Executor::DecodeCache::Size() const {
+    return valid_.size();
+}
+
+uint64_t Executor::DecodeCache::Generation() const {
+    return generation_;
+}
+
+std::optional<std::span<const arch::Address>>
+Executor::DecodeCache::InvalidatedSince(uint64_t generation) const {
+    // each invalidation changes the generation by one,
+    // so the last ones are exactly those since the generation
+    if (generation > generation_ ||
+        generation_ - generation > invalidations_.size()) {
+        return std::nullopt;
+    }
+
+    const std::span<const arch::Address> invalidations{invalidations_};
+    return invalidations.last(generation_ - generation);
+}
+
+bool Executor::DecodeCache::Modified() const {
+    return modified_;
+}
+
+size_t Executor::DecodeCache::Length(Fusion fusion) {
+    switch (fusion) {
+        case NO_FUSION: {
+            return 1;
+        }
+
+        case COMPARE_JUMP:
+        case LOAD_ARGUMENTS: {
+            return 2;
+        }
+
+        case CALL_SEQUENCE: {
+            return 3;
+        }
+    }
+
+    return 1;
+}
+
+Executor::DecodeCache::Fusion Executor::DecodeCache::Fuse(
+    arch::Address address) const {
+    const auto is_one_of = [this](arch::Address curr,
+                                  std::initializer_list<cmd::Code> codes) {
+        return Contains(curr) &&
+               std::find(codes.begin(),
+                         codes.end(),
+                         static_cast<cmd::Code>(codes_[curr])) != codes.end();
+    };
+
+    // the loaded register is neither the stack register nor the instruction
+    // one, so the following command is the next one to execute and it reads
+    // the argument relative to the same stack pointer
+    const auto loads_argument = [this, &is_one_of](arch::Address curr) {
+        return is_one_of(curr, {cmd::LOADR}) &&
+               src_[curr] == arch::kStackRegister &&
+               recv_[curr] != arch::kStackRegister &&
+               recv_[curr] != arch::kInstructionRegister;
+    };
+
+    if (is_one_of(address, {cmd::CMP, cmd::CMPI}) &&
+        is_one_of(address + 1,
+                  {cmd::JNE, cmd::JEQ, cmd::JLE, cmd::JL, cmd::JGE, cmd::JG})) {
+        return COMPARE_JUMP;
+    }
+
+    if (is_one_of(address, {cmd::PRC}) && is_one_of(address + 1, {cmd::PUSH}) &&
+        is_one_of(address + 2, {cmd::CALLI})) {
+        return CALL_SEQUENCE;
+    }
+
+    if (loads_argument(address) && loads_argument(address + 1)) {
+        return LOAD_ARGUMENTS;
+    }
+
+    return NO_FUSION;
+}
+
+void Executor::DecodeCache::Refuse(arch::Address address) {
+    constexpr auto kMaxOffset =
+        static_cast<arch::Address>(kMaxFusionLength - 1);
+
+    const arch::Address first = address > kMaxOffset ? address - kMaxOffset : 0;
+    for (arch::Address curr = first; curr <= address; ++curr) {
+        fusions_[curr] = Fuse(curr);
+    }
+}
+
+}  // namespace karma
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <cstdint>   // for uint8_t, uint64_t
+#include <optional>  // for optional
+#include <span>      // for span
+#include <vector>    // for vector
+
+#include "executor/executor.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+class Executor::DecodeCache : detail::utils::traits::NonCopyableMovable {
+   public:
+    // the short sequences of commands frequently emitted one after another,
+    // which are executed by a single handler (see the TableExecutor class)
+    // when the execution reaches the first command of the sequence
+    enum Fusion : uint8_t {
+        NO_FUSION,
+
+        // cmp or cmpi followed by a conditional jump
+        COMPARE_JUMP,
+
+        // prc, push and calli, i.e. the call of a function
+        // with a single argument
+        CALL_SEQUENCE,
+
+        // two loadr commands reading the arguments of a function
+        // relative to the stack register
+        LOAD_ARGUMENTS,
+    };
+
+    static constexpr size_t kMaxFusionLength = 3;
+
+    // the block lengths are stored as bytes,
+    // so the longer blocks are split into several ones
+    static constexpr size_t kMaxBlockLength = 255;
+
+    // the number of the last invalidated addresses remembered by the cache
+    // (see the InvalidatedSince method)
+    static constexpr size_t kMaxInvalidations = 1 << 12;
+
+    struct Instruction {
+        detail::specs::cmd::Code code;
+
+        // the register operand for the RM and RI formats commands
+        // and the receiver register operand for the RR format commands
+        detail::specs::cmd::args::Register recv;
+
+        // the source register operand for the RR format commands
+        detail::specs::cmd::args::Source src;
+
+        // the address operand for the RM and J formats commands,
+        // the sign-extended modifier for the RR format commands
+        // and the sign-extended immediate for the RI format commands
+        detail::specs::arch::Word operand;
+
+        // the command is proven not to fail by the Verifier class, which
+        // only verifies the commands of the initial code segment, so the
+        // commands decoded at runtime are never considered verified
+        bool verified{false};
+
+        // the command starts a sequence of commands executed together,
+        // the commands decoded at runtime are fused as well once they
+        // are put into the cache (see the Refuse method)
+        Fusion fusion{NO_FUSION};
+    };
+
+   public:
+    static Instruction Decode(detail::specs::cmd::Bin);
+
+    // the number of the commands executed by the fused sequence
+    static size_t Length(Fusion);
+
+    void Prepare(const std::vector<detail::specs::cmd::Bin>& code);
+
+    // the same as the above, but copies the already decoded commands
+    // (see the ProgramImage class) instead of decoding them again
+    void Prepare(const DecodeCache& decoded);
+
+    [[nodiscard]] bool Contains(detail::specs::arch::Address) const;
+    [[nodiscard]] Instruction Get(detail::specs::arch::Address) const;
+
+    void Put(detail::specs::arch::Address, const Instruction&);
+    void Invalidate(detail::specs::arch::Address);
+
+    // the same as the above, but for each address of the range
+    // (see the Storage::WMemRange method)
+    void Invalidate(detail::specs::arch::Address, size_t size);
+
+    void SetVerified(detail::specs::arch::Address, bool);
+
+    // the number of the commands from the address up to the end
+    // of its basic block (i.e. up to the first command which may transfer
+    // the control), which is only a hint for batching the commands
+    // (see the TableExecutor class), so it is computed once for the initial
+    // code segment and is not updated when the code is modified
+    [[nodiscard]] size_t BlockLength(detail::specs::arch::Address) const;
+
+    // the leaders of the basic blocks of the initial code segment (see
+    // the cmd::MarkLeaders function), which are computed once as well,
+    // so that each execution using them (see the JitExecutor class)
+    // does not look up the format of each command again
+    [[nodiscard]] const std::vector<uint8_t>& Leaders() const;
+
+    [[nodiscard]] size_t Size() const;
+
+    // the generation is changed on each invalidation of a cached command,
+    // which allows for the code derived from the cached commands (see the
+    // JitCompiler class) to check if it is still valid
+    [[nodiscard]] uint64_t Generation() const;
+
+    // the addresses invalidated since the generation (one per its change,
+    // so possibly repeated), or std::nullopt if they are no longer known,
+    // i.e. if the cache has been prepared or too many commands have been
+    // invalidated since then, in which case all the code derived from
+    // the cached commands is to be dropped
+    [[nodiscard]] std::optional<std::span<const detail::specs::arch::Address>>
+    InvalidatedSince(uint64_t generation) const;
+
+    // whether any command of the initial code segment has been invalidated
+    // since it was prepared, is kept by the copies of the cache, so that
+    // the snapshots of an execution remember its code has been modified
+    // (see the Intrinsics class)
+    [[nodiscard]] bool Modified() const;
+
+   private:
+    [[nodiscard]] Fusion Fuse(detail::specs::arch::Address) const;
+
+    // recomputes the fusions of all the sequences the command
+    // at the address may belong to
+    void Refuse(detail::specs::arch::Address);
+
+   private:
+    // the decoded operands are stored as a struct of arrays indexed
+    // by the command address to keep the cache compact
+
+    std::vector<uint8_t> valid_;
+    std::vector<uint8_t> codes_;
+    std::vector<uint8_t> recv_;
+    std::vector<uint8_t> src_;
+    std::vector<detail::specs::arch::Word> operands_;
+    std::vector<uint8_t> verified_;
+    std::vector<uint8_t> fusions_;
+    std::vector<uint8_t> block_lengths_;
+    std::vector<uint8_t> leaders_;
+
+    // the addresses invalidated in the last generations up to the current one
+    std::vector<detail::specs::arch::Address> invalidations_;
+
+    uint64_t generation_{0};
+    bool modified_{false};
+};
+
+}  // namespace karma
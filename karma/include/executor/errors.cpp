@@ -1,6 +1,7 @@
 #include "errors.hpp"
 
 #include <cstddef>  // for size_t
+#include <iomanip>  // for quoted
 #include <sstream>  // for ostringstream
 #include <string>   // for string
 
@@ -141,4 +142,77 @@ EE EE::Builder::InvalidPutCharValue(arch::Word value) {
     return EE{ss.str()};
 }
 
+EE EE::Builder::NoSnapshotPoint(arch::Word return_code) {
+    std::ostringstream ss;
+    ss << "the program finished with code " << return_code
+       << " without reaching a snapshot point (the SNAPSHOT syscall)";
+    return EE{ss.str()};
+}
+
+EE EE::Builder::MultithreadedSnapshot() {
+    return EE{
+        "the snapshot point is reached by a multithreaded execution, "
+        "the state of which cannot be captured"};
+}
+
+EE EE::Builder::JobFailed() {
+    return EE{
+        "the job has already failed with an error, "
+        "so it cannot be continued"};
+}
+
+EE EE::Builder::TooManyThreads(size_t max_threads) {
+    std::ostringstream ss;
+    ss << "cannot spawn a thread, because the execution already has "
+       << max_threads << " threads (including the finished ones)";
+    return EE{ss.str()};
+}
+
+EE EE::Builder::InvalidThread(arch::Word id) {
+    std::ostringstream ss;
+    ss << "cannot join the thread " << id
+       << ", because it is not a spawned thread other than the current one"
+          " or has already been joined";
+    return EE{ss.str()};
+}
+
+EE EE::Builder::ThreadsDeadlocked() {
+    return EE{
+        "the threads of the execution are waiting "
+        "for each other to finish"};
+}
+
+EE EE::Builder::NativeModuleNotSpecified() {
+    return EE{
+        "the native module is not specified for the native engine "
+        "(see Config::SetNativeModule)"};
+}
+
+EE EE::Builder::NativeModuleNotLoaded(const std::string& path,
+                                      const std::string& reason) {
+    std::ostringstream ss;
+    ss << "failed to load the native module " << std::quoted(path) << ": "
+       << reason;
+    return EE{ss.str()};
+}
+
+EE EE::Builder::NativeModuleMismatch(const std::string& path) {
+    std::ostringstream ss;
+    ss << "the native module " << std::quoted(path)
+       << " is translated from another program";
+    return EE{ss.str()};
+}
+
+EE EE::Builder::AtLocation(const ExecutionError& error,
+                           const std::string& location) {
+    // the message follows the "execution error: " prefix
+    const std::string what = error.what();
+    const size_t start     = what.find(": ");
+
+    const std::string message =
+        start == std::string::npos ? what : what.substr(start + 2);
+
+    return {message, "at " + location};
+}
+
 }  // namespace karma::errors::executor
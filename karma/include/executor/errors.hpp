@@ -51,6 +51,24 @@ struct ExecutionError::Builder : detail::utils::traits::Static {
     static ExecutionError DtoiOverflow(detail::specs::arch::Double);
 
     static ExecutionError InvalidPutCharValue(detail::specs::arch::Word);
+
+    static ExecutionError NoSnapshotPoint(detail::specs::arch::Word);
+    static ExecutionError MultithreadedSnapshot();
+    static ExecutionError JobFailed();
+
+    static ExecutionError TooManyThreads(size_t max_threads);
+    static ExecutionError InvalidThread(detail::specs::arch::Word);
+    static ExecutionError ThreadsDeadlocked();
+
+    static ExecutionError NativeModuleNotSpecified();
+    static ExecutionError NativeModuleNotLoaded(const std::string& path,
+                                                const std::string& reason);
+    static ExecutionError NativeModuleMismatch(const std::string& path);
+
+    // the same error, which is reported to have occurred at the location
+    // (see the Exec::Symbols::TryDescribe method)
+    static ExecutionError AtLocation(const ExecutionError&,
+                                     const std::string& location);
 };
 
 }  // namespace karma::errors::executor
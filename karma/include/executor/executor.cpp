@@ -1,11 +1,14 @@
 #include "executor.hpp"
 
 #include <memory>   // for make_unique
+#include <optional>  // for optional
 #include <string>   // for string
 #include <utility>  // for move
 
 #include "executor/config.hpp"
 #include "executor/impl.hpp"
+#include "executor/program.hpp"
+#include "executor/snapshot.hpp"
 #include "utils/logger.hpp"
 
 namespace karma {
@@ -40,4 +43,67 @@ Executor::ReturnCode Executor::Execute(const std::string& exec_path,
     return Execute(exec_path, Config(), log);
 }
 
+Executor::ReturnCode Executor::MustExecute(const Program& program,
+                                           const Config& config,
+                                           Logger log) {
+    return impl_->MustExecute(program, config, log.log);
+}
+
+Executor::ReturnCode Executor::Execute(const Program& program,
+                                       const Config& config,
+                                       Logger log) {
+    return impl_->Execute(program, config, log.log);
+}
+
+Executor::ReturnCode Executor::MustExecute(const Program& program,
+                                           Logger log) {
+    return MustExecute(program, Config(), log);
+}
+
+Executor::ReturnCode Executor::Execute(const Program& program, Logger log) {
+    return Execute(program, Config(), log);
+}
+
+Executor::Snapshot Executor::MustCapture(const Program& program,
+                                         const Config& config,
+                                         Logger log) {
+    return impl_->MustCapture(program, config, log.log);
+}
+
+std::optional<Executor::Snapshot> Executor::Capture(const Program& program,
+                                                    const Config& config,
+                                                    Logger log) {
+    return impl_->Capture(program, config, log.log);
+}
+
+Executor::Snapshot Executor::MustCapture(const Program& program, Logger log) {
+    return MustCapture(program, Config(), log);
+}
+
+std::optional<Executor::Snapshot> Executor::Capture(const Program& program,
+                                                    Logger log) {
+    return Capture(program, Config(), log);
+}
+
+Executor::ReturnCode Executor::MustExecute(const Snapshot& snapshot,
+                                           const Config& config,
+                                           Logger log) {
+    return impl_->MustExecute(snapshot, config, log.log);
+}
+
+Executor::ReturnCode Executor::Execute(const Snapshot& snapshot,
+                                       const Config& config,
+                                       Logger log) {
+    return impl_->Execute(snapshot, config, log.log);
+}
+
+Executor::ReturnCode Executor::MustExecute(const Snapshot& snapshot,
+                                           Logger log) {
+    return MustExecute(snapshot, Config(), log);
+}
+
+Executor::ReturnCode Executor::Execute(const Snapshot& snapshot, Logger log) {
+    return Execute(snapshot, Config(), log);
+}
+
 }  // namespace karma
@@ -19,23 +19,57 @@ struct ExecutionError;
 
 }  // namespace errors::executor
 
+class ExecutorPool;
+
 class Executor {
    private:
+    friend class ExecutorPool;
+
     friend struct errors::executor::Error;
     friend struct errors::executor::InternalError;
     friend struct errors::executor::ExecutionError;
 
    public:
     class Config;
+    class Program;
+    class ProgramCache;
+    class Snapshot;
+    class Job;
+    struct ExecutionStats;
+
+    class InputDevice;
+    class OutputDevice;
+    class StreamInput;
+    class StreamOutput;
+    class SpanInput;
+    class StringOutput;
+    class FdInput;
+    class FdOutput;
 
    private:
+    class ProgramImage;
+    class DebugInfo;
+    class Intrinsics;
+    struct SnapshotImage;
     class Storage;
+    class Threads;
+    class PagedMemory;
+    class DecodeCache;
+    class Verifier;
+    class OutputBuffer;
+    class InputParser;
+    class Profiler;
     class ExecutorBase;
     class CommonExecutor;
     class RMExecutor;
     class RRExecutor;
     class RIExecutor;
     class JExecutor;
+    class TableExecutor;
+    class JitCompiler;
+    class JitExecutor;
+    class NativeModule;
+    class NativeExecutor;
     class Impl;
 
    private:
@@ -76,6 +110,47 @@ class Executor {
     ReturnCode Execute(const std::string& exec_path,
                        Logger log = Logger::NoOp());
 
+    // the same as the above, but execute an already loaded program
+    // without reading the executable file again
+
+    ReturnCode MustExecute(const Program&,
+                           const Config&,
+                           Logger log = Logger::NoOp());
+    ReturnCode Execute(const Program&,
+                       const Config&,
+                       Logger log = Logger::NoOp());
+
+    ReturnCode MustExecute(const Program&, Logger log = Logger::NoOp());
+    ReturnCode Execute(const Program&, Logger log = Logger::NoOp());
+
+    // execute the program up to the snapshot point (the SNAPSHOT system call)
+    // and capture the state of the Karma computer at that point, an execution
+    // error occurs if the program finishes without reaching the snapshot point
+
+    Snapshot MustCapture(const Program&,
+                         const Config&,
+                         Logger log = Logger::NoOp());
+    std::optional<Snapshot> Capture(const Program&,
+                                    const Config&,
+                                    Logger log = Logger::NoOp());
+
+    Snapshot MustCapture(const Program&, Logger log = Logger::NoOp());
+    std::optional<Snapshot> Capture(const Program&,
+                                    Logger log = Logger::NoOp());
+
+    // resume the execution from the snapshot point,
+    // any number of executions can be resumed from the same snapshot
+
+    ReturnCode MustExecute(const Snapshot&,
+                           const Config&,
+                           Logger log = Logger::NoOp());
+    ReturnCode Execute(const Snapshot&,
+                       const Config&,
+                       Logger log = Logger::NoOp());
+
+    ReturnCode MustExecute(const Snapshot&, Logger log = Logger::NoOp());
+    ReturnCode Execute(const Snapshot&, Logger log = Logger::NoOp());
+
    private:
     std::unique_ptr<Impl> impl_;
 };
@@ -106,10 +181,16 @@ struct InternalError : Error {
 struct ExecutionError : Error {
    private:
     friend class Executor::Storage;
+    friend class Executor::Threads;
     friend class Executor::CommonExecutor;
     friend class Executor::RIExecutor;
     friend class Executor::RRExecutor;
+    friend class Executor::TableExecutor;
+    friend class Executor::JitExecutor;
+    friend class Executor::NativeModule;
+    friend class Executor::NativeExecutor;
     friend class Executor::Impl;
+    friend class Executor::Job;
 
    private:
     struct Builder;
@@ -117,6 +198,9 @@ struct ExecutionError : Error {
    private:
     explicit ExecutionError(const std::string& message)
         : Error("execution error: " + message) {}
+
+    ExecutionError(const std::string& message, const std::string& where)
+        : Error("execution error " + where + ": " + message) {}
 };
 
 }  // namespace errors::executor
@@ -1,23 +1,36 @@
 #include "executor_base.hpp"
 
+#include <atomic>    // for atomic_ref
+#include <cstddef>   // for size_t
+#include <cstdint>   // for uint8_t, uint64_t
+#include <mutex>     // for mutex, unique_lock
+#include <optional>  // for optional
+#include <span>      // for span
+#include <string>    // for string
+#include <vector>    // for vector
+
+#include "executor/decode_cache.hpp"
+#include "executor/io.hpp"
+#include "executor/output_buffer.hpp"
+#include "executor/paged_memory.hpp"
+#include "executor/profiler.hpp"
+#include "executor/stats.hpp"
 #include "executor/storage.hpp"
+#include "executor/threads.hpp"
 #include "specs/architecture.hpp"
 
 namespace karma {
 
 namespace arch = detail::specs::arch;
 
-void Executor::ExecutorBase::CheckPushAllowed() {
-    storage_->CheckPushAllowed();
-}
-
 arch::Word Executor::ExecutorBase::RReg(arch::Register reg,
                                         bool internal_usage) const {
     return storage_->RReg(reg, internal_usage);
 }
 
-arch::Word Executor::ExecutorBase::RMem(arch::Address address) const {
-    return storage_->RMem(address);
+arch::Word Executor::ExecutorBase::RMem(arch::Address address,
+                                        bool internal_usage) const {
+    return storage_->RMem(address, internal_usage);
 }
 
 arch::Word& Executor::ExecutorBase::WReg(arch::Register reg,
@@ -25,12 +38,175 @@ arch::Word& Executor::ExecutorBase::WReg(arch::Register reg,
     return storage_->WReg(reg, internal_usage);
 }
 
-arch::Word& Executor::ExecutorBase::WMem(arch::Address address) {
+Executor::PagedMemory::SharedWord Executor::ExecutorBase::WMem(
+    arch::Address address) {
     return storage_->WMem(address);
 }
 
+std::atomic_ref<arch::Word> Executor::ExecutorBase::AMem(
+    arch::Address address) {
+    return storage_->AMem(address);
+}
+
+const arch::Word* Executor::ExecutorBase::RMemRange(arch::Address address,
+                                                    arch::Word size) {
+    return storage_->RMemRange(address, size);
+}
+
+arch::Word* Executor::ExecutorBase::WMemRange(arch::Address address,
+                                              arch::Word size) {
+    return storage_->WMemRange(address, size);
+}
+
 arch::Word& Executor::ExecutorBase::Flags() {
     return storage_->Flags();
 }
 
+bool Executor::ExecutorBase::ReachSnapshot() {
+    return storage_->ReachSnapshot();
+}
+
+bool Executor::ExecutorBase::IsSliced() const {
+    return storage_->IsSliced();
+}
+
+bool Executor::ExecutorBase::IsFueled() const {
+    return storage_->IsFueled();
+}
+
+uint64_t& Executor::ExecutorBase::Fuel() {
+    return storage_->Fuel();
+}
+
+void Executor::ExecutorBase::Interrupt(Storage::Interruption interruption) {
+    storage_->Interrupt(interruption);
+}
+
+Executor::Threads::Id Executor::ExecutorBase::Spawn(arch::Address entry,
+                                                    arch::Address stack) {
+    return storage_->Spawn(entry, stack);
+}
+
+std::optional<arch::Word> Executor::ExecutorBase::TryJoin(Threads::Id id) {
+    return storage_->TryJoin(id);
+}
+
+bool Executor::ExecutorBase::IsMultithreaded() const {
+    return storage_->IsMultithreaded();
+}
+
+bool Executor::ExecutorBase::Synchronize() {
+    return storage_->Synchronize();
+}
+
+bool Executor::ExecutorBase::Stopped() const {
+    return storage_->Stopped();
+}
+
+void Executor::ExecutorBase::Exit() {
+    storage_->Exit();
+}
+
+std::unique_lock<std::mutex> Executor::ExecutorBase::LockDevices() {
+    return storage_->LockDevices();
+}
+
+Executor::InputDevice& Executor::ExecutorBase::Input() {
+    return storage_->Input();
+}
+
+Executor::OutputBuffer& Executor::ExecutorBase::Output() {
+    return storage_->Output();
+}
+
+Executor::Profiler& Executor::ExecutorBase::Profile() {
+    return storage_->Profile();
+}
+
+Executor::ExecutionStats& Executor::ExecutorBase::Stats() {
+    return storage_->Stats();
+}
+
+Executor::Storage::RetiredCommands& Executor::ExecutorBase::Retired() {
+    return storage_->Retired();
+}
+
+bool Executor::ExecutorBase::IsPermissive() const {
+    return storage_->IsPermissive();
+}
+
+Executor::DecodeCache::Instruction Executor::ExecutorBase::Fetch(
+    arch::Address address) {
+    return storage_->Fetch(address);
+}
+
+size_t Executor::ExecutorBase::BlockLength(arch::Address address) const {
+    return storage_->BlockLength(address);
+}
+
+const std::vector<uint8_t>* Executor::ExecutorBase::CodeLeaders() const {
+    return storage_->CodeLeaders();
+}
+
+size_t Executor::ExecutorBase::CodeSegmentSize() const {
+    return storage_->CodeSegmentSize();
+}
+
+uint64_t Executor::ExecutorBase::CodeGeneration() const {
+    return storage_->CodeGeneration();
+}
+
+std::optional<std::span<const arch::Address>>
+Executor::ExecutorBase::InvalidatedCodeSince(uint64_t generation) const {
+    return storage_->InvalidatedCodeSince(generation);
+}
+
+bool Executor::ExecutorBase::CanRReg(arch::Register reg) const {
+    return storage_->CanRReg(reg);
+}
+
+bool Executor::ExecutorBase::CanRMem(arch::Address address) const {
+    return storage_->CanRMem(address);
+}
+
+bool Executor::ExecutorBase::CanWReg(arch::Register reg) const {
+    return storage_->CanWReg(reg);
+}
+
+bool Executor::ExecutorBase::CanWMem(arch::Address address) const {
+    return storage_->CanWMem(address);
+}
+
+arch::Word* Executor::ExecutorBase::RegistersData() {
+    return storage_->RegistersData();
+}
+
+arch::Word* Executor::ExecutorBase::MemoryData() {
+    return storage_->MemoryData();
+}
+
+void Executor::ExecutorBase::MarkMemoryDirty(arch::Address address) {
+    storage_->MarkMemoryDirty(address);
+}
+
+uint8_t* Executor::ExecutorBase::DirtyPagesData() {
+    return storage_->DirtyPagesData();
+}
+
+size_t Executor::ExecutorBase::MinStackAddress() const {
+    return storage_->MinStackAddress();
+}
+
+const Executor::Intrinsics* Executor::ExecutorBase::GetIntrinsics() const {
+    return storage_->GetIntrinsics();
+}
+
+size_t Executor::ExecutorBase::StackSpace() const {
+    return storage_->StackSpace();
+}
+
+const std::string& Executor::ExecutorBase::NativeModulePath() const {
+    return storage_->NativeModulePath();
+}
+
 }  // namespace karma
@@ -1,9 +1,25 @@
 #pragma once
 
-#include <memory>   // for shared_ptr
-#include <utility>  // for move
+#include <atomic>    // for atomic_ref
+#include <cstddef>   // for size_t
+#include <cstdint>   // for uint8_t, uint64_t
+#include <memory>    // for shared_ptr
+#include <mutex>     // for mutex, unique_lock
+#include <optional>  // for optional
+#include <span>      // for span
+#include <string>    // for string
+#include <utility>   // for move
+#include <vector>    // for vector
 
+#include "executor/decode_cache.hpp"
 #include "executor/executor.hpp"
+#include "executor/io.hpp"
+#include "executor/output_buffer.hpp"
+#include "executor/paged_memory.hpp"
+#include "executor/profiler.hpp"
+#include "executor/stats.hpp"
+#include "executor/storage.hpp"
+#include "executor/threads.hpp"
 #include "specs/architecture.hpp"
 #include "utils/traits.hpp"
 
@@ -21,18 +37,112 @@ class Executor::ExecutorBase : detail::utils::traits::NonCopyableMovable {
    protected:
     static const bool kInternalUse = true;
 
-    void CheckPushAllowed();
+    // is inlined, as it is called on each push
+    void CheckPushAllowed() {
+        storage_->CheckPushAllowed();
+    }
 
     [[nodiscard]] detail::specs::arch::Word RReg(
         detail::specs::arch::Register, bool internal_usage = false) const;
     [[nodiscard]] detail::specs::arch::Word RMem(
-        detail::specs::arch::Address) const;
+        detail::specs::arch::Address, bool internal_usage = false) const;
 
     detail::specs::arch::Word& WReg(detail::specs::arch::Register,
                                     bool internal_usage = false);
-    detail::specs::arch::Word& WMem(detail::specs::arch::Address);
+    PagedMemory::SharedWord WMem(detail::specs::arch::Address);
+    std::atomic_ref<detail::specs::arch::Word> AMem(
+        detail::specs::arch::Address);
     detail::specs::arch::Word& Flags();
 
+    const detail::specs::arch::Word* RMemRange(detail::specs::arch::Address,
+                                               detail::specs::arch::Word size);
+    detail::specs::arch::Word* WMemRange(detail::specs::arch::Address,
+                                         detail::specs::arch::Word size);
+
+    bool ReachSnapshot();
+
+    [[nodiscard]] bool IsSliced() const;
+    [[nodiscard]] bool IsFueled() const;
+    uint64_t& Fuel();
+    void Interrupt(Storage::Interruption);
+
+    Threads::Id Spawn(detail::specs::arch::Address entry,
+                      detail::specs::arch::Address stack);
+    std::optional<detail::specs::arch::Word> TryJoin(Threads::Id);
+    [[nodiscard]] bool IsMultithreaded() const;
+    bool Synchronize();
+    [[nodiscard]] bool Stopped() const;
+    void Exit();
+    std::unique_lock<std::mutex> LockDevices();
+
+    InputDevice& Input();
+    OutputBuffer& Output();
+    Profiler& Profile();
+
+    ExecutionStats& Stats();
+    Storage::RetiredCommands& Retired();
+
+    // the following methods are inlined, so that the executors instantiating
+    // their main loops for a specific policy do not pay for the policy check
+
+    [[nodiscard]] bool IsPermissive() const;
+
+    template <typename Policy>
+    [[nodiscard]] detail::specs::arch::Word RReg(
+        detail::specs::arch::Register reg, bool internal_usage = false) const {
+        return storage_->RReg<Policy>(reg, internal_usage);
+    }
+
+    template <typename Policy>
+    [[nodiscard]] detail::specs::arch::Word RMem(
+        detail::specs::arch::Address address) const {
+        return storage_->RMem<Policy>(address);
+    }
+
+    template <typename Policy>
+    detail::specs::arch::Word& WReg(detail::specs::arch::Register reg,
+                                    bool internal_usage = false) {
+        return storage_->WReg<Policy>(reg, internal_usage);
+    }
+
+    template <typename Policy>
+    PagedMemory::SharedWord WMem(detail::specs::arch::Address address) {
+        return storage_->WMem<Policy>(address);
+    }
+
+    template <typename Policy>
+    std::atomic_ref<detail::specs::arch::Word> AMem(
+        detail::specs::arch::Address address) {
+        return storage_->AMem<Policy>(address);
+    }
+
+    DecodeCache::Instruction Fetch(detail::specs::arch::Address);
+
+    [[nodiscard]] size_t BlockLength(detail::specs::arch::Address) const;
+    [[nodiscard]] const std::vector<uint8_t>* CodeLeaders() const;
+    [[nodiscard]] size_t CodeSegmentSize() const;
+    [[nodiscard]] uint64_t CodeGeneration() const;
+
+    [[nodiscard]] std::optional<std::span<const detail::specs::arch::Address>>
+    InvalidatedCodeSince(uint64_t generation) const;
+
+    [[nodiscard]] bool CanRReg(detail::specs::arch::Register) const;
+    [[nodiscard]] bool CanRMem(detail::specs::arch::Address) const;
+    [[nodiscard]] bool CanWReg(detail::specs::arch::Register) const;
+    [[nodiscard]] bool CanWMem(detail::specs::arch::Address) const;
+
+    detail::specs::arch::Word* RegistersData();
+    detail::specs::arch::Word* MemoryData();
+    void MarkMemoryDirty(detail::specs::arch::Address);
+
+    uint8_t* DirtyPagesData();
+
+    [[nodiscard]] size_t MinStackAddress() const;
+    [[nodiscard]] const std::string& NativeModulePath() const;
+
+    [[nodiscard]] const Intrinsics* GetIntrinsics() const;
+    [[nodiscard]] size_t StackSpace() const;
+
    private:
     std::shared_ptr<Storage> storage_;
 };
@@ -0,0 +1,156 @@
+#include "executor_pool.hpp"
+
+#include <algorithm>  // for max
+#include <cstddef>    // for size_t
+#include <future>     // for future
+#include <mutex>      // for lock_guard, unique_lock
+#include <ostream>    // for ostream
+#include <thread>     // for thread
+#include <utility>    // for move
+
+#include "executor/config.hpp"
+#include "executor/program.hpp"
+#include "executor/snapshot.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+size_t ExecutorPool::DefaultSize() {
+    // the number of the hardware threads is 0 if it is not computable
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::Submit(Task task) {
+    std::future<ReturnCode> result = task.get_future();
+
+    {
+        const std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+
+    has_tasks_.notify_one();
+    return result;
+}
+
+void ExecutorPool::Work(const Executor::Config& config) {
+    Executor executor(config);
+
+    // a separate no-op stream for each worker, because the one returned
+    // by the Logger::NoOp method is shared between all the threads
+    std::ostream no_op(nullptr);
+
+    while (true) {
+        Task task;
+
+        {
+            std::unique_lock lock(mutex_);
+            has_tasks_.wait(lock,
+                            [this] { return stopped_ || !tasks_.empty(); });
+
+            // the pool is stopped only after all the tasks are executed
+            if (tasks_.empty()) {
+                return;
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task(executor, no_op);
+    }
+}
+
+ExecutorPool::ExecutorPool()
+    : ExecutorPool(DefaultSize(), Executor::Config()) {}
+
+ExecutorPool::ExecutorPool(size_t n_workers)
+    : ExecutorPool(n_workers, Executor::Config()) {}
+
+ExecutorPool::ExecutorPool(Executor::Config config)
+    : ExecutorPool(DefaultSize(), std::move(config)) {}
+
+ExecutorPool::ExecutorPool(size_t n_workers, Executor::Config config) {
+    workers_.reserve(n_workers);
+    for (size_t i = 0; i < n_workers; ++i) {
+        workers_.emplace_back([this, config] { Work(config); });
+    }
+}
+
+ExecutorPool::~ExecutorPool() {
+    {
+        const std::lock_guard lock(mutex_);
+        stopped_ = true;
+    }
+
+    has_tasks_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::MustExecute(
+    Executor::Program program,
+    Executor::Config config) {
+    return Submit(Task([program = std::move(program),
+                        config  = std::move(config)](Executor& executor,
+                                                     Logger log) {
+        return executor.MustExecute(program, config, log);
+    }));
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::Execute(
+    Executor::Program program,
+    Executor::Config config) {
+    return Submit(Task([program = std::move(program),
+                        config  = std::move(config)](Executor& executor,
+                                                     Logger log) {
+        return executor.Execute(program, config, log);
+    }));
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::MustExecute(
+    Executor::Program program) {
+    return MustExecute(std::move(program), Executor::Config());
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::Execute(
+    Executor::Program program) {
+    return Execute(std::move(program), Executor::Config());
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::MustExecute(
+    Executor::Snapshot snapshot,
+    Executor::Config config) {
+    return Submit(Task([snapshot = std::move(snapshot),
+                        config   = std::move(config)](Executor& executor,
+                                                      Logger log) {
+        return executor.MustExecute(snapshot, config, log);
+    }));
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::Execute(
+    Executor::Snapshot snapshot,
+    Executor::Config config) {
+    return Submit(Task([snapshot = std::move(snapshot),
+                        config   = std::move(config)](Executor& executor,
+                                                      Logger log) {
+        return executor.Execute(snapshot, config, log);
+    }));
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::MustExecute(
+    Executor::Snapshot snapshot) {
+    return MustExecute(std::move(snapshot), Executor::Config());
+}
+
+std::future<ExecutorPool::ReturnCode> ExecutorPool::Execute(
+    Executor::Snapshot snapshot) {
+    return Execute(std::move(snapshot), Executor::Config());
+}
+
+size_t ExecutorPool::Size() const {
+    return workers_.size();
+}
+
+}  // namespace karma
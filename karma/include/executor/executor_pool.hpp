@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>  // for condition_variable
+#include <cstddef>             // for size_t
+#include <deque>               // for deque
+#include <future>              // for future, packaged_task
+#include <mutex>               // for mutex
+#include <thread>              // for thread
+#include <vector>              // for vector
+
+#include "config.hpp"
+#include "executor.hpp"
+#include "program.hpp"
+#include "snapshot.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+// runs the executions of the loaded programs concurrently on a fixed number
+// of worker threads, each of which owns a separate Executor (i.e. a separate
+// Karma computer with its own registers and memory)
+//
+// the executions are not logged, because the log streams are not expected
+// to be written to concurrently, the input and the output devices of
+// the concurrent executions are to be set separately via their configs
+// for the same reason (see the I/O devices section of the README)
+class ExecutorPool {
+   private:
+    using ReturnCode = Executor::ReturnCode;
+    using Task       = std::packaged_task<ReturnCode(Executor&, Logger)>;
+
+   private:
+    static size_t DefaultSize();
+
+    std::future<ReturnCode> Submit(Task);
+    void Work(const Executor::Config&);
+
+   public:
+    // the number of the worker threads defaults to the number of
+    // the hardware threads, the config is the common configuration
+    // of the executors of the workers (see the Executor constructor)
+
+    ExecutorPool();
+    explicit ExecutorPool(size_t n_workers);
+    explicit ExecutorPool(Executor::Config);
+    ExecutorPool(size_t n_workers, Executor::Config);
+
+    // waits for all the submitted executions to finish
+    ~ExecutorPool();
+
+    // do not include utils/traits, because we don't want to expose
+    // internal features of the karma library to the user
+
+    // utils::traits::NonCopyableNonMovable
+
+    // Non-copyable
+    ExecutorPool(const ExecutorPool&)            = delete;
+    ExecutorPool& operator=(const ExecutorPool&) = delete;
+
+    // Non-movable, because the workers refer to the pool
+    ExecutorPool(ExecutorPool&&)            = delete;
+    ExecutorPool& operator=(ExecutorPool&&) = delete;
+
+   public:
+    // the returned future provides the return code of the execution,
+    // or rethrows the exception thrown by the respective method
+    // of the Executor class
+
+    std::future<ReturnCode> MustExecute(Executor::Program, Executor::Config);
+    std::future<ReturnCode> Execute(Executor::Program, Executor::Config);
+
+    std::future<ReturnCode> MustExecute(Executor::Program);
+    std::future<ReturnCode> Execute(Executor::Program);
+
+    // the same as the above, but resume the executions from the snapshot
+
+    std::future<ReturnCode> MustExecute(Executor::Snapshot, Executor::Config);
+    std::future<ReturnCode> Execute(Executor::Snapshot, Executor::Config);
+
+    std::future<ReturnCode> MustExecute(Executor::Snapshot);
+    std::future<ReturnCode> Execute(Executor::Snapshot);
+
+    [[nodiscard]] size_t Size() const;
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable has_tasks_;
+    std::deque<Task> tasks_;
+    bool stopped_{false};
+
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace karma
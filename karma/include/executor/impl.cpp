@@ -1,11 +1,25 @@
 #include "impl.hpp"
 
+#include <time.h>  // for clock_gettime, timespec, CLOCK_THREAD_CPUTIME_ID
+
+#include <chrono>     // for steady_clock, nanoseconds, seconds
+#include <cstdint>    // for uint64_t
 #include <exception>  // for exception
 #include <iostream>   // for cerr, endl
+#include <memory>     // for shared_ptr, make_shared
+#include <optional>   // for optional, nullopt
 #include <string>     // for string
 
 #include "exec/exec.hpp"
 #include "executor/config.hpp"
+#include "executor/program.hpp"
+#include "executor/program_cache.hpp"
+#include "executor/profiler.hpp"
+#include "executor/program_image.hpp"
+#include "executor/snapshot.hpp"
+#include "executor/snapshot_image.hpp"
+#include "executor/stats.hpp"
+#include "executor/storage.hpp"
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
 #include "utils/error.hpp"
@@ -15,12 +29,59 @@ namespace karma {
 namespace arch = detail::specs::arch;
 namespace cmd  = detail::specs::cmd;
 
+namespace {
+
+// measures the wall time and the CPU time of the current thread
+class Stopwatch {
+   private:
+    using Clock = std::chrono::steady_clock;
+
+   private:
+    static std::chrono::nanoseconds ThreadCPUTime() {
+        timespec time{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+
+        return std::chrono::seconds(time.tv_sec) +
+               std::chrono::nanoseconds(time.tv_nsec);
+    }
+
+   public:
+    [[nodiscard]] Executor::ExecutionStats::Time Elapsed() const {
+        return {.wall = Clock::now() - wall_start_,
+                .cpu  = ThreadCPUTime() - cpu_start_};
+    }
+
+   private:
+    Clock::time_point wall_start_{Clock::now()};
+    std::chrono::nanoseconds cpu_start_{ThreadCPUTime()};
+};
+
+void Accumulate(Executor::ExecutionStats::Time& total,
+                const Executor::ExecutionStats::Time& time) {
+    total.wall += time.wall;
+    total.cpu += time.cpu;
+}
+
+// the slices use the TableExecutor class, the main loop of which is not
+// instantiated for the sliced and profiled executions at the same time
+Executor::Config WithoutProfile(const Executor::Config& config) {
+    Executor::Config result = config;
+    result.SetProfile(nullptr);
+    result.SetFoldedStacks(nullptr);
+    result.SetTrace(nullptr);
+    return result;
+}
+
+}  // namespace
+
 Executor::MaybeReturnCode Executor::Impl::ExecuteCmd(cmd::Bin command) {
     auto code = cmd::GetCode(command);
     if (!cmd::kCodeToFormat.contains(code)) {
         throw ExecutionError::UnknownCommand(code);
     }
 
+    ++storage_->Retired().at(code);
+
     switch (const cmd::Format format = cmd::kCodeToFormat.at(code)) {
         case cmd::RM: {
             if (!rm_map_.contains(code)) {
@@ -64,23 +125,7 @@ Executor::MaybeReturnCode Executor::Impl::ExecuteCmd(cmd::Bin command) {
     }
 }
 
-Executor::ReturnCode Executor::Impl::ExecuteImpl(const std::string& exec_path,
-                                                 const Config& config,
-                                                 std::ostream& log) {
-    log << "[executor]: reading the executable file\n";
-
-    const Exec::Data data = Exec::Read(exec_path);
-
-    log << "[executor]: successfully read the executable file\n";
-
-    log << "[executor]: preparing for execution\n";
-
-    storage_->PrepareForExecution(data, config, log);
-
-    log << "[executor]: successfully prepared for execution\n";
-
-    log << "[executor]: executing the program\n";
-
+Executor::ReturnCode Executor::Impl::RunMapped() {
     while (true) {
         const arch::Address curr_address =
             storage_->RReg(arch::kInstructionRegister, true);
@@ -97,20 +142,338 @@ Executor::ReturnCode Executor::Impl::ExecuteImpl(const std::string& exec_path,
 
         if (MaybeReturnCode return_code =
                 ExecuteCmd(storage_->RMem(curr_address, true))) {
-            log << "[executor]: the program finished execution with code "
-                << *return_code << '\n';
             return *return_code;
         }
     }
 }
 
-Executor::ReturnCode Executor::Impl::MustExecute(const std::string& exec_path,
+Executor::ReturnCode Executor::Impl::RunOn(Config::Engine engine) {
+    ReturnCode return_code{};
+
+    switch (engine) {
+        case Config::MAPPED: {
+            return_code = RunMapped();
+            break;
+        }
+
+        case Config::TABLE: {
+            return_code = table_.Run();
+            break;
+        }
+
+        case Config::JIT: {
+            return_code = jit_.Run();
+            break;
+        }
+
+        case Config::NATIVE: {
+            return_code = native_.Run();
+            break;
+        }
+    }
+
+    return return_code;
+}
+
+Executor::ReturnCode Executor::Impl::RunThreads(Config::Engine engine) {
+    // the main thread takes its turns once the program spawns a thread
+    // or once the threads paused by the previous slice are resumed
+    bool in_turns = false;
+
+    try {
+        while (true) {
+            if (storage_->IsMultithreaded()) {
+                // the turns are only charged by the TableExecutor class, and
+                // the other engines keep the registers in their own state,
+                // so the rest of the main thread is run by it
+                engine = Config::TABLE;
+
+                if (!in_turns) {
+                    storage_->ResumeThreads();
+                    in_turns = true;
+                }
+
+                if (!storage_->StartTurn()) {
+                    storage_->PauseThreads();
+                    return 0;
+                }
+            }
+
+            const ReturnCode return_code = RunOn(engine);
+
+            if (in_turns) {
+                storage_->EndTurn();
+            }
+
+            switch (storage_->GetInterruption()) {
+                case Storage::NOT_INTERRUPTED: {
+                    storage_->StopThreads();
+                    return return_code;
+                }
+
+                case Storage::HALTED:
+                case Storage::BLOCKED_ON_INPUT: {
+                    if (in_turns) {
+                        storage_->PauseThreads();
+                    }
+
+                    return return_code;
+                }
+
+                case Storage::OUT_OF_FUEL: {
+                    // the turn of the main thread is over,
+                    // unless the whole slice is
+                    if (!in_turns) {
+                        return return_code;
+                    }
+
+                    break;
+                }
+
+                case Storage::RESCHEDULED: {
+                    if (in_turns) {
+                        storage_->Wait();
+                    }
+
+                    break;
+                }
+            }
+
+            storage_->Interrupt(Storage::NOT_INTERRUPTED);
+        }
+    } catch (...) {
+        storage_->StopThreads();
+        throw;
+    }
+}
+
+Executor::ReturnCode Executor::Impl::RunEngine(ExecutionStats::Time& run) {
+    // the commands are only counted and the fuel is only charged by
+    // the TableExecutor class, so the profiled and the sliced executions
+    // use it regardless of the engine specified by the config
+    const Config::Engine engine =
+        storage_->Profile().IsEnabled() || storage_->IsSliced()
+            ? Config::TABLE
+            : storage_->GetEngine();
+
+    const Stopwatch stopwatch;
+
+    // do not lose the buffered output of the program
+    // printed before the error has occurred
+    auto finish_failed = [this, &stopwatch, &run]() {
+        storage_->Output().Flush();
+        storage_->ReportProfile();
+
+        Accumulate(run, stopwatch.Elapsed());
+        storage_->FinishStats(run);
+    };
+
+    ReturnCode return_code{};
+    try {
+        return_code = RunThreads(engine);
+    } catch (const errors::executor::ExecutionError& error) {
+        finish_failed();
+
+        // the debug info is only decoded here, so the successful executions
+        // never pay for symbolizing the errors
+        if (std::optional<std::string> location =
+                storage_->TryDescribe(storage_->FailedAddress())) {
+            throw ExecutionError::AtLocation(error, *location);
+        }
+
+        throw;
+    } catch (...) {
+        finish_failed();
+        throw;
+    }
+
+    Accumulate(run, stopwatch.Elapsed());
+
+    return return_code;
+}
+
+Executor::ReturnCode Executor::Impl::Run() {
+    ExecutionStats::Time run;
+    const ReturnCode return_code = RunEngine(run);
+
+    storage_->ReportProfile();
+    storage_->FinishStats(run);
+
+    return return_code;
+}
+
+Executor::ReturnCode Executor::Impl::ExecuteImpl(
+    const ProgramImage& image,
+    const Config& config,
+    std::ostream& log,
+    const ExecutionStats::Time& load) {
+    log << "[executor]: preparing for execution\n";
+
+    const Stopwatch stopwatch;
+
+    storage_->PrepareForExecution(image, config, log);
+
+    storage_->Stats().load  = load;
+    storage_->Stats().setup = stopwatch.Elapsed();
+
+    log << "[executor]: successfully prepared for execution\n";
+
+    log << "[executor]: executing the program\n";
+
+    const ReturnCode return_code = Run();
+
+    log << "[executor]: the program finished execution with code "
+        << return_code << '\n';
+
+    return return_code;
+}
+
+Executor::ReturnCode Executor::Impl::ExecuteImpl(const SnapshotImage& image,
                                                  const Config& config,
                                                  std::ostream& log) {
+    log << "[executor]: restoring the snapshot\n";
+
+    const Stopwatch stopwatch;
+
+    storage_->PrepareForExecution(image, config, log);
+
+    storage_->Stats().setup = stopwatch.Elapsed();
+
+    log << "[executor]: successfully restored the snapshot\n";
+
+    log << "[executor]: resuming the program\n";
+
+    const ReturnCode return_code = Run();
+
+    log << "[executor]: the program finished execution with code "
+        << return_code << '\n';
+
+    return return_code;
+}
+
+std::shared_ptr<const Executor::SnapshotImage> Executor::Impl::CaptureImpl(
+    const ProgramImage& image,
+    const Config& config,
+    std::ostream& log) {
+    log << "[executor]: preparing for execution\n";
+
+    const Stopwatch stopwatch;
+
+    storage_->PrepareForExecution(image, config, log);
+    storage_->StopAtSnapshot();
+
+    storage_->Stats().setup = stopwatch.Elapsed();
+
+    log << "[executor]: successfully prepared for execution\n";
+
+    log << "[executor]: executing the program up to the snapshot point\n";
+
+    const ReturnCode return_code = Run();
+
+    if (!storage_->SnapshotReached()) {
+        throw ExecutionError::NoSnapshotPoint(return_code);
+    }
+
+    log << "[executor]: capturing the snapshot\n";
+
+    auto snapshot = storage_->Capture();
+
+    log << "[executor]: successfully captured the snapshot\n";
+
+    return snapshot;
+}
+
+void Executor::Impl::StartImpl(const ProgramImage& image,
+                               const Config& config,
+                               std::ostream& log) {
+    log << "[executor]: preparing for execution in slices\n";
+
+    const Stopwatch stopwatch;
+
+    storage_->PrepareForExecution(image, WithoutProfile(config), log);
+
+    storage_->Stats().setup = stopwatch.Elapsed();
+    sliced_run_             = {};
+
+    log << "[executor]: successfully prepared for execution\n";
+}
+
+void Executor::Impl::StartImpl(const SnapshotImage& image,
+                               const Config& config,
+                               std::ostream& log) {
+    log << "[executor]: restoring the snapshot for execution in slices\n";
+
+    const Stopwatch stopwatch;
+
+    storage_->PrepareForExecution(image, WithoutProfile(config), log);
+
+    storage_->Stats().setup = stopwatch.Elapsed();
+    sliced_run_             = {};
+
+    log << "[executor]: successfully restored the snapshot\n";
+}
+
+Executor::MaybeReturnCode Executor::Impl::RunSliceImpl(
+    uint64_t max_instructions,
+    std::ostream& log) {
+    log << "[executor]: running a slice of at most " << max_instructions
+        << " commands\n";
+
+    storage_->StartSlice(max_instructions);
+
+    const ReturnCode return_code = RunEngine(sliced_run_);
+
+    switch (storage_->GetInterruption()) {
+        case Storage::NOT_INTERRUPTED: {
+            break;
+        }
+
+        // the threads wait for each other in the RunThreads method,
+        // so the slice itself is never stopped to let them
+        case Storage::RESCHEDULED:
+        case Storage::OUT_OF_FUEL: {
+            log << "[executor]: the slice has executed all its commands\n";
+            storage_->Output().Flush();
+            return std::nullopt;
+        }
+
+        case Storage::HALTED: {
+            log << "[executor]: the slice is stopped by the HALT command\n";
+            return std::nullopt;
+        }
+
+        case Storage::BLOCKED_ON_INPUT: {
+            log << "[executor]: the slice is waiting for the input\n";
+            return std::nullopt;
+        }
+    }
+
+    storage_->FinishStats(sliced_run_);
+
+    log << "[executor]: the program finished execution with code "
+        << return_code << '\n';
+
+    return return_code;
+}
+
+std::shared_ptr<const Executor::ProgramImage> Executor::Impl::LoadImpl(
+    const std::string& exec_path,
+    std::ostream& log) {
+    log << "[executor]: reading the executable file\n";
+
+    auto image = std::make_shared<const ProgramImage>(Exec::Read(exec_path));
+
+    log << "[executor]: successfully read the executable file\n";
+
+    return image;
+}
+
+template <typename Function>
+auto Executor::Impl::WrapErrors(Function function, std::ostream& log) {
     using std::string_literals::operator""s;
 
     try {
-        return ExecuteImpl(exec_path, config, log);
+        return function();
     } catch (const errors::executor::Error& e) {
         log << "[executor]: error: " << e.what() << '\n';
         throw;
@@ -132,6 +495,34 @@ Executor::ReturnCode Executor::Impl::MustExecute(const std::string& exec_path,
     }
 }
 
+std::shared_ptr<const Executor::ProgramImage> Executor::Impl::MustLoad(
+    const std::string& exec_path,
+    std::ostream& log) {
+    return WrapErrors([&] { return LoadImpl(exec_path, log); }, log);
+}
+
+std::shared_ptr<const Executor::ProgramImage> Executor::Impl::MustLoadCached(
+    const std::string& exec_path,
+    std::ostream& log) {
+    return WrapErrors(
+        [&] { return ProgramCache::MustGetImage(exec_path, log); },
+        log);
+}
+
+Executor::ReturnCode Executor::Impl::MustExecute(const std::string& exec_path,
+                                                 const Config& config,
+                                                 std::ostream& log) {
+    return WrapErrors(
+        [&] {
+            // the load time of a cached program is the time of checking
+            // that its file has not changed
+            const Stopwatch stopwatch;
+            const auto image = ProgramCache::MustGetImage(exec_path, log);
+            return ExecuteImpl(*image, config, log, stopwatch.Elapsed());
+        },
+        log);
+}
+
 Executor::ReturnCode Executor::Impl::Execute(const std::string& exec_path,
                                              const Config& config,
                                              std::ostream& log) {
@@ -143,4 +534,85 @@ Executor::ReturnCode Executor::Impl::Execute(const std::string& exec_path,
     }
 }
 
+Executor::ReturnCode Executor::Impl::MustExecute(const Program& program,
+                                                 const Config& config,
+                                                 std::ostream& log) {
+    return WrapErrors(
+        [&] { return ExecuteImpl(*program.image_, config, log); },
+        log);
+}
+
+Executor::ReturnCode Executor::Impl::Execute(const Program& program,
+                                             const Config& config,
+                                             std::ostream& log) {
+    try {
+        return MustExecute(program, config, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
+
+Executor::ReturnCode Executor::Impl::MustExecute(const Snapshot& snapshot,
+                                                 const Config& config,
+                                                 std::ostream& log) {
+    return WrapErrors(
+        [&] { return ExecuteImpl(*snapshot.image_, config, log); },
+        log);
+}
+
+Executor::ReturnCode Executor::Impl::Execute(const Snapshot& snapshot,
+                                             const Config& config,
+                                             std::ostream& log) {
+    try {
+        return MustExecute(snapshot, config, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
+
+Executor::Snapshot Executor::Impl::MustCapture(const Program& program,
+                                               const Config& config,
+                                               std::ostream& log) {
+    return Snapshot(WrapErrors(
+        [&] { return CaptureImpl(*program.image_, config, log); },
+        log));
+}
+
+std::optional<Executor::Snapshot> Executor::Impl::Capture(
+    const Program& program,
+    const Config& config,
+    std::ostream& log) {
+    try {
+        return MustCapture(program, config, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return std::nullopt;
+    }
+}
+
+void Executor::Impl::MustStart(const Program& program,
+                               const Config& config,
+                               std::ostream& log) {
+    WrapErrors([&] { StartImpl(*program.image_, config, log); }, log);
+}
+
+void Executor::Impl::MustStart(const Snapshot& snapshot,
+                               const Config& config,
+                               std::ostream& log) {
+    WrapErrors([&] { StartImpl(*snapshot.image_, config, log); }, log);
+}
+
+Executor::MaybeReturnCode Executor::Impl::MustRunSlice(
+    uint64_t max_instructions,
+    std::ostream& log) {
+    return WrapErrors([&] { return RunSliceImpl(max_instructions, log); },
+                      log);
+}
+
+bool Executor::Impl::BlockedOnInput() const {
+    return storage_->GetInterruption() == Storage::BLOCKED_ON_INPUT;
+}
+
 }  // namespace karma
@@ -1,38 +1,105 @@
 #pragma once
 
-#include <memory>   // for shared_ptr
-#include <ostream>  // for ostream
-#include <string>   // for string
-#include <utility>  // for move
+#include <cstdint>   // for uint64_t
+#include <memory>    // for shared_ptr
+#include <optional>  // for optional
+#include <ostream>   // for ostream
+#include <string>    // for string
+#include <utility>   // for move
 
 #include "executor/config.hpp"
 #include "executor/errors.hpp"
 #include "executor/executor.hpp"
 #include "executor/j_executor.hpp"
+#include "executor/jit_executor.hpp"
+#include "executor/native_executor.hpp"
+#include "executor/program.hpp"
+#include "executor/program_cache.hpp"
+#include "executor/program_image.hpp"
+#include "executor/snapshot.hpp"
+#include "executor/snapshot_image.hpp"
 #include "executor/ri_executor.hpp"
 #include "executor/rm_executor.hpp"
 #include "executor/rr_executor.hpp"
+#include "executor/stats.hpp"
 #include "executor/storage.hpp"
+#include "executor/table_executor.hpp"
 #include "specs/commands.hpp"
 #include "utils/traits.hpp"
 
 namespace karma {
 
 class Executor::Impl : detail::utils::traits::NonCopyableMovable {
+   private:
+    friend class Executor::ProgramCache;
+
    private:
     using InternalError  = errors::executor::InternalError::Builder;
     using ExecutionError = errors::executor::ExecutionError::Builder;
 
    private:
+    // converts all the exceptions thrown by the function
+    // into the errors of the executor block
+    template <typename Function>
+    static auto WrapErrors(Function, std::ostream& log);
+
+    static std::shared_ptr<const ProgramImage> LoadImpl(
+        const std::string& exec_path,
+        std::ostream& log);
+
     MaybeReturnCode ExecuteCmd(detail::specs::cmd::Bin);
-    ReturnCode ExecuteImpl(const std::string& exec,
+    ReturnCode RunMapped();
+
+    ReturnCode RunOn(Config::Engine);
+
+    // the same as the above, but once the program spawns a thread, runs
+    // the main thread in turns of at most Threads::kQuantum commands, between
+    // which it waits for the joined threads and stops the slice (if any)
+    // once the threads are paused, the spawned threads are stopped once
+    // the execution finishes or fails
+    ReturnCode RunThreads(Config::Engine);
+
+    // runs the prepared execution with the engine selected by its config
+    // and adds its run time to the specified one (also if it fails)
+    ReturnCode RunEngine(ExecutionStats::Time& run);
+
+    // runs the prepared execution until it finishes
+    ReturnCode Run();
+
+    // the time of loading the image is only known to the caller
+    ReturnCode ExecuteImpl(const ProgramImage&,
+                           const Config&,
+                           std::ostream& log,
+                           const ExecutionStats::Time& load = {});
+    ReturnCode ExecuteImpl(const SnapshotImage&,
                            const Config&,
                            std::ostream& log);
+    std::shared_ptr<const SnapshotImage> CaptureImpl(const ProgramImage&,
+                                                     const Config&,
+                                                     std::ostream& log);
+
+    // the executions run in the slices (see the Job class) are prepared
+    // once and then each slice is run separately
+    void StartImpl(const ProgramImage&, const Config&, std::ostream& log);
+    void StartImpl(const SnapshotImage&, const Config&, std::ostream& log);
+
+    // returns std::nullopt if the slice is stopped before
+    // the execution finishes
+    MaybeReturnCode RunSliceImpl(uint64_t max_instructions, std::ostream& log);
 
    public:
     explicit Impl(Config config)
         : storage_(std::make_shared<Storage>(std::move(config))) {}
 
+    static std::shared_ptr<const ProgramImage> MustLoad(
+        const std::string& exec_path,
+        std::ostream& log);
+
+    // the same as the above, but via the ProgramCache class
+    static std::shared_ptr<const ProgramImage> MustLoadCached(
+        const std::string& exec_path,
+        std::ostream& log);
+
     ReturnCode MustExecute(const std::string& exec_path,
                            const Config&,
                            std::ostream& log);
@@ -40,9 +107,32 @@ class Executor::Impl : detail::utils::traits::NonCopyableMovable {
                        const Config&,
                        std::ostream&);
 
+    ReturnCode MustExecute(const Program&, const Config&, std::ostream& log);
+    ReturnCode Execute(const Program&, const Config&, std::ostream&);
+
+    ReturnCode MustExecute(const Snapshot&, const Config&, std::ostream& log);
+    ReturnCode Execute(const Snapshot&, const Config&, std::ostream&);
+
+    Snapshot MustCapture(const Program&, const Config&, std::ostream& log);
+    std::optional<Snapshot> Capture(const Program&,
+                                    const Config&,
+                                    std::ostream&);
+
+    void MustStart(const Program&, const Config&, std::ostream& log);
+    void MustStart(const Snapshot&, const Config&, std::ostream& log);
+
+    MaybeReturnCode MustRunSlice(uint64_t max_instructions, std::ostream& log);
+
+    // the last slice is stopped by an input system call
+    // with no input available
+    [[nodiscard]] bool BlockedOnInput() const;
+
    private:
     std::shared_ptr<Storage> storage_;
 
+    // the total run time of the slices of the current execution
+    ExecutionStats::Time sliced_run_;
+
     // we store the maps as const to avoid accessing them via the operator[]
     // and to force ourselves to check the .contains method before calling .at
 
@@ -59,6 +149,10 @@ class Executor::Impl : detail::utils::traits::NonCopyableMovable {
     JExecutor j_{storage_};
     const JExecutor::Map j_map_ = j_.GetMap();
     // NOLINTEND(cppcoreguidelines-avoid-const-or-ref-data-members)
+
+    TableExecutor table_{storage_};
+    JitExecutor jit_{storage_};
+    NativeExecutor native_{storage_};
 };
 
 }  // namespace karma
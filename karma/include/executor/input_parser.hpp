@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cctype>        // for isspace, isdigit
+#include <charconv>      // for from_chars
+#include <cstdint>       // for int32_t
+#include <limits>        // for numeric_limits
+#include <string>        // for string, char_traits
+#include <system_error>  // for errc
+
+#include "executor/executor.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// parses the values from the characters of an input device the same way
+// as the operator>> of std::istream does for the decimal numbers,
+// the Source is to provide the following:
+//
+//     int Peek()      returns the next character or EOF
+//     void Advance()  skips the next character
+//     bool failed_    true if a previous read has failed
+class Executor::InputParser : detail::utils::traits::Static {
+   private:
+    static constexpr int kEOF = std::char_traits<char>::eof();
+
+   private:
+    template <typename Source>
+    static bool SkipWhitespace(Source& src) {
+        while (true) {
+            const int curr = src.Peek();
+            if (curr == kEOF) {
+                return false;
+            }
+
+            if (std::isspace(curr) == 0) {
+                return true;
+            }
+
+            src.Advance();
+        }
+    }
+
+    // appends the characters satisfying the predicate to the token
+    template <typename Source, typename Predicate>
+    static size_t Take(Source& src, std::string& token, Predicate predicate) {
+        size_t count = 0;
+        for (int curr = src.Peek(); curr != kEOF && predicate(curr);
+             curr = src.Peek()) {
+            token.push_back(static_cast<char>(curr));
+            src.Advance();
+            ++count;
+        }
+
+        return count;
+    }
+
+    static bool IsSign(int chr) {
+        return chr == '+' || chr == '-';
+    }
+
+    static bool IsDigit(int chr) {
+        return std::isdigit(chr) != 0;
+    }
+
+    // std::from_chars does not accept the leading plus sign
+    static const char* Begin(const std::string& token) {
+        return token.data() + (token.starts_with('+') ? 1 : 0);
+    }
+
+   public:
+    template <typename Source>
+    static int32_t ReadInt(Source& src) {
+        if (src.failed_ || !SkipWhitespace(src)) {
+            src.failed_ = true;
+            return 0;
+        }
+
+        std::string token;
+        Take(src, token, [&token](int chr) {
+            return token.empty() && IsSign(chr);
+        });
+
+        if (Take(src, token, IsDigit) == 0) {
+            src.failed_ = true;
+            return 0;
+        }
+
+        int32_t value{};
+        auto [_, err] =
+            std::from_chars(Begin(token), token.data() + token.size(), value);
+
+        // the value is clamped on overflow the same way
+        // as the operator>> of std::istream does
+        if (err == std::errc::result_out_of_range) {
+            src.failed_ = true;
+            return token.starts_with('-')
+                       ? std::numeric_limits<int32_t>::min()
+                       : std::numeric_limits<int32_t>::max();
+        }
+
+        return value;
+    }
+
+    template <typename Source>
+    static double ReadDouble(Source& src) {
+        if (src.failed_ || !SkipWhitespace(src)) {
+            src.failed_ = true;
+            return 0;
+        }
+
+        std::string token;
+        Take(src, token, [&token](int chr) {
+            return token.empty() && IsSign(chr);
+        });
+
+        size_t n_digits = Take(src, token, IsDigit);
+
+        if (src.Peek() == '.') {
+            token.push_back('.');
+            src.Advance();
+            n_digits += Take(src, token, IsDigit);
+        }
+
+        if (n_digits == 0) {
+            src.failed_ = true;
+            return 0;
+        }
+
+        if (src.Peek() == 'e' || src.Peek() == 'E') {
+            token.push_back('e');
+            src.Advance();
+
+            Take(src, token, [&token](int chr) {
+                return token.back() == 'e' && IsSign(chr);
+            });
+
+            if (Take(src, token, IsDigit) == 0) {
+                src.failed_ = true;
+                return 0;
+            }
+        }
+
+        double value{};
+        auto [_, err] =
+            std::from_chars(Begin(token), token.data() + token.size(), value);
+
+        if (err == std::errc::result_out_of_range) {
+            src.failed_ = true;
+
+            if (token.find("e-") != std::string::npos) {
+                return 0;
+            }
+
+            return token.starts_with('-')
+                       ? std::numeric_limits<double>::lowest()
+                       : std::numeric_limits<double>::max();
+        }
+
+        return value;
+    }
+
+    template <typename Source>
+    static unsigned char ReadChar(Source& src) {
+        if (src.failed_ || !SkipWhitespace(src)) {
+            src.failed_ = true;
+            return 0;
+        }
+
+        const int curr = src.Peek();
+        src.Advance();
+
+        return static_cast<unsigned char>(curr);
+    }
+};
+
+}  // namespace karma
@@ -0,0 +1,1501 @@
+#include "intrinsics.hpp"
+
+#include <algorithm>      // for any_of, find
+#include <array>          // for array
+#include <bit>            // for bit_cast
+#include <charconv>       // for to_chars
+#include <climits>        // for CHAR_BIT
+#include <cmath>          // for floor, isfinite
+#include <concepts>       // for unsigned_integral
+#include <cstddef>        // for size_t
+#include <cstdint>        // for uint16_t, uint64_t, UINT8_MAX
+#include <functional>     // for function
+#include <limits>         // for numeric_limits
+#include <optional>       // for optional, nullopt
+#include <span>           // for span
+#include <string>         // for string
+#include <string_view>    // for string_view
+#include <unordered_map>  // for unordered_map
+#include <utility>        // for pair, move
+#include <vector>         // for vector
+
+#include "exec/exec.hpp"
+#include "exec/symbols.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "utils/types.hpp"
+
+namespace karma {
+
+namespace utils   = detail::utils;
+namespace arch    = detail::specs::arch;
+namespace cmd     = detail::specs::cmd;
+namespace syscall = detail::specs::cmd::syscall;
+
+namespace {
+
+using Reader = std::function<std::optional<arch::Word>(arch::Address)>;
+
+// the arguments are read relative to the call frame register the same way
+// the routines do it (e.g. loadr r0 r14 3), the word at frame + 1 is the call
+// frame register of the caller, i.e. the address of the last argument
+constexpr arch::Address kFirstArgument = 3;
+constexpr arch::Address kLastArgument  = 1;
+
+// see the __check_base routine
+constexpr arch::Word kMinBase = 2;
+constexpr arch::Word kMaxBase = 36;
+
+constexpr arch::Word kDecimalBase = 10;
+constexpr arch::Word kBinaryBase  = 2;
+constexpr arch::Word kOctalBase   = 8;
+constexpr arch::Word kHexBase     = 16;
+
+constexpr arch::Word kDefaultPrecision = 6;
+
+// the fractional digits of a double value are printed one by one,
+// so the larger precisions are left to the interpreted routine
+// to keep the text formatted at once bounded, and so is the longer text
+// produced by a single printf call
+constexpr arch::Word kMaxPrecision = 1 << 12;
+constexpr size_t kMaxTextSize      = 1 << 20;
+
+bool IsValidBase(arch::Word base) {
+    return base >= kMinBase && base <= kMaxBase;
+}
+
+// the characters are printed via the PUTCHAR system call,
+// which fails for the values out of the char range
+bool PutChar(arch::Word chr, std::string& text) {
+    if (chr > syscall::kMaxChar) {
+        return false;
+    }
+
+    text += static_cast<char>(chr);
+    return true;
+}
+
+// the same as the __print_digit_unsafe routine, which does not check
+// the digit against the base
+bool PutDigit(arch::Word digit, std::string& text) {
+    if (digit >= kDecimalBase) {
+        return PutChar('a' + (digit - kDecimalBase), text);
+    }
+
+    return PutChar('0' + digit, text);
+}
+
+// std::to_chars uses the same digits as the __print_digit_unsafe routine
+// does, i.e. the lowercase latin letters for the digits from 10
+template <std::unsigned_integral T>
+void PutUnsigned(T value, arch::Word base, std::string& text) {
+    // enough for the binary digits of any 64-bit integer
+    std::array<char, 64> chars{};
+
+    auto [end, _] = std::to_chars(
+        chars.begin(), chars.end(), value, static_cast<int>(base));
+    text.append(chars.begin(), end);
+}
+
+// the negative values are printed as the minus sign
+// followed by their modulus as the unsigned ones
+template <std::unsigned_integral T>
+void PutSigned(T value, arch::Word base, std::string& text) {
+    constexpr T kSignBit = T{1} << (sizeof(T) * utils::types::kByteSize - 1);
+
+    if ((value & kSignBit) != 0) {
+        text += '-';
+        value = ~(value - 1);
+    }
+
+    PutUnsigned(value, base, text);
+}
+
+bool PutString(const Reader& read, arch::Address address, std::string& text) {
+    for (;; ++address) {
+        const std::optional<arch::Word> chr = read(address);
+        if (!chr || text.size() > kMaxTextSize) {
+            return false;
+        }
+
+        if (*chr == 0) {
+            return true;
+        }
+
+        if (!PutChar(*chr, text)) {
+            return false;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                  Double                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+// the double values are printed by repeating the floating point operations
+// of the interpreted routines exactly, since they do not round the digits
+// the way std::to_chars does
+
+// the same as the DTOI command, which fails if the value does not fit
+// the word, std::nullopt for the negative values as well,
+// which the interpreted routines never expect
+std::optional<arch::Word> DoubleToWord(arch::Double value) {
+    if (!(value >= 0) || value >= static_cast<arch::Double>(arch::kMaxWord)) {
+        return std::nullopt;
+    }
+
+    return static_cast<arch::Word>(std::floor(value));
+}
+
+// the same as the __double_modulus_integral_fractional_part routine,
+// which clears the fractional bits of the mantissa of the value's modulus
+std::pair<arch::Double, arch::Double> SplitModulus(arch::Double value) {
+    constexpr uint64_t kSignBit      = uint64_t{1} << 63;
+    constexpr uint64_t kMantissaBits = 52;
+    constexpr uint64_t kBias         = 1023;
+
+    const auto bits     = std::bit_cast<uint64_t>(value) & ~kSignBit;
+    const auto modulus  = std::bit_cast<arch::Double>(bits);
+    const auto exponent = bits >> kMantissaBits;
+
+    if (exponent < kBias) {
+        return {0, modulus};
+    }
+
+    if (exponent >= kBias + kMantissaBits) {
+        return {modulus, 0};
+    }
+
+    const uint64_t fractional_bits = kBias + kMantissaBits - exponent;
+    const auto integral =
+        std::bit_cast<arch::Double>(bits & (~uint64_t{0} << fractional_bits));
+
+    return {integral, modulus - integral};
+}
+
+// the same as the __print_double_integral_part routine, which prints
+// the digits after returning from the recursion, so they are collected
+// from the lowest one here
+bool PutIntegralPart(arch::Double value, arch::Word base, std::string& text) {
+    const auto base_double = static_cast<arch::Double>(base);
+
+    // the value is finite, so the quotients decrease down to the base
+    std::vector<arch::Word> digits;
+    while (!(base_double > value)) {
+        const arch::Double quotient  = SplitModulus(value / base_double).first;
+        const arch::Double remainder = value - base_double * quotient;
+
+        const std::optional<arch::Word> digit = DoubleToWord(remainder);
+        if (!digit) {
+            return false;
+        }
+
+        digits.push_back(*digit);
+        value = quotient;
+    }
+
+    const std::optional<arch::Word> digit = DoubleToWord(value);
+    if (!digit) {
+        return false;
+    }
+
+    digits.push_back(*digit);
+
+    for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+        if (!PutDigit(*it, text)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the same as the __print_double_fractional_part routine, which stops once
+// the rest of the digits are zeros
+bool PutFractionalPart(arch::Double value,
+                       arch::Word base,
+                       arch::Word precision,
+                       std::string& text) {
+    const auto base_double = static_cast<arch::Double>(base);
+
+    arch::Double early_stop = 1;
+    for (arch::Word i = 0; i < precision; ++i) {
+        early_stop /= base_double;
+    }
+
+    if (value < early_stop) {
+        return true;
+    }
+
+    text += '.';
+
+    for (arch::Word remaining = precision; remaining > 0; --remaining) {
+        value *= base_double;
+
+        const std::optional<arch::Word> digit = DoubleToWord(value);
+        if (!digit || !PutDigit(*digit, text)) {
+            return false;
+        }
+
+        value -= static_cast<arch::Double>(*digit);
+        early_stop *= base_double;
+
+        if (value < early_stop) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+// the same as the __print_double_unsafe routine, the infinite values
+// and the NaNs make it recurse until the stack is over,
+// so they are left to it
+bool PutDouble(arch::Word base,
+               arch::TwoWords bits,
+               arch::Word precision,
+               std::string& text) {
+    const auto value = std::bit_cast<arch::Double>(bits);
+    if (!std::isfinite(value) || precision > kMaxPrecision) {
+        return false;
+    }
+
+    if (value < 0) {
+        text += '-';
+    }
+
+    const auto [integral, fractional] = SplitModulus(value);
+
+    return PutIntegralPart(integral, base, text) &&
+           PutFractionalPart(fractional, base, precision, text);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                  Printf                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+std::optional<arch::Word> SignedPlaceholderBase(arch::Word placeholder) {
+    switch (placeholder) {
+        case 'd':
+        case 'i': {
+            return kDecimalBase;
+        }
+
+        case 'm': {
+            return kBinaryBase;
+        }
+
+        case 'k': {
+            return kOctalBase;
+        }
+
+        case 'h': {
+            return kHexBase;
+        }
+
+        default: {
+            return std::nullopt;
+        }
+    }
+}
+
+std::optional<arch::Word> UnsignedPlaceholderBase(arch::Word placeholder) {
+    switch (placeholder) {
+        case 'u': {
+            return kDecimalBase;
+        }
+
+        case 'b': {
+            return kBinaryBase;
+        }
+
+        case 'o': {
+            return kOctalBase;
+        }
+
+        case 'x': {
+            return kHexBase;
+        }
+
+        default: {
+            return std::nullopt;
+        }
+    }
+}
+
+std::optional<arch::Word> DoublePlaceholderBase(arch::Word placeholder) {
+    switch (placeholder) {
+        case 'f': {
+            return kDecimalBase;
+        }
+
+        case 'e': {
+            return kBinaryBase;
+        }
+
+        case 'g': {
+            return kOctalBase;
+        }
+
+        case 'a': {
+            return kHexBase;
+        }
+
+        default: {
+            return std::nullopt;
+        }
+    }
+}
+
+// the same as the printf routine, all of its errors
+// (including the missing arguments) are left to it
+bool Printf(const Reader& read, arch::Address frame, std::string& text) {
+    const std::optional<arch::Word> last_argument = read(frame + kLastArgument);
+    if (!last_argument) {
+        return false;
+    }
+
+    arch::Address curr_argument = frame + kFirstArgument;
+    const auto next_argument    = [&]() -> std::optional<arch::Word> {
+        if (curr_argument > *last_argument) {
+            return std::nullopt;
+        }
+
+        return read(curr_argument++);
+    };
+
+    const std::optional<arch::Word> format = next_argument();
+    if (!format) {
+        return false;
+    }
+
+    for (arch::Address curr = *format; text.size() <= kMaxTextSize;) {
+        std::optional<arch::Word> chr = read(curr++);
+        if (!chr) {
+            return false;
+        }
+
+        if (*chr == 0) {
+            return true;
+        }
+
+        if (*chr != '%') {
+            if (!PutChar(*chr, text)) {
+                return false;
+            }
+
+            continue;
+        }
+
+        chr = read(curr++);
+        if (!chr || *chr == 0) {
+            return false;
+        }
+
+        if (*chr == '%') {
+            text += '%';
+            continue;
+        }
+
+        // the one-word arguments
+        if (*chr != 'l') {
+            const std::optional<arch::Word> argument = next_argument();
+            if (!argument) {
+                return false;
+            }
+
+            if (*chr == 'c') {
+                if (!PutChar(*argument, text)) {
+                    return false;
+                }
+            } else if (*chr == 's') {
+                if (!PutString(read, *argument, text)) {
+                    return false;
+                }
+            } else if (auto base = SignedPlaceholderBase(*chr)) {
+                PutSigned(*argument, *base, text);
+            } else if (auto base = UnsignedPlaceholderBase(*chr)) {
+                PutUnsigned(*argument, *base, text);
+            } else {
+                return false;
+            }
+
+            continue;
+        }
+
+        // the two-word arguments
+        chr = read(curr++);
+        if (!chr || *chr == 0) {
+            return false;
+        }
+
+        const std::optional<arch::Word> low  = next_argument();
+        const std::optional<arch::Word> high = low ? next_argument() : low;
+        if (!high) {
+            return false;
+        }
+
+        const arch::TwoWords argument = utils::types::Join(*low, *high);
+
+        if (auto base = SignedPlaceholderBase(*chr)) {
+            PutSigned(argument, *base, text);
+        } else if (auto base = UnsignedPlaceholderBase(*chr)) {
+            PutUnsigned(argument, *base, text);
+        } else if (auto base = DoublePlaceholderBase(*chr)) {
+            if (!PutDouble(*base, argument, kDefaultPrecision, text)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+// the analysis of the code below decides whether the caller of a routine
+// may observe the registers and the flags the interpreted routine leaves
+// behind, which the native one does not change
+
+// the same as Executor::Intrinsics::Mask
+using Mask = uint16_t;
+
+// a decoded command (the same as the one of the DecodeCache class)
+struct Instruction {
+    cmd::Code code;
+    cmd::args::Register recv;
+    cmd::args::Source src;
+    arch::Word operand;
+};
+
+constexpr auto kFlags = static_cast<Mask>(1U << arch::kCallFrameRegister);
+constexpr auto kEverything = static_cast<Mask>((kFlags << 1U) - 1U);
+
+// the call frame, the stack and the instruction registers are restored
+// by the return itself, so only the general purpose ones are tracked
+Mask Bit(arch::Register reg) {
+    return reg < arch::kCallFrameRegister ? static_cast<Mask>(1U << reg)
+                                          : Mask{0};
+}
+
+Mask Pair(arch::Register reg) {
+    return Bit(reg) | Bit(reg + 1);
+}
+
+// how the control is transferred after a command
+enum Flow : uint8_t {
+    // to the following command
+    FALLTHROUGH,
+
+    // to the target
+    JUMP,
+
+    // to the target or to the following command
+    BRANCH,
+
+    // to the called routine and then to the following command
+    CALL_ROUTINE,
+
+    // to the return address of the routine
+    RETURN,
+
+    // nowhere, the execution exits
+    STOP,
+
+    // nowhere the analysis follows (e.g. the halt command or an unknown
+    // command), so all the registers and the flags are considered read
+    OPAQUE,
+
+    // the same as the above, but the control may be transferred anywhere
+    // (e.g. via the call command or a write to the instruction register),
+    // so no return command is known to return to the callers of its routine
+    INDIRECT,
+};
+
+struct Step {
+    Flow flow{OPAQUE};
+    arch::Address target{0};
+
+    // the registers and the flags the command reads,
+    // may write and surely writes respectively
+    Mask uses{kEverything};
+    Mask writes{kEverything};
+    Mask kills{0};
+};
+
+// the commands reading the register following the receiver one as well
+bool ReadsReceiverPair(cmd::Code code) {
+    switch (code) {
+        case cmd::DIV:
+        case cmd::DIVI:
+        case cmd::ADDD:
+        case cmd::SUBD:
+        case cmd::MULD:
+        case cmd::DIVD:
+        case cmd::CMPD:
+        case cmd::STORE2:
+        case cmd::STORER2:
+        case cmd::CAS:
+        case cmd::MCOPY:
+        case cmd::MFILL:
+        case cmd::MCMP:
+        case cmd::MFIND: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+// the commands reading the register following the source one as well,
+// i.e. the ones with a real-valued source operand
+bool ReadsSourcePair(cmd::Code code) {
+    switch (code) {
+        case cmd::ADDD:
+        case cmd::SUBD:
+        case cmd::MULD:
+        case cmd::DIVD:
+        case cmd::CMPD: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+// the number of the registers written starting from the receiver one
+arch::Register WrittenRegisters(cmd::Code code) {
+    switch (code) {
+        case cmd::CMP:
+        case cmd::CMPI:
+        case cmd::CMPD:
+        case cmd::MCMP:
+        case cmd::PUSH:
+        case cmd::STORE:
+        case cmd::STORE2:
+        case cmd::STORER:
+        case cmd::STORER2:
+        case cmd::MCOPY:
+        case cmd::MFILL: {
+            return 0;
+        }
+
+        case cmd::MUL:
+        case cmd::MULI:
+        case cmd::DIV:
+        case cmd::DIVI:
+        case cmd::ITOD:
+        case cmd::ADDD:
+        case cmd::SUBD:
+        case cmd::MULD:
+        case cmd::DIVD:
+        case cmd::LOAD2:
+        case cmd::LOADR2: {
+            return 2;
+        }
+
+        default: {
+            return 1;
+        }
+    }
+}
+
+Step AnalyzeSyscall(const Instruction& instr) {
+    Step step;
+
+    switch (static_cast<syscall::Code>(instr.operand)) {
+        case syscall::EXIT: {
+            step.flow   = STOP;
+            step.uses   = Bit(instr.recv);
+            step.writes = 0;
+            break;
+        }
+
+        case syscall::SCANINT:
+        case syscall::GETCHAR: {
+            step.flow   = FALLTHROUGH;
+            step.uses   = 0;
+            step.writes = Bit(instr.recv);
+            break;
+        }
+
+        case syscall::SCANDOUBLE: {
+            step.flow   = FALLTHROUGH;
+            step.uses   = 0;
+            step.writes = Pair(instr.recv);
+            break;
+        }
+
+        case syscall::PRINTINT:
+        case syscall::PUTCHAR: {
+            step.flow   = FALLTHROUGH;
+            step.uses   = Bit(instr.recv);
+            step.writes = 0;
+            break;
+        }
+
+        case syscall::PRINTDOUBLE: {
+            step.flow   = FALLTHROUGH;
+            step.uses   = Pair(instr.recv);
+            step.writes = 0;
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+
+    // the input system calls either write the registers or fail,
+    // and a write to the instruction register is an indirect jump
+    const bool writes_instruction_register =
+        instr.recv + (instr.operand == syscall::SCANDOUBLE ? 1U : 0U) >=
+        arch::kInstructionRegister;
+    if (step.writes != 0 && writes_instruction_register) {
+        return {.flow = INDIRECT};
+    }
+
+    step.kills = step.writes;
+    return step;
+}
+
+Step AnalyzeData(const Instruction& instr) {
+    Step step{.flow = FALLTHROUGH};
+
+    switch (instr.code) {
+        case cmd::LC:
+        case cmd::LA:
+        case cmd::LOAD:
+        case cmd::LOAD2:
+        case cmd::POP: {
+            step.uses = 0;
+            break;
+        }
+
+        case cmd::MOV:
+        case cmd::ITOD:
+        case cmd::LOADR:
+        case cmd::LOADR2: {
+            step.uses = Bit(instr.src);
+            break;
+        }
+
+        case cmd::DTOI: {
+            step.uses = Pair(instr.src);
+            break;
+        }
+
+        default: {
+            const bool rr = cmd::kCodeToFormat.at(instr.code) == cmd::RR;
+
+            step.uses = Bit(instr.recv) | (rr ? Bit(instr.src) : Mask{0});
+            if (ReadsReceiverPair(instr.code)) {
+                step.uses |= Bit(instr.recv + 1);
+            }
+            if (ReadsSourcePair(instr.code)) {
+                step.uses |= Bit(instr.src + 1);
+            }
+            break;
+        }
+    }
+
+    // a write to the instruction register is an indirect jump
+    const arch::Register written = WrittenRegisters(instr.code);
+    if (written != 0 && instr.recv + written > arch::kInstructionRegister) {
+        return {.flow = INDIRECT};
+    }
+
+    step.writes = written == 2 ? Pair(instr.recv)
+                : written == 1 ? Bit(instr.recv)
+                               : Mask{0};
+    step.kills  = step.writes;
+
+    switch (instr.code) {
+        case cmd::CMP:
+        case cmd::CMPI:
+        case cmd::CMPD: {
+            step.writes |= kFlags;
+            step.kills |= kFlags;
+            break;
+        }
+
+        case cmd::MCMP:
+        case cmd::CAS: {
+            step.writes |= kFlags;
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+
+    return step;
+}
+
+Step Analyze(const Instruction& instr, arch::Address address, size_t size) {
+    if (!cmd::kCodeToFormat.contains(instr.code)) {
+        return {};
+    }
+
+    Step step;
+    switch (instr.code) {
+        case cmd::HALT: {
+            return step;
+        }
+
+        case cmd::SYSCALL: {
+            step = AnalyzeSyscall(instr);
+            break;
+        }
+
+        case cmd::JMP: {
+            step = {.flow   = JUMP,
+                    .target = instr.operand,
+                    .uses   = 0,
+                    .writes = 0};
+            break;
+        }
+
+        case cmd::JNE:
+        case cmd::JEQ:
+        case cmd::JLE:
+        case cmd::JL:
+        case cmd::JGE:
+        case cmd::JG: {
+            step = {.flow   = BRANCH,
+                    .target = instr.operand,
+                    .uses   = kFlags,
+                    .writes = 0};
+            break;
+        }
+
+        case cmd::PRC: {
+            step = {.flow = FALLTHROUGH, .uses = 0, .writes = 0};
+            break;
+        }
+
+        case cmd::CALLI: {
+            step = {.flow   = CALL_ROUTINE,
+                    .target = instr.operand,
+                    .uses   = 0,
+                    .writes = 0};
+            break;
+        }
+
+        case cmd::RET: {
+            step = {.flow = RETURN, .uses = 0, .writes = 0};
+            break;
+        }
+
+        case cmd::CALL: {
+            return {.flow = INDIRECT};
+        }
+
+        default: {
+            step = AnalyzeData(instr);
+            break;
+        }
+    }
+
+    // the execution leaving the code segment continues
+    // in the data the analysis does not follow
+    const bool falls_through = step.flow == FALLTHROUGH ||
+                               step.flow == BRANCH ||
+                               step.flow == CALL_ROUTINE;
+    const bool jumps = step.flow == JUMP || step.flow == BRANCH ||
+                       step.flow == CALL_ROUTINE;
+    if ((falls_through && address + size_t{1} >= size) ||
+        (jumps && step.target >= size)) {
+        return {.flow = INDIRECT};
+    }
+
+    return step;
+}
+
+std::vector<Step> Analyze(const std::vector<Instruction>& code) {
+    std::vector<Step> steps;
+    steps.reserve(code.size());
+
+    for (size_t address = 0; address < code.size(); ++address) {
+        steps.push_back(Analyze(
+            code[address], static_cast<arch::Address>(address), code.size()));
+    }
+
+    return steps;
+}
+
+// the registers and the flags which may be read after the command
+// before being written, computed by the usual backward dataflow analysis
+// via the sweeps over the code until nothing changes, which takes a few
+// of them for the usual loops and calls
+//
+// the calls are either followed into the routine, with nothing read after
+// its return (the first pass, which finds the registers a routine reads
+// before writing them), or replaced with the registers the routine reads
+// (the second pass), in which case the return commands read everything
+// read after the returns of the routines they belong to
+template <typename AtCall, typename AtReturn>
+std::vector<Mask> Solve(const std::vector<Step>& steps,
+                        const AtCall& at_call,
+                        const AtReturn& at_return) {
+    std::vector<Mask> live(steps.size(), 0);
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        for (size_t address = steps.size(); address-- > 0;) {
+            const Step& step = steps[address];
+
+            Mask out = 0;
+            switch (step.flow) {
+                case FALLTHROUGH: {
+                    out = live[address + 1];
+                    break;
+                }
+
+                case JUMP: {
+                    out = live[step.target];
+                    break;
+                }
+
+                case BRANCH: {
+                    out = live[address + 1] | live[step.target];
+                    break;
+                }
+
+                case CALL_ROUTINE: {
+                    out = at_call(live, address, step.target);
+                    break;
+                }
+
+                case RETURN: {
+                    out = at_return(live, address);
+                    break;
+                }
+
+                case STOP: {
+                    break;
+                }
+
+                case OPAQUE:
+                case INDIRECT: {
+                    out = kEverything;
+                    break;
+                }
+            }
+
+            const auto in = static_cast<Mask>(step.uses | (out & ~step.kills));
+            if (in != live[address]) {
+                live[address] = in;
+                changed        = true;
+            }
+        }
+    }
+
+    return live;
+}
+
+// the return commands reachable from the first command of each routine
+// (i.e. each target of a calli command) without returning, so that
+// the return command reads whatever the callers of its routines read
+class Routines {
+   public:
+    Routines(const std::vector<Step>& steps, arch::Address entrypoint) {
+        // the control transferred anywhere may reach any return command
+        // with any return address on the stack
+        if (std::ranges::any_of(steps, [](const Step& step) {
+                return step.flow == INDIRECT;
+            })) {
+            return;
+        }
+
+        std::vector<size_t> visited(steps.size(), kNotVisited);
+        for (size_t address = 0; address < steps.size(); ++address) {
+            const Step& step = steps[address];
+            if (step.flow != CALL_ROUTINE) {
+                continue;
+            }
+
+            const auto [it, inserted] =
+                indices_.emplace(step.target, returns_.size());
+            if (inserted) {
+                returns_.emplace_back();
+                Collect(steps, step.target, it->second, visited);
+            }
+
+            returns_[it->second].push_back(
+                static_cast<arch::Address>(address + 1));
+        }
+
+        // the return commands of the code entered at the entrypoint
+        // return to whatever the stack holds at the start
+        if (entrypoint < steps.size()) {
+            Collect(steps, entrypoint, kNowhere, visited);
+        }
+
+        precise_ = true;
+    }
+
+    // the registers and the flags read after the return command
+    [[nodiscard]] Mask AfterReturn(const std::vector<Mask>& live,
+                                   size_t address) const {
+        const auto it = owners_.find(address);
+        if (!precise_ || it == owners_.end()) {
+            return kEverything;
+        }
+
+        Mask out = 0;
+        for (const size_t routine : it->second) {
+            if (routine == kNowhere) {
+                return kEverything;
+            }
+
+            for (const arch::Address ret : returns_[routine]) {
+                out |= live[ret];
+            }
+        }
+
+        return out;
+    }
+
+   private:
+    static constexpr size_t kNotVisited = std::numeric_limits<size_t>::max();
+    static constexpr size_t kNowhere    = kNotVisited - 1;
+
+    void Collect(const std::vector<Step>& steps,
+                 arch::Address entry,
+                 size_t routine,
+                 std::vector<size_t>& visited) {
+        std::vector<arch::Address> pending{entry};
+
+        while (!pending.empty()) {
+            const arch::Address address = pending.back();
+            pending.pop_back();
+
+            if (visited[address] == routine) {
+                continue;
+            }
+            visited[address] = routine;
+
+            const Step& step = steps[address];
+            switch (step.flow) {
+                case FALLTHROUGH:
+                case CALL_ROUTINE: {
+                    pending.push_back(address + 1);
+                    break;
+                }
+
+                case JUMP: {
+                    pending.push_back(step.target);
+                    break;
+                }
+
+                case BRANCH: {
+                    pending.push_back(address + 1);
+                    pending.push_back(step.target);
+                    break;
+                }
+
+                case RETURN: {
+                    owners_[address].push_back(routine);
+                    break;
+                }
+
+                case STOP:
+                case OPAQUE:
+                case INDIRECT: {
+                    break;
+                }
+            }
+        }
+    }
+
+   private:
+    bool precise_{false};
+
+    std::unordered_map<arch::Address, size_t> indices_;
+
+    // the return addresses of the calls of each routine
+    std::vector<std::vector<arch::Address>> returns_;
+
+    // the routines each return command belongs to
+    std::unordered_map<size_t, std::vector<size_t>> owners_;
+};
+
+// the commands of a routine, i.e. the ones reachable from its first command,
+// and the constants they read, with the targets of the jumps and the calls
+// numbered in the order of the depth-first traversal, so that the fingerprint
+// does not depend on where the routine is placed in the code
+struct Fingerprint {
+    uint64_t hash{kFnvOffsetBasis};
+    Mask clobbered{0};
+    std::vector<std::pair<arch::Address, arch::Word>> constants;
+
+    static constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+    static constexpr uint64_t kFnvPrime       = 1099511628211ULL;
+
+    void Mix(uint64_t value) {
+        for (size_t byte = 0; byte < sizeof(value); ++byte) {
+            hash ^= (value >> (byte * CHAR_BIT)) & UINT8_MAX;
+            hash *= kFnvPrime;
+        }
+    }
+};
+
+Fingerprint TakeFingerprint(const std::vector<Instruction>& code,
+                            const std::vector<Step>& steps,
+                            std::span<const arch::Word> constants,
+                            arch::Address entry) {
+    std::unordered_map<arch::Address, uint64_t> order;
+    std::vector<arch::Address> visited;
+    std::vector<arch::Address> pending{entry};
+
+    while (!pending.empty()) {
+        const arch::Address address = pending.back();
+        pending.pop_back();
+
+        if (!order.emplace(address, visited.size()).second) {
+            continue;
+        }
+        visited.push_back(address);
+
+        // the following command is visited first
+        const Step& step = steps[address];
+        switch (step.flow) {
+            case FALLTHROUGH: {
+                pending.push_back(address + 1);
+                break;
+            }
+
+            case JUMP: {
+                pending.push_back(step.target);
+                break;
+            }
+
+            case BRANCH:
+            case CALL_ROUTINE: {
+                pending.push_back(step.target);
+                pending.push_back(address + 1);
+                break;
+            }
+
+            case RETURN:
+            case STOP:
+            case OPAQUE:
+            case INDIRECT: {
+                break;
+            }
+        }
+    }
+
+    const auto constant = [&](arch::Address address)
+        -> std::optional<arch::Word> {
+        if (address < code.size() ||
+            address - code.size() >= constants.size()) {
+            return std::nullopt;
+        }
+
+        return constants[address - code.size()];
+    };
+
+    Fingerprint fingerprint;
+    for (const arch::Address address : visited) {
+        const Instruction& instr = code[address];
+        const Step& step         = steps[address];
+
+        fingerprint.Mix(instr.code);
+        fingerprint.Mix(instr.recv);
+        fingerprint.Mix(instr.src);
+        fingerprint.clobbered |= step.writes;
+
+        if (step.flow == JUMP || step.flow == BRANCH ||
+            step.flow == CALL_ROUTINE) {
+            fingerprint.Mix(order.at(step.target));
+            continue;
+        }
+
+        const bool reads_constant = instr.code == cmd::LA ||
+                                    instr.code == cmd::LOAD ||
+                                    instr.code == cmd::LOAD2;
+        const std::optional<arch::Word> value = constant(instr.operand);
+        if (!reads_constant || !value) {
+            fingerprint.Mix(instr.operand);
+            continue;
+        }
+
+        fingerprint.Mix(*value);
+
+        // the address of a string is only used for the error messages,
+        // which the interpreted routine prints, while the loaded constants
+        // must stay intact for the native routine to produce the same output
+        if (instr.code == cmd::LA) {
+            continue;
+        }
+
+        fingerprint.constants.emplace_back(instr.operand, *value);
+        if (instr.code == cmd::LOAD2) {
+            const std::optional<arch::Word> high = constant(instr.operand + 1);
+            fingerprint.Mix(high.value_or(0));
+            fingerprint.constants.emplace_back(instr.operand + 1,
+                                               high.value_or(0));
+        }
+    }
+
+    return fingerprint;
+}
+
+}  // namespace
+
+Executor::Intrinsics::Intrinsics(const Exec::Symbols& symbols,
+                                 std::span<const Word> code,
+                                 std::span<const Word> constants,
+                                 Address entrypoint) {
+    struct KnownRoutine {
+        std::string_view label;
+        uint64_t fingerprint;
+        Routine routine;
+    };
+
+    // the fingerprints of the routines of the library as it is
+    // (see the TakeFingerprint function), which are to be updated
+    // along with the library
+    static constexpr std::array kKnownRoutines = {
+        KnownRoutine{
+            "print_newline",
+            0xda4f650171a1ba78ULL,
+            PRINT_NEWLINE,
+        },
+        KnownRoutine{
+            "print_char",
+            0x8954974722d3a4dbULL,
+            PRINT_CHAR,
+        },
+        KnownRoutine{
+            "print_string",
+            0xbbcaec988b219e92ULL,
+            PRINT_STRING,
+        },
+        KnownRoutine{
+            "print_uint32",
+            0x5e309191e3ee85d9ULL,
+            PRINT_UINT32,
+        },
+        KnownRoutine{
+            "print_uint32_decimal",
+            0x5a38a976e4519ee5ULL,
+            PRINT_UINT32_DECIMAL,
+        },
+        KnownRoutine{
+            "print_int32",
+            0x55e207566bd603a3ULL,
+            PRINT_INT32,
+        },
+        KnownRoutine{
+            "print_int32_decimal",
+            0x49b2d45e68a131a7ULL,
+            PRINT_INT32_DECIMAL,
+        },
+        KnownRoutine{
+            "print_uint64",
+            0xb76e52314e37c9ddULL,
+            PRINT_UINT64,
+        },
+        KnownRoutine{
+            "print_uint64_decimal",
+            0xa8e2ccf73595d3c5ULL,
+            PRINT_UINT64_DECIMAL,
+        },
+        KnownRoutine{
+            "print_int64",
+            0xaa5b16c01ce0f854ULL,
+            PRINT_INT64,
+        },
+        KnownRoutine{
+            "print_int64_decimal",
+            0x5a79d419c1b58f1cULL,
+            PRINT_INT64_DECIMAL,
+        },
+        KnownRoutine{
+            "print_double",
+            0xdbd5ffa8d3ba9889ULL,
+            PRINT_DOUBLE,
+        },
+        KnownRoutine{
+            "print_double_decimal",
+            0xd541a962b38dfc63ULL,
+            PRINT_DOUBLE_DECIMAL,
+        },
+        KnownRoutine{
+            "print_double_default_precision",
+            0x539d2fc103d627e7ULL,
+            PRINT_DOUBLE_DEFAULT_PRECISION,
+        },
+        KnownRoutine{
+            "print_double_decimal_default_precision",
+            0xba2dd1eb04ce5017ULL,
+            PRINT_DOUBLE_DECIMAL_DEFAULT_PRECISION,
+        },
+        KnownRoutine{
+            "printf",
+            0x58f9e7f8be8a605eULL,
+            PRINTF,
+        },
+    };
+
+    // the labels are looked up first, so that the code of the programs
+    // not using the library is not analyzed at all
+    std::vector<std::pair<Address, const KnownRoutine*>> candidates;
+    for (const Exec::Symbols::Label& label : symbols.labels) {
+        const auto known = std::ranges::find(
+            kKnownRoutines, label.name, &KnownRoutine::label);
+        if (known != kKnownRoutines.end() && label.address < code.size()) {
+            candidates.emplace_back(label.address, known);
+        }
+    }
+
+    if (candidates.empty()) {
+        return;
+    }
+
+    std::vector<Instruction> decoded;
+    decoded.reserve(code.size());
+    for (const Word command : code) {
+        const cmd::args::AnyArgs args = cmd::parse::Any(command);
+
+        decoded.push_back({
+            .code    = cmd::GetCode(command),
+            .recv    = args.recv,
+            .src     = args.src,
+            .operand = args.operand,
+        });
+    }
+
+    const std::vector<Step> steps = Analyze(decoded);
+
+    // a program may define its own routine with the same label,
+    // so the code of the routine is checked as well
+    for (const auto& [address, known] : candidates) {
+        Fingerprint fingerprint =
+            TakeFingerprint(decoded, steps, constants, address);
+        if (fingerprint.hash == known->fingerprint) {
+            routines_.emplace(address,
+                              Entry{
+                                  .routine   = known->routine,
+                                  .clobbered = fingerprint.clobbered,
+                                  .constants = std::move(fingerprint.constants),
+                              });
+        }
+    }
+
+    if (routines_.empty()) {
+        return;
+    }
+
+    const std::vector<Mask> exposed = Solve(
+        steps,
+        [](const std::vector<Mask>& live, size_t address, Address target) {
+            return static_cast<Mask>(live[address + 1] | live[target]);
+        },
+        [](const std::vector<Mask>&, size_t) { return Mask{0}; });
+
+    const Routines routines(steps, entrypoint);
+    const std::vector<Mask> live = Solve(
+        steps,
+        [&exposed](const std::vector<Mask>& live,
+                   size_t address,
+                   Address target) {
+            return static_cast<Mask>(live[address + 1] | exposed[target]);
+        },
+        [&routines](const std::vector<Mask>& live, size_t address) {
+            return routines.AfterReturn(live, address);
+        });
+
+    for (size_t address = 0; address + 1 < decoded.size(); ++address) {
+        if (decoded[address].code == cmd::CALLI ||
+            decoded[address].code == cmd::CALL) {
+            live_.emplace(static_cast<Address>(address + 1),
+                          live[address + 1]);
+        }
+    }
+}
+
+bool Executor::Intrinsics::Empty() const {
+    return routines_.empty();
+}
+
+std::optional<Executor::Intrinsics::Routine> Executor::Intrinsics::TryGet(
+    Address callee,
+    Address ret,
+    const Reader& read) const {
+    const auto routine = routines_.find(callee);
+    const auto live    = live_.find(ret);
+    if (routine == routines_.end() || live == live_.end()) {
+        return std::nullopt;
+    }
+
+    const Entry& entry = routine->second;
+
+    // the caller may read the registers or the flags
+    // the interpreted routine would have changed
+    if ((live->second & entry.clobbered) != 0) {
+        return std::nullopt;
+    }
+
+    for (const auto& [address, value] : entry.constants) {
+        if (read(address) != value) {
+            return std::nullopt;
+        }
+    }
+
+    return entry.routine;
+}
+
+// NOLINTNEXTLINE(*-function-size)
+bool Executor::Intrinsics::Run(Routine routine,
+                               Address frame,
+                               const Reader& read,
+                               std::string& text) {
+    // the arguments are read lazily, since the routines take
+    // different numbers of them
+    const auto argument = [&](Address index) {
+        return read(frame + kFirstArgument + index);
+    };
+
+    const auto two_words = [&](Address index) -> std::optional<TwoWords> {
+        const std::optional<Word> low  = argument(index);
+        const std::optional<Word> high = argument(index + 1);
+        if (!low || !high) {
+            return std::nullopt;
+        }
+
+        return utils::types::Join(*low, *high);
+    };
+
+    switch (routine) {
+        case PRINT_NEWLINE: {
+            text += '\n';
+            return true;
+        }
+
+        case PRINT_CHAR: {
+            const std::optional<Word> chr = argument(0);
+            return chr && PutChar(*chr, text);
+        }
+
+        case PRINT_STRING: {
+            const std::optional<Word> address = argument(0);
+            return address && PutString(read, *address, text);
+        }
+
+        case PRINT_UINT32:
+        case PRINT_INT32: {
+            const std::optional<Word> base  = argument(0);
+            const std::optional<Word> value = argument(1);
+            if (!base || !value || !IsValidBase(*base)) {
+                return false;
+            }
+
+            if (routine == PRINT_INT32) {
+                PutSigned(*value, *base, text);
+            } else {
+                PutUnsigned(*value, *base, text);
+            }
+
+            return true;
+        }
+
+        case PRINT_UINT32_DECIMAL:
+        case PRINT_INT32_DECIMAL: {
+            const std::optional<Word> value = argument(0);
+            if (!value) {
+                return false;
+            }
+
+            if (routine == PRINT_INT32_DECIMAL) {
+                PutSigned(*value, kDecimalBase, text);
+            } else {
+                PutUnsigned(*value, kDecimalBase, text);
+            }
+
+            return true;
+        }
+
+        case PRINT_UINT64:
+        case PRINT_INT64: {
+            const std::optional<Word> base      = argument(0);
+            const std::optional<TwoWords> value = two_words(1);
+            if (!base || !value || !IsValidBase(*base)) {
+                return false;
+            }
+
+            if (routine == PRINT_INT64) {
+                PutSigned(*value, *base, text);
+            } else {
+                PutUnsigned(*value, *base, text);
+            }
+
+            return true;
+        }
+
+        case PRINT_UINT64_DECIMAL:
+        case PRINT_INT64_DECIMAL: {
+            const std::optional<TwoWords> value = two_words(0);
+            if (!value) {
+                return false;
+            }
+
+            if (routine == PRINT_INT64_DECIMAL) {
+                PutSigned(*value, kDecimalBase, text);
+            } else {
+                PutUnsigned(*value, kDecimalBase, text);
+            }
+
+            return true;
+        }
+
+        case PRINT_DOUBLE: {
+            const std::optional<Word> base      = argument(0);
+            const std::optional<TwoWords> value = two_words(1);
+            const std::optional<Word> precision = argument(3);
+
+            return base && value && precision && IsValidBase(*base) &&
+                   PutDouble(*base, *value, *precision, text);
+        }
+
+        case PRINT_DOUBLE_DECIMAL: {
+            const std::optional<TwoWords> value = two_words(0);
+            const std::optional<Word> precision = argument(2);
+
+            return value && precision &&
+                   PutDouble(kDecimalBase, *value, *precision, text);
+        }
+
+        case PRINT_DOUBLE_DEFAULT_PRECISION: {
+            const std::optional<Word> base      = argument(0);
+            const std::optional<TwoWords> value = two_words(1);
+
+            return base && value && IsValidBase(*base) &&
+                   PutDouble(*base, *value, kDefaultPrecision, text);
+        }
+
+        case PRINT_DOUBLE_DECIMAL_DEFAULT_PRECISION: {
+            const std::optional<TwoWords> value = two_words(0);
+
+            return value &&
+                   PutDouble(kDecimalBase, *value, kDefaultPrecision, text);
+        }
+
+        case PRINTF: {
+            return Printf(read, frame, text);
+        }
+    }
+
+    return false;
+}
+
+}  // namespace karma
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>        // for size_t
+#include <cstdint>        // for uint8_t, uint16_t
+#include <functional>     // for function
+#include <optional>       // for optional
+#include <span>           // for span
+#include <string>         // for string
+#include <unordered_map>  // for unordered_map
+#include <utility>        // for pair
+#include <vector>         // for vector
+
+#include "exec/exec.hpp"
+#include "exec/symbols.hpp"
+#include "executor/executor.hpp"
+#include "specs/architecture.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the routines of the printing library (see the programs/print directory),
+// which are executed natively rather than interpreted if the config enables
+// them (see the Config::SetIntrinsics method)
+//
+// a routine is recognized by its label (taken from the debug info
+// of the program) and by the fingerprint of its code, i.e. of the commands
+// reachable from its first one and of the constants they read, and is run
+// natively only for the arguments the interpreted routine succeeds with,
+// producing exactly the same output, while for the rest (e.g. an invalid
+// base, an invalid format string or an unreadable string) the interpreted
+// routine is called, so that it reports the error itself
+//
+// the native routine does not change the registers and the flags, so it is
+// only run if none of the ones the interpreted routine may write is read
+// by the caller after the return before being written again (see the README
+// of the programs/print directory for the calling convention)
+class Executor::Intrinsics : detail::utils::traits::NonCopyableMovable {
+   private:
+    using Word     = detail::specs::arch::Word;
+    using TwoWords = detail::specs::arch::TwoWords;
+    using Address  = detail::specs::arch::Address;
+
+   public:
+    enum Routine : uint8_t {
+        PRINT_NEWLINE,
+        PRINT_CHAR,
+        PRINT_STRING,
+
+        PRINT_UINT32,
+        PRINT_UINT32_DECIMAL,
+        PRINT_INT32,
+        PRINT_INT32_DECIMAL,
+
+        PRINT_UINT64,
+        PRINT_UINT64_DECIMAL,
+        PRINT_INT64,
+        PRINT_INT64_DECIMAL,
+
+        PRINT_DOUBLE,
+        PRINT_DOUBLE_DECIMAL,
+        PRINT_DOUBLE_DEFAULT_PRECISION,
+        PRINT_DOUBLE_DECIMAL_DEFAULT_PRECISION,
+
+        PRINTF,
+    };
+
+    // reads a word of the memory the same way the interpreted routine does,
+    // std::nullopt if the read would fail
+    using Reader = std::function<std::optional<Word>(Address)>;
+
+    // the general purpose registers (the bits from 0 to 12)
+    // and the flags (the bit 13)
+    using Mask = uint16_t;
+
+    // the interpreted routines recurse over the digits (up to about a thousand
+    // levels for the largest double value printed in the base 2), so they are
+    // only run natively if the stack surely fits the recursion
+    static constexpr size_t kStackReserve = 1 << 14;
+
+   public:
+    Intrinsics() = default;
+
+    // the code and the constants segments are the initial ones,
+    // so the intrinsics are not used once the code is modified
+    Intrinsics(const Exec::Symbols&,
+               std::span<const Word> code,
+               std::span<const Word> constants,
+               Address entrypoint);
+
+    [[nodiscard]] bool Empty() const;
+
+    // the routine starting at the callee address (if any), provided that
+    // it is called by the command preceding the return address, the caller
+    // does not read the registers and the flags clobbered by the routine
+    // and the constants the routine reads are intact
+    [[nodiscard]] std::optional<Routine> TryGet(Address callee,
+                                                Address ret,
+                                                const Reader&) const;
+
+    // runs the routine called with the call frame register at the frame
+    // address (i.e. the arguments start at frame + 3) and appends its output
+    // to the text, returns false if the routine is not run natively
+    static bool Run(Routine,
+                    Address frame,
+                    const Reader&,
+                    std::string& text);
+
+   private:
+    struct Entry {
+        Routine routine;
+
+        // the registers and the flags the interpreted routine may write
+        Mask clobbered;
+
+        // the constants read by the interpreted routine with their initial
+        // values, which the program may have overwritten since
+        std::vector<std::pair<Address, Word>> constants;
+    };
+
+   private:
+    std::unordered_map<Address, Entry> routines_;
+
+    // the registers and the flags read after the return to each address
+    // following a call command before being written (see the Solve function
+    // in the source file)
+    std::unordered_map<Address, Mask> live_;
+};
+
+}  // namespace karma
@@ -0,0 +1,170 @@
+#include "io.hpp"
+
+#include <poll.h>    // for poll, pollfd, POLLIN
+#include <unistd.h>  // for read, write, ssize_t
+
+#include <cerrno>       // for errno, EINTR
+#include <cstddef>      // for size_t
+#include <cstdint>      // for int32_t
+#include <memory>       // for shared_ptr, make_shared
+#include <string>       // for string, char_traits
+#include <string_view>  // for string_view
+
+#include "executor/input_parser.hpp"
+
+namespace karma {
+
+////////////////////////////////////////////////////////////////////////////////
+///                                iostream                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+int32_t Executor::StreamInput::ReadInt() {
+    int32_t value{};
+    in_ >> value;
+    return value;
+}
+
+double Executor::StreamInput::ReadDouble() {
+    double value{};
+    in_ >> value;
+    return value;
+}
+
+unsigned char Executor::StreamInput::ReadChar() {
+    unsigned char value{};
+    in_ >> value;
+    return value;
+}
+
+void Executor::StreamOutput::Write(std::string_view text) {
+    out_ << text;
+}
+
+void Executor::StreamOutput::Flush() {
+    out_ << std::flush;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                In-memory                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+int32_t Executor::SpanInput::ReadInt() {
+    return InputParser::ReadInt(*this);
+}
+
+double Executor::SpanInput::ReadDouble() {
+    return InputParser::ReadDouble(*this);
+}
+
+unsigned char Executor::SpanInput::ReadChar() {
+    return InputParser::ReadChar(*this);
+}
+
+int Executor::SpanInput::Peek() {
+    if (pos_ >= data_.size()) {
+        return std::char_traits<char>::eof();
+    }
+
+    return static_cast<unsigned char>(data_[pos_]);
+}
+
+void Executor::SpanInput::Advance() {
+    ++pos_;
+}
+
+std::shared_ptr<Executor::InputDevice> Executor::SpanInput::Fork() const {
+    auto fork     = std::make_shared<SpanInput>(data_.subspan(pos_));
+    fork->failed_ = failed_;
+    return fork;
+}
+
+void Executor::StringOutput::Write(std::string_view text) {
+    data_ += text;
+}
+
+const std::string& Executor::StringOutput::Data() const {
+    return data_;
+}
+
+void Executor::StringOutput::Clear() {
+    data_.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                             File descriptor                              ///
+////////////////////////////////////////////////////////////////////////////////
+
+int32_t Executor::FdInput::ReadInt() {
+    return InputParser::ReadInt(*this);
+}
+
+double Executor::FdInput::ReadDouble() {
+    return InputParser::ReadDouble(*this);
+}
+
+unsigned char Executor::FdInput::ReadChar() {
+    return InputParser::ReadChar(*this);
+}
+
+bool Executor::FdInput::Ready() {
+    if (pos_ < buffer_.size() || eof_) {
+        return true;
+    }
+
+    // the errors and the closed descriptor are reported
+    // as ready, so that reading reports them as the end of the input
+    pollfd fd{.fd = fd_, .events = POLLIN, .revents = 0};
+    return poll(&fd, 1, 0) != 0;
+}
+
+int Executor::FdInput::Peek() {
+    while (pos_ >= buffer_.size() && !eof_) {
+        buffer_.resize(kChunkSize);
+        pos_ = 0;
+
+        const ssize_t n_read = read(fd_, buffer_.data(), kChunkSize);
+
+        if (n_read < 0 && errno == EINTR) {
+            buffer_.clear();
+            continue;
+        }
+
+        if (n_read <= 0) {
+            buffer_.clear();
+            eof_ = true;
+            break;
+        }
+
+        buffer_.resize(static_cast<size_t>(n_read));
+    }
+
+    if (pos_ >= buffer_.size()) {
+        return std::char_traits<char>::eof();
+    }
+
+    return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+void Executor::FdInput::Advance() {
+    ++pos_;
+}
+
+void Executor::FdOutput::Write(std::string_view text) {
+    while (!text.empty()) {
+        const ssize_t n_written = write(fd_, text.data(), text.size());
+
+        if (n_written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // there is no way to report the error to the program,
+        // so the rest of the output is discarded
+        if (n_written <= 0) {
+            return;
+        }
+
+        text.remove_prefix(static_cast<size_t>(n_written));
+    }
+}
+
+}  // namespace karma
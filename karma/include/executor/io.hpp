@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <cstdint>      // for int32_t
+#include <iostream>     // for istream, ostream, cin, cout
+#include <memory>       // for shared_ptr
+#include <span>         // for span
+#include <string>       // for string
+#include <string_view>  // for string_view
+#include <vector>       // for vector
+
+#include "executor/executor.hpp"
+
+namespace karma {
+
+////////////////////////////////////////////////////////////////////////////////
+///                               Interfaces                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+class Executor::InputDevice {
+   public:
+    InputDevice()          = default;
+    virtual ~InputDevice() = default;
+
+    InputDevice(const InputDevice&)            = delete;
+    InputDevice& operator=(const InputDevice&) = delete;
+    InputDevice(InputDevice&&)                 = delete;
+    InputDevice& operator=(InputDevice&&)      = delete;
+
+    // the following methods read the values the same way as the operator>>
+    // of std::istream does (i.e. skipping the leading whitespace characters),
+    // and return 0 if the value could not be read, in which case all
+    // the subsequent reads return 0 as well
+
+    virtual int32_t ReadInt()        = 0;
+    virtual double ReadDouble()      = 0;
+    virtual unsigned char ReadChar() = 0;
+
+    // returns false if reading a value would wait for the input to arrive
+    // (i.e. no input is available at the moment, but the input is not over),
+    // which allows for the executions run in the slices not to block their
+    // thread (see the Job class), the devices never waiting return true
+    [[nodiscard]] virtual bool Ready() {
+        return true;
+    }
+
+    // returns a new device reading the rest of the input independently
+    // of this one, which allows for the executions resumed from a snapshot
+    // to continue the input read before the snapshot point (see the Snapshot
+    // class), nullptr is returned if the device does not support forking
+    [[nodiscard]] virtual std::shared_ptr<InputDevice> Fork() const {
+        return nullptr;
+    }
+};
+
+class Executor::OutputDevice {
+   public:
+    OutputDevice()          = default;
+    virtual ~OutputDevice() = default;
+
+    OutputDevice(const OutputDevice&)            = delete;
+    OutputDevice& operator=(const OutputDevice&) = delete;
+    OutputDevice(OutputDevice&&)                 = delete;
+    OutputDevice& operator=(OutputDevice&&)      = delete;
+
+    // the text is already formatted the same way as the operator<<
+    // of std::ostream with the default formatting flags formats it
+    virtual void Write(std::string_view) = 0;
+    virtual void Flush() {}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///                                iostream                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+class Executor::StreamInput final : public InputDevice {
+   public:
+    explicit StreamInput(std::istream& in = std::cin)
+        : in_(in) {}
+
+    int32_t ReadInt() override;
+    double ReadDouble() override;
+    unsigned char ReadChar() override;
+
+   private:
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    std::istream& in_;
+};
+
+class Executor::StreamOutput final : public OutputDevice {
+   public:
+    explicit StreamOutput(std::ostream& out = std::cout)
+        : out_(out) {}
+
+    void Write(std::string_view) override;
+    void Flush() override;
+
+   private:
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    std::ostream& out_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///                                In-memory                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+// the data is not copied, so it must outlive the device
+class Executor::SpanInput final : public InputDevice {
+   private:
+    friend class Executor::InputParser;
+
+   public:
+    explicit SpanInput(std::span<const char> data)
+        : data_(data) {}
+
+    int32_t ReadInt() override;
+    double ReadDouble() override;
+    unsigned char ReadChar() override;
+
+    [[nodiscard]] std::shared_ptr<InputDevice> Fork() const override;
+
+   private:
+    [[nodiscard]] int Peek();
+    void Advance();
+
+   private:
+    std::span<const char> data_;
+    size_t pos_{0};
+    bool failed_{false};
+};
+
+class Executor::StringOutput final : public OutputDevice {
+   public:
+    void Write(std::string_view) override;
+
+    [[nodiscard]] const std::string& Data() const;
+    void Clear();
+
+   private:
+    std::string data_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///                             File descriptor                              ///
+////////////////////////////////////////////////////////////////////////////////
+
+// the file descriptor is neither owned nor closed by the following devices
+
+class Executor::FdInput final : public InputDevice {
+   private:
+    friend class Executor::InputParser;
+
+    static constexpr size_t kChunkSize = 1 << 12;
+
+   public:
+    explicit FdInput(int fd)
+        : fd_(fd) {}
+
+    int32_t ReadInt() override;
+    double ReadDouble() override;
+    unsigned char ReadChar() override;
+
+    // only checks if some input is available, so reading a value
+    // may still wait for the rest of it to arrive
+    [[nodiscard]] bool Ready() override;
+
+   private:
+    [[nodiscard]] int Peek();
+    void Advance();
+
+   private:
+    int fd_;
+
+    // the input is read by chunks of at most kChunkSize bytes,
+    // but no more than is available at the moment is waited for
+    std::vector<char> buffer_;
+    size_t pos_{0};
+    bool eof_{false};
+    bool failed_{false};
+};
+
+class Executor::FdOutput final : public OutputDevice {
+   public:
+    explicit FdOutput(int fd)
+        : fd_(fd) {}
+
+    void Write(std::string_view) override;
+
+   private:
+    int fd_;
+};
+
+}  // namespace karma
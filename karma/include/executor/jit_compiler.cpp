@@ -0,0 +1,571 @@
+#include "jit_compiler.hpp"
+
+#include <sys/mman.h>  // for mmap, mprotect, munmap, PROT_*, MAP_*
+
+#include <cstddef>   // for size_t
+#include <cstdint>   // for uint8_t, uint32_t
+#include <cstring>   // for memcpy
+#include <memory>    // for unique_ptr
+#include <optional>  // for optional, nullopt
+#include <utility>   // for move
+#include <vector>    // for vector
+
+#include "executor/decode_cache.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "specs/flags.hpp"
+#include "utils/types.hpp"
+
+namespace karma {
+
+namespace utils = detail::utils;
+namespace arch  = detail::specs::arch;
+namespace cmd   = detail::specs::cmd;
+namespace flags = detail::specs::flags;
+
+////////////////////////////////////////////////////////////////////////////////
+///                                  Block                                   ///
+////////////////////////////////////////////////////////////////////////////////
+
+void Executor::JitCompiler::Block::Unmap::operator()(uint8_t* code) const {
+    munmap(code, size);
+}
+
+arch::Address Executor::JitCompiler::Block::operator()(
+    arch::Word* registers,
+    arch::Word* flags,
+    arch::Word* memory) const {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return reinterpret_cast<Function>(code_.get())(registers, flags, memory);
+}
+
+const std::vector<cmd::Code>& Executor::JitCompiler::Block::Commands() const {
+    return commands_;
+}
+
+std::optional<Executor::JitCompiler::Block> Executor::JitCompiler::MakeBlock(
+    const std::vector<uint8_t>& code,
+    std::vector<cmd::Code> commands) {
+    void* memory = mmap(nullptr,
+                        code.size(),
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1,
+                        0);
+
+    // the failure to allocate the executable memory is not an error,
+    // the commands of the block are simply interpreted
+    if (memory == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    std::memcpy(memory, code.data(), code.size());
+
+    Block block{std::unique_ptr<uint8_t, Block::Unmap>(
+        static_cast<uint8_t*>(memory),
+        Block::Unmap{.size = code.size()}),
+                std::move(commands)};
+
+    // never keep the memory both writable and executable
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        return std::nullopt;
+    }
+
+    return block;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                            x86-64 encoding                               ///
+////////////////////////////////////////////////////////////////////////////////
+
+// the generated code keeps the pointer to the Karma registers in rdi,
+// the pointer to the Karma flags in rsi and the pointer to the Karma memory
+// in r8 (moved there from rdx in the prologue, because edx is used
+// as a scratch register along with eax and ecx)
+
+void Executor::JitCompiler::EmitByte(uint8_t byte) {
+    buffer_.push_back(byte);
+}
+
+void Executor::JitCompiler::EmitWord(uint32_t word) {
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        EmitByte(static_cast<uint8_t>(word >> (i * utils::types::kByteSize)));
+    }
+}
+
+void Executor::JitCompiler::EmitModRM(uint8_t mod, uint8_t reg, uint8_t rm) {
+    EmitByte(static_cast<uint8_t>(mod << 6U | reg << 3U | rm));
+}
+
+void Executor::JitCompiler::EmitLoadRegister(HostRegister dst,
+                                             arch::Register reg) {
+    // mov dst, [rdi + 4 * reg]
+    EmitByte(0x8B);
+    EmitModRM(0b01, dst, 0b111);
+    EmitByte(static_cast<uint8_t>(reg * sizeof(arch::Word)));
+}
+
+void Executor::JitCompiler::EmitStoreRegister(arch::Register reg,
+                                              HostRegister src) {
+    // mov [rdi + 4 * reg], src
+    EmitByte(0x89);
+    EmitModRM(0b01, src, 0b111);
+    EmitByte(static_cast<uint8_t>(reg * sizeof(arch::Word)));
+}
+
+void Executor::JitCompiler::EmitLoadMemory(HostRegister dst,
+                                           arch::Address address) {
+    // mov dst, [r8 + 4 * address]
+    EmitByte(0x41);
+    EmitByte(0x8B);
+    EmitModRM(0b10, dst, 0b000);
+    EmitWord(static_cast<uint32_t>(address * sizeof(arch::Word)));
+}
+
+void Executor::JitCompiler::EmitStoreMemory(arch::Address address,
+                                            HostRegister src) {
+    // mov [r8 + 4 * address], src
+    EmitByte(0x41);
+    EmitByte(0x89);
+    EmitModRM(0b10, src, 0b000);
+    EmitWord(static_cast<uint32_t>(address * sizeof(arch::Word)));
+}
+
+void Executor::JitCompiler::EmitLoadFlags(HostRegister dst) {
+    // mov dst, [rsi]
+    EmitByte(0x8B);
+    EmitModRM(0b00, dst, 0b110);
+}
+
+void Executor::JitCompiler::EmitStoreFlags(HostRegister src) {
+    // mov [rsi], src
+    EmitByte(0x89);
+    EmitModRM(0b00, src, 0b110);
+}
+
+void Executor::JitCompiler::EmitMoveImmediate(HostRegister dst,
+                                              arch::Word imm) {
+    // mov dst, imm
+    EmitByte(static_cast<uint8_t>(0xB8 + dst));
+    EmitWord(imm);
+}
+
+void Executor::JitCompiler::EmitConditionalMove(ConditionCode cc,
+                                                HostRegister dst,
+                                                HostRegister src) {
+    // cmovcc dst, src
+    EmitByte(0x0F);
+    EmitByte(static_cast<uint8_t>(0x40 + cc));
+    EmitModRM(0b11, dst, src);
+}
+
+void Executor::JitCompiler::EmitBinary(Opcode opcode,
+                                       HostRegister dst,
+                                       HostRegister src) {
+    // op dst, src
+    EmitByte(opcode);
+    EmitModRM(0b11, src, dst);
+}
+
+void Executor::JitCompiler::EmitBinaryImmediate(Extension extension,
+                                                HostRegister dst,
+                                                arch::Word imm) {
+    // op dst, imm
+    EmitByte(0x81);
+    EmitModRM(0b11, extension, dst);
+    EmitWord(imm);
+}
+
+void Executor::JitCompiler::EmitUnary(Extension extension, HostRegister reg) {
+    // op reg
+    EmitByte(0xF7);
+    EmitModRM(0b11, extension, reg);
+}
+
+void Executor::JitCompiler::EmitShift(Extension extension,
+                                      HostRegister dst,
+                                      uint8_t shift) {
+    // op dst, shift
+    EmitByte(0xC1);
+    EmitModRM(0b11, extension, dst);
+    EmitByte(shift);
+}
+
+void Executor::JitCompiler::EmitTest(HostRegister reg, arch::Word imm) {
+    // test reg, imm
+    EmitByte(0xF7);
+    EmitModRM(0b11, 0b000, reg);
+    EmitWord(imm);
+}
+
+void Executor::JitCompiler::EmitReturn(arch::Address next) {
+    // mov eax, next
+    // ret
+    EmitMoveImmediate(EAX, next);
+    EmitByte(0xC3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                Commands                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+void Executor::JitCompiler::EmitRHS(const Instruction& instr) {
+    EmitLoadRegister(ECX, instr.src);
+    if (instr.operand != 0) {
+        EmitBinaryImmediate(ADD_RI, ECX, instr.operand);
+    }
+}
+
+void Executor::JitCompiler::EmitRegisterOperation(Opcode opcode,
+                                                  const Instruction& instr) {
+    EmitLoadRegister(EAX, instr.recv);
+    EmitRHS(instr);
+    EmitBinary(opcode, EAX, ECX);
+    EmitStoreRegister(instr.recv, EAX);
+}
+
+void Executor::JitCompiler::EmitImmediateOperation(Extension extension,
+                                                   const Instruction& instr) {
+    EmitLoadRegister(EAX, instr.recv);
+    EmitBinaryImmediate(extension, EAX, instr.operand);
+    EmitStoreRegister(instr.recv, EAX);
+}
+
+void Executor::JitCompiler::EmitMultiplication(const Instruction& instr) {
+    // mul writes the low word of the result to eax and the high one to edx
+    EmitLoadRegister(EAX, instr.recv);
+    EmitUnary(MUL_R, ECX);
+    EmitStoreRegister(instr.recv, EAX);
+    EmitStoreRegister(instr.recv + 1, EDX);
+}
+
+void Executor::JitCompiler::EmitComparison() {
+    // the same values as written by the WriteComparisonToFlags method
+    // of the CommonExecutor class for the unsigned words
+    EmitBinary(CMP_RR, EAX, ECX);
+    EmitMoveImmediate(EDX, flags::kEqual);
+    EmitMoveImmediate(ECX, flags::kLess);
+    EmitConditionalMove(BELOW, EDX, ECX);
+    EmitMoveImmediate(ECX, flags::kGreater);
+    EmitConditionalMove(ABOVE, EDX, ECX);
+    EmitStoreFlags(EDX);
+}
+
+void Executor::JitCompiler::EmitConditionalJump(flags::Flag flag,
+                                                arch::Address dst,
+                                                arch::Address next) {
+    EmitMoveImmediate(EAX, next);
+    EmitMoveImmediate(ECX, dst);
+    EmitLoadFlags(EDX);
+    EmitTest(EDX, flag);
+    EmitConditionalMove(NOT_EQUAL, EAX, ECX);
+    EmitByte(0xC3);
+}
+
+bool Executor::JitCompiler::CanRead(arch::Register reg) const {
+    // the instruction register is updated only at the end of the block,
+    // so the commands using it are left for the interpreter
+    return reg != arch::kInstructionRegister && CanRReg(reg);
+}
+
+bool Executor::JitCompiler::CanWrite(arch::Register reg) const {
+    return reg != arch::kInstructionRegister && CanWReg(reg);
+}
+
+bool Executor::JitCompiler::IsCompilable(const Instruction& instr) const {
+    switch (instr.code) {
+        case cmd::ADD:
+        case cmd::SUB:
+        case cmd::AND:
+        case cmd::OR:
+        case cmd::XOR: {
+            return CanRead(instr.recv) && CanRead(instr.src) &&
+                   CanWrite(instr.recv);
+        }
+
+        case cmd::ADDI:
+        case cmd::SUBI:
+        case cmd::ANDI:
+        case cmd::ORI:
+        case cmd::XORI:
+        case cmd::NOT: {
+            return CanRead(instr.recv) && CanWrite(instr.recv);
+        }
+
+        case cmd::SHLI:
+        case cmd::SHRI: {
+            // a too big shift is an error reported by the interpreter
+            return CanRead(instr.recv) && CanWrite(instr.recv) &&
+                   instr.operand < sizeof(arch::Word) * utils::types::kByteSize;
+        }
+
+        case cmd::MUL: {
+            return CanRead(instr.recv) && CanRead(instr.src) &&
+                   CanWrite(instr.recv) && CanWrite(instr.recv + 1);
+        }
+
+        case cmd::MULI: {
+            return CanRead(instr.recv) && CanWrite(instr.recv) &&
+                   CanWrite(instr.recv + 1);
+        }
+
+        case cmd::CMP: {
+            return CanRead(instr.recv) && CanRead(instr.src);
+        }
+
+        case cmd::CMPI: {
+            return CanRead(instr.recv);
+        }
+
+        case cmd::LC:
+        case cmd::LA: {
+            return CanWrite(instr.recv);
+        }
+
+        case cmd::MOV: {
+            return CanRead(instr.src) && CanWrite(instr.recv);
+        }
+
+        case cmd::LOAD: {
+            return CanRMem(instr.operand) && CanWrite(instr.recv);
+        }
+
+        case cmd::STORE: {
+            // the writes to the code segment invalidate the compiled blocks,
+            // so they are left for the interpreter
+            return CanRead(instr.recv) && CanWMem(instr.operand) &&
+                   instr.operand >= CodeSegmentSize();
+        }
+
+        case cmd::JMP:
+        case cmd::JNE:
+        case cmd::JEQ:
+        case cmd::JLE:
+        case cmd::JL:
+        case cmd::JGE:
+        case cmd::JG: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+// NOLINTNEXTLINE(*-function-size)
+bool Executor::JitCompiler::EmitCommand(const Instruction& instr,
+                                        arch::Address address) {
+    const arch::Address next = address + 1;
+
+    switch (instr.code) {
+        case cmd::ADD: {
+            EmitRegisterOperation(ADD_RR, instr);
+            return false;
+        }
+
+        case cmd::ADDI: {
+            EmitImmediateOperation(ADD_RI, instr);
+            return false;
+        }
+
+        case cmd::SUB: {
+            EmitRegisterOperation(SUB_RR, instr);
+            return false;
+        }
+
+        case cmd::SUBI: {
+            EmitImmediateOperation(SUB_RI, instr);
+            return false;
+        }
+
+        case cmd::MUL: {
+            EmitRHS(instr);
+            EmitMultiplication(instr);
+            return false;
+        }
+
+        case cmd::MULI: {
+            EmitMoveImmediate(ECX, instr.operand);
+            EmitMultiplication(instr);
+            return false;
+        }
+
+        case cmd::NOT: {
+            EmitLoadRegister(EAX, instr.recv);
+            EmitUnary(NOT_R, EAX);
+            EmitStoreRegister(instr.recv, EAX);
+            return false;
+        }
+
+        case cmd::SHLI: {
+            EmitLoadRegister(EAX, instr.recv);
+            EmitShift(SHL_RI, EAX, static_cast<uint8_t>(instr.operand));
+            EmitStoreRegister(instr.recv, EAX);
+            return false;
+        }
+
+        case cmd::SHRI: {
+            EmitLoadRegister(EAX, instr.recv);
+            EmitShift(SHR_RI, EAX, static_cast<uint8_t>(instr.operand));
+            EmitStoreRegister(instr.recv, EAX);
+            return false;
+        }
+
+        case cmd::AND: {
+            EmitRegisterOperation(AND_RR, instr);
+            return false;
+        }
+
+        case cmd::ANDI: {
+            EmitImmediateOperation(AND_RI, instr);
+            return false;
+        }
+
+        case cmd::OR: {
+            EmitRegisterOperation(OR_RR, instr);
+            return false;
+        }
+
+        case cmd::ORI: {
+            EmitImmediateOperation(OR_RI, instr);
+            return false;
+        }
+
+        case cmd::XOR: {
+            EmitRegisterOperation(XOR_RR, instr);
+            return false;
+        }
+
+        case cmd::XORI: {
+            EmitImmediateOperation(XOR_RI, instr);
+            return false;
+        }
+
+        case cmd::CMP: {
+            EmitLoadRegister(EAX, instr.recv);
+            EmitRHS(instr);
+            EmitComparison();
+            return false;
+        }
+
+        case cmd::CMPI: {
+            EmitLoadRegister(EAX, instr.recv);
+            EmitMoveImmediate(ECX, instr.operand);
+            EmitComparison();
+            return false;
+        }
+
+        case cmd::LC:
+        case cmd::LA: {
+            EmitMoveImmediate(EAX, instr.operand);
+            EmitStoreRegister(instr.recv, EAX);
+            return false;
+        }
+
+        case cmd::MOV: {
+            EmitRHS(instr);
+            EmitStoreRegister(instr.recv, ECX);
+            return false;
+        }
+
+        case cmd::LOAD: {
+            EmitLoadMemory(EAX, instr.operand);
+            EmitStoreRegister(instr.recv, EAX);
+            return false;
+        }
+
+        case cmd::STORE: {
+            MarkMemoryDirty(instr.operand);
+            EmitLoadRegister(EAX, instr.recv);
+            EmitStoreMemory(instr.operand, EAX);
+            return false;
+        }
+
+        case cmd::JMP: {
+            EmitReturn(instr.operand);
+            return true;
+        }
+
+        case cmd::JNE: {
+            EmitConditionalJump(flags::NOT_EQUAL, instr.operand, next);
+            return true;
+        }
+
+        case cmd::JEQ: {
+            EmitConditionalJump(flags::EQUAL, instr.operand, next);
+            return true;
+        }
+
+        case cmd::JLE: {
+            EmitConditionalJump(flags::LESS_OR_EQUAL, instr.operand, next);
+            return true;
+        }
+
+        case cmd::JL: {
+            EmitConditionalJump(flags::LESS, instr.operand, next);
+            return true;
+        }
+
+        case cmd::JGE: {
+            EmitConditionalJump(flags::GREATER_OR_EQUAL, instr.operand, next);
+            return true;
+        }
+
+        case cmd::JG: {
+            EmitConditionalJump(flags::GREATER, instr.operand, next);
+            return true;
+        }
+
+        default: {
+            // unreachable because of the IsCompilable check
+            EmitReturn(address);
+            return true;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Compile                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+std::optional<Executor::JitCompiler::Block> Executor::JitCompiler::Compile(
+    arch::Address leader) {
+    if (!kSupported) {
+        return std::nullopt;
+    }
+
+    buffer_.clear();
+
+    // mov r8, rdx
+    EmitByte(0x49);
+    EmitByte(0x89);
+    EmitModRM(0b11, EDX, 0b000);
+
+    std::vector<cmd::Code> compiled;
+    for (arch::Address address = leader;; ++address) {
+        if (address >= CodeSegmentSize()) {
+            EmitReturn(address);
+            break;
+        }
+
+        const Instruction instr = Fetch(address);
+        if (!IsCompilable(instr)) {
+            EmitReturn(address);
+            break;
+        }
+
+        compiled.push_back(instr.code);
+        if (EmitCommand(instr, address)) {
+            break;
+        }
+    }
+
+    if (compiled.empty()) {
+        return std::nullopt;
+    }
+
+    return MakeBlock(buffer_, std::move(compiled));
+}
+
+}  // namespace karma
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <cstdint>   // for uint8_t, uint32_t
+#include <memory>    // for shared_ptr, unique_ptr
+#include <optional>  // for optional
+#include <utility>   // for move
+#include <vector>    // for vector
+
+#include "executor/decode_cache.hpp"
+#include "executor/executor.hpp"
+#include "executor/executor_base.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "specs/flags.hpp"
+
+namespace karma {
+
+class Executor::JitCompiler : public ExecutorBase {
+   public:
+    // the native code is only generated for x86-64, on the other platforms
+    // the Compile method never succeeds and all the commands are interpreted
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+    static constexpr bool kSupported = true;
+#else
+    static constexpr bool kSupported = false;
+#endif
+
+    class Block {
+       private:
+        using Word    = detail::specs::arch::Word;
+        using Address = detail::specs::arch::Address;
+
+        // the System V calling convention is used, so the arguments are passed
+        // in the rdi, rsi and rdx registers and the result is returned in eax
+        using Function = Address (*)(Word* registers,
+                                     Word* flags,
+                                     Word* memory);
+
+       public:
+        struct Unmap {
+            size_t size;
+
+            void operator()(uint8_t*) const;
+        };
+
+        Block(std::unique_ptr<uint8_t, Unmap> code,
+              std::vector<detail::specs::cmd::Code> commands)
+            : code_(std::move(code)),
+              commands_(std::move(commands)) {}
+
+        // executes the block and returns the address of the next command
+        Address operator()(Word* registers, Word* flags, Word* memory) const;
+
+        // the codes of the compiled commands, all of which are executed
+        // on each execution of the block (it has no exits but the last one)
+        [[nodiscard]] const std::vector<detail::specs::cmd::Code>& Commands()
+            const;
+
+       private:
+        std::unique_ptr<uint8_t, Unmap> code_;
+        std::vector<detail::specs::cmd::Code> commands_;
+    };
+
+   private:
+    using Instruction = DecodeCache::Instruction;
+
+    enum HostRegister : uint8_t {
+        EAX = 0,
+        ECX = 1,
+        EDX = 2,
+    };
+
+    // the opcodes of the x86 "op r/m32, r32" instructions
+    enum Opcode : uint8_t {
+        ADD_RR = 0x01,
+        OR_RR  = 0x09,
+        AND_RR = 0x21,
+        SUB_RR = 0x29,
+        XOR_RR = 0x31,
+        CMP_RR = 0x39,
+    };
+
+    // the opcode extensions (stored in the reg field of the ModR/M byte)
+    // of the x86 "op r/m32, imm32", unary and shift instructions
+    enum Extension : uint8_t {
+        ADD_RI = 0,
+        OR_RI  = 1,
+        AND_RI = 4,
+        SUB_RI = 5,
+        XOR_RI = 6,
+
+        NOT_R  = 2,
+        MUL_R  = 4,
+
+        SHL_RI = 4,
+        SHR_RI = 5,
+    };
+
+    enum ConditionCode : uint8_t {
+        BELOW     = 0x2,
+        NOT_EQUAL = 0x5,
+        ABOVE     = 0x7,
+    };
+
+   private:
+    void EmitByte(uint8_t);
+    void EmitWord(uint32_t);
+
+    void EmitModRM(uint8_t mod, uint8_t reg, uint8_t rm);
+
+    void EmitLoadRegister(HostRegister, detail::specs::arch::Register);
+    void EmitStoreRegister(detail::specs::arch::Register, HostRegister);
+    void EmitLoadMemory(HostRegister, detail::specs::arch::Address);
+    void EmitStoreMemory(detail::specs::arch::Address, HostRegister);
+    void EmitLoadFlags(HostRegister);
+    void EmitStoreFlags(HostRegister);
+
+    void EmitMoveImmediate(HostRegister, detail::specs::arch::Word);
+    void EmitConditionalMove(ConditionCode, HostRegister dst, HostRegister src);
+
+    void EmitBinary(Opcode, HostRegister dst, HostRegister src);
+    void EmitBinaryImmediate(Extension,
+                             HostRegister,
+                             detail::specs::arch::Word);
+    void EmitUnary(Extension, HostRegister);
+    void EmitShift(Extension, HostRegister, uint8_t);
+    void EmitTest(HostRegister, detail::specs::arch::Word);
+
+    void EmitReturn(detail::specs::arch::Address);
+
+   private:
+    // loads the right hand side operand of an RR format command to ecx
+    void EmitRHS(const Instruction&);
+
+    // recv = recv <op> (src + mod) for the RR format commands
+    void EmitRegisterOperation(Opcode, const Instruction&);
+
+    // recv = recv <op> imm for the RI format commands
+    void EmitImmediateOperation(Extension, const Instruction&);
+
+    // recv:recv+1 = recv * ecx as unsigned values
+    void EmitMultiplication(const Instruction&);
+
+    // compares eax to ecx as unsigned values and writes the result to flags
+    void EmitComparison();
+
+    void EmitConditionalJump(detail::specs::flags::Flag,
+                             detail::specs::arch::Address dst,
+                             detail::specs::arch::Address next);
+
+   private:
+    [[nodiscard]] bool CanRead(detail::specs::arch::Register) const;
+    [[nodiscard]] bool CanWrite(detail::specs::arch::Register) const;
+
+    // checks that the command can be compiled and that its execution
+    // is guaranteed to neither throw an ExecutionError nor modify the code
+    [[nodiscard]] bool IsCompilable(const Instruction&) const;
+
+    // returns true if the command terminates the block
+    bool EmitCommand(const Instruction&,
+                     detail::specs::arch::Address);
+
+    static std::optional<Block> MakeBlock(
+        const std::vector<uint8_t>&,
+        std::vector<detail::specs::cmd::Code> commands);
+
+   public:
+    // do not make the following constructor explicit to be able to use it
+    // in the same way as the CommonExecutor class children are created
+
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    JitCompiler(std::shared_ptr<Storage> storage)
+        : ExecutorBase(std::move(storage)) {}
+
+    // compiles the basic block starting at the specified address until
+    // the first jump or the first command that cannot be compiled (in which
+    // case the execution falls back to the interpreter), returns std::nullopt
+    // if no command of the block can be compiled
+    std::optional<Block> Compile(detail::specs::arch::Address leader);
+
+   private:
+    std::vector<uint8_t> buffer_;
+};
+
+}  // namespace karma
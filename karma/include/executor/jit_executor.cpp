@@ -0,0 +1,242 @@
+#include "jit_executor.hpp"
+
+#include <cstddef>   // for size_t
+#include <cstdint>   // for uint64_t
+#include <optional>  // for optional
+#include <span>      // for span
+#include <utility>   // for move
+#include <vector>    // for vector
+
+#include "executor/stats.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+
+namespace karma {
+
+namespace arch = detail::specs::arch;
+namespace cmd  = detail::specs::cmd;
+
+void Executor::JitExecutor::Reset() {
+    CountNativeCommands();
+
+    const size_t code_size = CodeSegmentSize();
+
+    counters_.assign(code_size, 0);
+    compiled_.assign(code_size, 0);
+    covered_.assign(code_size, 0);
+    blocks_.clear();
+
+    // the leaders of the unmodified code are marked once for the program,
+    // so only the modified one is decoded again here
+    if (const std::vector<uint8_t>* leaders = CodeLeaders()) {
+        leaders_ = *leaders;
+    } else {
+        leaders_.assign(code_size, 0);
+        for (arch::Address address = 0; address < code_size; ++address) {
+            const Instruction instr = Fetch(address);
+            cmd::MarkLeaders(instr.code, instr.operand, address, leaders_);
+        }
+    }
+
+    generation_ = CodeGeneration();
+}
+
+void Executor::JitExecutor::Invalidate() {
+    const std::optional<std::span<const arch::Address>> invalidated =
+        InvalidatedCodeSince(generation_);
+
+    if (!invalidated) {
+        Reset();
+        return;
+    }
+
+    for (const arch::Address address : *invalidated) {
+        if (address >= leaders_.size()) {
+            continue;
+        }
+
+        const Instruction instr = Fetch(address);
+        cmd::MarkLeaders(instr.code, instr.operand, address, leaders_);
+
+        // the block which has failed to compile at the address
+        // may start with a compilable command now
+        if (compiled_[address] == 0 &&
+            counters_[address] == kHotBlockThreshold) {
+            leaders_[address]  = 1;
+            counters_[address] = 0;
+        }
+
+        if (covered_[address] == 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < blocks_.size();) {
+            const arch::Address leader = blocks_[i].leader;
+            const size_t size          = blocks_[i].block.Commands().size();
+
+            if (address < leader || address >= leader + size) {
+                ++i;
+                continue;
+            }
+
+            Drop(i);
+        }
+    }
+
+    generation_ = CodeGeneration();
+}
+
+void Executor::JitExecutor::Drop(size_t index) {
+    CompiledBlock& dropped = blocks_[index];
+    CountNativeCommands(dropped);
+
+    const size_t size = dropped.block.Commands().size();
+    for (size_t address = dropped.leader; address < dropped.leader + size;
+         ++address) {
+        --covered_[address];
+    }
+
+    compiled_[dropped.leader] = 0;
+    counters_[dropped.leader] = 0;
+
+    // the last block takes the place of the dropped one
+    if (index + 1 != blocks_.size()) {
+        dropped                   = std::move(blocks_.back());
+        compiled_[dropped.leader] = static_cast<uint32_t>(index + 1);
+    }
+
+    blocks_.pop_back();
+}
+
+bool Executor::JitExecutor::TryRunNative(arch::Address address) {
+    if (compiled_[address] == 0 &&
+        ++counters_[address] < kHotBlockThreshold) {
+        return false;
+    }
+
+    // the code has been modified since the blocks were compiled
+    // (which may drop the block at the address as well)
+    if (generation_ != CodeGeneration()) {
+        Invalidate();
+    }
+
+    if (compiled_[address] == 0) {
+        // the address is no longer a leader if the compilation has failed,
+        // so that it is never attempted again and costs nothing to the main
+        // loop, while the counter stays at the threshold to tell such
+        // addresses from the other ones (see the Invalidate method)
+        std::optional<JitCompiler::Block> block = compiler_.Compile(address);
+        if (!block) {
+            leaders_[address]  = 0;
+            counters_[address] = kHotBlockThreshold;
+            return false;
+        }
+
+        for (size_t i = 0; i < block->Commands().size(); ++i) {
+            ++covered_[address + i];
+        }
+
+        blocks_.push_back({.leader = address, .block = std::move(*block)});
+        compiled_[address] = static_cast<uint32_t>(blocks_.size());
+    }
+
+    CompiledBlock& compiled = blocks_[compiled_[address] - 1];
+
+    WReg(arch::kInstructionRegister, kInternalUse) =
+        compiled.block(RegistersData(), &Flags(), MemoryData());
+    ++compiled.entries;
+
+    return true;
+}
+
+void Executor::JitExecutor::CountNativeCommands() {
+    for (CompiledBlock& compiled : blocks_) {
+        CountNativeCommands(compiled);
+    }
+}
+
+void Executor::JitExecutor::CountNativeCommands(CompiledBlock& compiled) {
+    const uint64_t entries = compiled.entries;
+    if (entries == 0) {
+        return;
+    }
+
+    Storage::RetiredCommands& retired = Retired();
+    ExecutionStats& stats             = Stats();
+
+    for (const cmd::Code code : compiled.block.Commands()) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        retired[code] += entries;
+
+        // the only compiled commands accessing the memory
+        if (code == cmd::LOAD) {
+            stats.memory_reads += entries;
+        } else if (code == cmd::STORE) {
+            stats.memory_writes += entries;
+        }
+    }
+
+    compiled.entries = 0;
+}
+
+template <typename Policy>
+Executor::ReturnCode Executor::JitExecutor::Run() {
+    Storage::RetiredCommands& retired = Retired();
+
+    while (true) {
+        const arch::Address curr_address =
+            RReg<Policy>(arch::kInstructionRegister, kInternalUse);
+
+        if (curr_address >= arch::kMemorySize) {
+            throw ExecutionError::ExecPointerOutOfMemory(curr_address);
+        }
+
+        // the native code never reports errors, returns from the program
+        // or performs the system calls, so the main loop is simply continued
+        if (curr_address < leaders_.size() && leaders_[curr_address] != 0 &&
+            TryRunNative(curr_address)) {
+            continue;
+        }
+
+        WReg<Policy>(arch::kInstructionRegister, kInternalUse)++;
+
+        const Instruction instr = Fetch(curr_address);
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        ++retired[instr.code];
+
+        // the interpreted commands are executed in the same way as by
+        // the main loop of the TableExecutor class for the executions
+        // neither profiled nor sliced (which never use this engine),
+        // i.e. with the fused sequences and the verified commands fast path
+        if (instr.fusion != DecodeCache::NO_FUSION) {
+            ExecuteFused<Policy>(curr_address, instr);
+            continue;
+        }
+
+        if (!Policy::kChecksAccess && instr.verified) {
+            Execute<Storage::Verified>(instr);
+        } else if (MaybeReturnCode return_code = Execute<Policy>(instr)) {
+            return *return_code;
+        }
+    }
+}
+
+Executor::ReturnCode Executor::JitExecutor::Run() {
+    Reset();
+
+    ReturnCode return_code{};
+    try {
+        return_code = IsPermissive() ? Run<Storage::Permissive>()
+                                     : Run<Storage::Restricted>();
+    } catch (...) {
+        CountNativeCommands();
+        throw;
+    }
+
+    CountNativeCommands();
+
+    return return_code;
+}
+
+}  // namespace karma
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint8_t, uint32_t, uint64_t
+#include <memory>   // for shared_ptr
+#include <vector>   // for vector
+
+#include "executor/executor.hpp"
+#include "executor/jit_compiler.hpp"
+#include "executor/table_executor.hpp"
+#include "specs/architecture.hpp"
+
+namespace karma {
+
+class Executor::JitExecutor : public TableExecutor {
+   private:
+    // the number of entries to a basic block after which it is compiled,
+    // the compilation maps the memory for each block, so it only pays off
+    // for the blocks entered many times
+    static constexpr uint32_t kHotBlockThreshold = 256;
+
+    struct CompiledBlock {
+        detail::specs::arch::Address leader;
+        JitCompiler::Block block;
+
+        // the number of the executions of the block
+        // since the last CountNativeCommands call
+        uint64_t entries{0};
+    };
+
+   private:
+    // marks the basic blocks leaders (the targets of the jumps and the CALLI
+    // commands and the commands following the J format and the CALL commands)
+    // and drops all the compiled blocks
+    void Reset();
+
+    // drops only the compiled blocks containing the commands modified since
+    // the last call and marks the leaders of the new commands (the leaders
+    // of the replaced ones are kept, which only costs a few compilation
+    // attempts), falls back to the Reset method if the modified commands
+    // are no longer known (see the DecodeCache::InvalidatedSince method)
+    void Invalidate();
+
+    // drops the compiled block with the index (see the blocks_ member),
+    // so that it is compiled again once it becomes hot
+    void Drop(size_t index);
+
+    // adds the commands executed by the compiled blocks to the statistics
+    // of the execution (see the ExecutionStats struct)
+    void CountNativeCommands();
+
+    // the same as the above, but only for the single block
+    void CountNativeCommands(CompiledBlock&);
+
+    // executes the compiled block starting at the specified leader
+    // (compiling it first if it has become hot), returns false if the block
+    // is not compiled and the command should be interpreted
+    bool TryRunNative(detail::specs::arch::Address leader);
+
+    template <typename Policy>
+    ReturnCode Run();
+
+   public:
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    JitExecutor(const std::shared_ptr<Storage>& storage)
+        : TableExecutor{storage},
+          compiler_{storage} {}
+
+    ReturnCode Run();
+
+   private:
+    JitCompiler compiler_;
+
+    // the following members are indexed by the command address and are
+    // kept small, since they are allocated for the whole code segment
+    // on each execution, while only a few blocks are usually compiled
+
+    std::vector<uint8_t> leaders_;
+    std::vector<uint32_t> counters_;
+
+    // the index of the compiled block starting at the address in
+    // the blocks_ member plus one, or zero if there is no such block
+    std::vector<uint32_t> compiled_;
+
+    // the number of the compiled blocks containing the command,
+    // so that the modification of a command which is not compiled
+    // costs nothing and that of a compiled one only costs a pass
+    // over the compiled blocks
+    std::vector<uint32_t> covered_;
+
+    std::vector<CompiledBlock> blocks_;
+
+    uint64_t generation_{0};
+};
+
+}  // namespace karma
@@ -0,0 +1,129 @@
+#include "job.hpp"
+
+#include <cstdint>   // for uint32_t, uint64_t
+#include <iostream>  // for cerr
+#include <memory>    // for unique_ptr, make_unique
+#include <optional>  // for optional, nullopt
+#include <utility>   // for move
+
+#include "executor/config.hpp"
+#include "executor/errors.hpp"
+#include "executor/impl.hpp"
+#include "executor/program.hpp"
+#include "executor/snapshot.hpp"
+#include "utils/error.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+Executor::Job::Job(std::unique_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
+Executor::Job::~Job() = default;
+
+Executor::Job::Job(Job&&) noexcept = default;
+
+Executor::Job& Executor::Job::operator=(Job&&) noexcept = default;
+
+Executor::Job Executor::Job::MustStart(const Program& program,
+                                       const Config& config,
+                                       Logger log) {
+    auto impl = std::make_unique<Impl>(Config());
+    impl->MustStart(program, config, log.log);
+    return Job(std::move(impl));
+}
+
+std::optional<Executor::Job> Executor::Job::Start(const Program& program,
+                                                  const Config& config,
+                                                  Logger log) {
+    try {
+        return MustStart(program, config, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return std::nullopt;
+    }
+}
+
+Executor::Job Executor::Job::MustStart(const Program& program, Logger log) {
+    return MustStart(program, Config(), log);
+}
+
+std::optional<Executor::Job> Executor::Job::Start(const Program& program,
+                                                  Logger log) {
+    return Start(program, Config(), log);
+}
+
+Executor::Job Executor::Job::MustStart(const Snapshot& snapshot,
+                                       const Config& config,
+                                       Logger log) {
+    auto impl = std::make_unique<Impl>(Config());
+    impl->MustStart(snapshot, config, log.log);
+    return Job(std::move(impl));
+}
+
+std::optional<Executor::Job> Executor::Job::Start(const Snapshot& snapshot,
+                                                  const Config& config,
+                                                  Logger log) {
+    try {
+        return MustStart(snapshot, config, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return std::nullopt;
+    }
+}
+
+Executor::Job Executor::Job::MustStart(const Snapshot& snapshot, Logger log) {
+    return MustStart(snapshot, Config(), log);
+}
+
+std::optional<Executor::Job> Executor::Job::Start(const Snapshot& snapshot,
+                                                  Logger log) {
+    return Start(snapshot, Config(), log);
+}
+
+Executor::Job::Status Executor::Job::MustRun(uint64_t max_instructions,
+                                             Logger log) {
+    if (return_code_) {
+        return FINISHED;
+    }
+
+    // the state of the failed execution is left as it was at the error,
+    // so continuing it would execute the commands following the failed one
+    if (failed_) {
+        throw ExecutionError::JobFailed();
+    }
+
+    try {
+        return_code_ = impl_->MustRunSlice(max_instructions, log.log);
+    } catch (...) {
+        failed_ = true;
+        throw;
+    }
+
+    if (return_code_) {
+        return FINISHED;
+    }
+
+    return impl_->BlockedOnInput() ? BLOCKED_ON_INPUT : YIELDED;
+}
+
+std::optional<Executor::Job::Status> Executor::Job::Run(
+    uint64_t max_instructions,
+    Logger log) {
+    try {
+        return MustRun(max_instructions, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return std::nullopt;
+    }
+}
+
+bool Executor::Job::Finished() const {
+    return return_code_.has_value();
+}
+
+std::optional<uint32_t> Executor::Job::GetReturnCode() const {
+    return return_code_;
+}
+
+}  // namespace karma
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>   // for uint8_t, uint32_t, uint64_t
+#include <memory>    // for unique_ptr
+#include <optional>  // for optional
+
+#include "config.hpp"
+#include "executor.hpp"
+#include "program.hpp"
+#include "snapshot.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+// an execution of a program run in the slices of a limited number
+// of the commands rather than until it finishes, so that a scheduler
+// is able to run many executions on a few threads and to limit
+// the number of the commands each of them executes
+//
+// a slice never blocks the thread running it: it is stopped once it executes
+// the specified number of the commands, by the HALT command (instead of
+// waiting for a signal) and by an input system call if no input is available
+// (see InputDevice::Ready), and the next slice continues the execution
+// from where the previous one has stopped
+//
+// each job is a separate Karma computer, so different jobs may be run
+// concurrently, but the slices of the same job must not
+class Executor::Job {
+   public:
+    enum Status : uint8_t {
+        // the program has finished (see GetReturnCode)
+        FINISHED,
+
+        // the slice has executed all its commands,
+        // or the program has executed the HALT command
+        YIELDED,
+
+        // the program waits for the input,
+        // the next slice is to be run once it is available
+        BLOCKED_ON_INPUT,
+    };
+
+   private:
+    using ExecutionError = errors::executor::ExecutionError::Builder;
+
+   private:
+    explicit Job(std::unique_ptr<Impl>);
+
+   public:
+    // do not include utils/traits, because we don't want to expose
+    // internal features of the karma library to the user
+
+    ~Job();
+
+    // utils::traits::NonCopyableMovable
+
+    // Non-copyable
+    Job(const Job&)            = delete;
+    Job& operator=(const Job&) = delete;
+
+    // Movable
+    Job(Job&&) noexcept;
+    Job& operator=(Job&&) noexcept;
+
+   public:
+    // prepare the execution of the program or resume it from the snapshot
+    // (see the Executor::Execute methods) without executing any commands,
+    // the slices always use the table engine regardless of the engine
+    // specified by the config and are never profiled
+
+    static Job MustStart(const Program&,
+                         const Config&,
+                         Logger log = Logger::NoOp());
+    static std::optional<Job> Start(const Program&,
+                                    const Config&,
+                                    Logger log = Logger::NoOp());
+
+    static Job MustStart(const Program&, Logger log = Logger::NoOp());
+    static std::optional<Job> Start(const Program&,
+                                    Logger log = Logger::NoOp());
+
+    static Job MustStart(const Snapshot&,
+                         const Config&,
+                         Logger log = Logger::NoOp());
+    static std::optional<Job> Start(const Snapshot&,
+                                    const Config&,
+                                    Logger log = Logger::NoOp());
+
+    static Job MustStart(const Snapshot&, Logger log = Logger::NoOp());
+    static std::optional<Job> Start(const Snapshot&,
+                                    Logger log = Logger::NoOp());
+
+    // runs the next slice of at most max_instructions commands, the finished
+    // job stays finished, and the job failed with an error cannot be run again
+
+    Status MustRun(uint64_t max_instructions, Logger log = Logger::NoOp());
+    std::optional<Status> Run(uint64_t max_instructions,
+                              Logger log = Logger::NoOp());
+
+    [[nodiscard]] bool Finished() const;
+
+    // std::nullopt until the job is finished
+    [[nodiscard]] std::optional<uint32_t> GetReturnCode() const;
+
+   private:
+    std::unique_ptr<Impl> impl_;
+
+    MaybeReturnCode return_code_;
+    bool failed_{false};
+};
+
+}  // namespace karma
@@ -0,0 +1,180 @@
+#include "native_executor.hpp"
+
+#include <algorithm>  // for max
+#include <cstddef>    // for size_t
+#include <cstdint>    // for int32_t
+#include <exception>  // for current_exception, rethrow_exception
+#include <optional>   // for nullopt
+#include <string>     // for string
+#include <utility>    // for exchange
+
+#include "executor/stats.hpp"
+#include "executor/storage.hpp"
+#include "specs/architecture.hpp"
+#include "specs/native.hpp"
+
+namespace karma {
+
+namespace arch   = detail::specs::arch;
+namespace native = detail::specs::native;
+
+int32_t Executor::NativeExecutor::Step(native::Context* context,
+                                       arch::Address address) {
+    auto& self = *static_cast<NativeExecutor*>(context->executor);
+
+    // the exceptions must not be propagated through the native code,
+    // so they are rethrown by the main loop instead
+    try {
+        self.WReg<Storage::Permissive>(arch::kInstructionRegister,
+                                       kInternalUse) = address + 1;
+
+        const Instruction instr = self.Fetch(address);
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        ++self.Retired()[instr.code];
+
+        self.return_code_ = self.Execute<Storage::Permissive>(instr);
+        if (self.return_code_) {
+            return 1;
+        }
+    } catch (...) {
+        self.error_ = std::current_exception();
+        return 1;
+    }
+
+    if (self.generation_ != self.CodeGeneration()) {
+        self.code_modified_ = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+void Executor::NativeExecutor::PrepareModule() {
+    const std::string& path = NativeModulePath();
+
+    if (path.empty()) {
+        throw ExecutionError::NativeModuleNotSpecified();
+    }
+
+    // the module is kept loaded for the next executions of the same program
+    if (!module_ || module_->Path() != path) {
+        module_.reset();
+        module_.emplace(path);
+    }
+
+    if (!module_->Matches(MemoryData(), CodeSegmentSize())) {
+        throw ExecutionError::NativeModuleMismatch(path);
+    }
+}
+
+void Executor::NativeExecutor::PrepareContext() {
+    const auto code_end = static_cast<arch::Address>(CodeSegmentSize());
+
+    context_ = {
+        .registers     = RegistersData(),
+        .flags         = &Flags(),
+        .memory        = MemoryData(),
+        .dirty_pages   = DirtyPagesData(),
+        .retired       = Retired().data(),
+        .memory_reads  = 0,
+        .memory_writes = 0,
+        .calls         = 0,
+        .returns       = 0,
+        .code_end      = code_end,
+        .stack_limit   = std::max(
+            static_cast<arch::Address>(MinStackAddress()), code_end),
+        .lowest_push = static_cast<arch::Address>(arch::kMemorySize),
+        .executor    = this,
+        .step        = &Step,
+    };
+
+    return_code_.reset();
+    error_         = nullptr;
+    code_modified_ = false;
+    generation_    = CodeGeneration();
+}
+
+void Executor::NativeExecutor::CountNativeStats() {
+    ExecutionStats& stats = Stats();
+
+    stats.memory_reads += std::exchange(context_.memory_reads, 0);
+    stats.memory_writes += std::exchange(context_.memory_writes, 0);
+    stats.calls += std::exchange(context_.calls, 0);
+    stats.returns += std::exchange(context_.returns, 0);
+
+    // the stack depth is measured the same way as the Storage class does
+    const arch::Address lowest_push = std::exchange(
+        context_.lowest_push, static_cast<arch::Address>(arch::kMemorySize));
+
+    stats.max_stack_depth = std::max<size_t>(stats.max_stack_depth,
+                                             arch::kMemorySize - lowest_push);
+}
+
+Executor::ReturnCode Executor::NativeExecutor::RunNative() {
+    Storage::RetiredCommands& retired = Retired();
+
+    while (true) {
+        // the translated code returns when it is entered not at the beginning
+        // of a block, or when the execution leaves it, in both cases
+        // the current command is executed here
+        if (!code_modified_ && module_->Run(&context_) == native::STOPPED) {
+            if (error_) {
+                std::rethrow_exception(std::exchange(error_, nullptr));
+            }
+
+            if (return_code_) {
+                return *std::exchange(return_code_, std::nullopt);
+            }
+
+            continue;
+        }
+
+        const arch::Address curr_address =
+            RReg<Storage::Permissive>(arch::kInstructionRegister, kInternalUse);
+
+        if (curr_address >= arch::kMemorySize) {
+            throw ExecutionError::ExecPointerOutOfMemory(curr_address);
+        }
+
+        WReg<Storage::Permissive>(arch::kInstructionRegister, kInternalUse)++;
+
+        const Instruction instr = Fetch(curr_address);
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        ++retired[instr.code];
+
+        if (MaybeReturnCode return_code =
+                Execute<Storage::Permissive>(instr)) {
+            return *return_code;
+        }
+
+        if (generation_ != CodeGeneration()) {
+            code_modified_ = true;
+        }
+    }
+}
+
+Executor::ReturnCode Executor::NativeExecutor::Run() {
+    PrepareModule();
+
+    if (!IsPermissive()) {
+        return TableExecutor::Run();
+    }
+
+    PrepareContext();
+
+    ReturnCode return_code{};
+    try {
+        return_code = RunNative();
+    } catch (...) {
+        CountNativeStats();
+        throw;
+    }
+
+    CountNativeStats();
+
+    return return_code;
+}
+
+}  // namespace karma
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>    // for int32_t, uint64_t
+#include <exception>  // for exception_ptr
+#include <memory>     // for shared_ptr
+#include <optional>   // for optional
+
+#include "executor/executor.hpp"
+#include "executor/native_module.hpp"
+#include "executor/table_executor.hpp"
+#include "specs/architecture.hpp"
+#include "specs/native.hpp"
+
+namespace karma {
+
+// executes the translated code of the native module, leaving the commands
+// which may fail, the system calls and the commands outside of the translated
+// code to the TableExecutor class, which is also used for the executions
+// with some access blocks (the translated code does not check them)
+class Executor::NativeExecutor : public TableExecutor {
+   private:
+    // the step function of the native modules (see the native::Context struct)
+    static int32_t Step(detail::specs::native::Context*,
+                        detail::specs::arch::Address);
+
+    // loads the module specified by the config (if it is not loaded yet)
+    // and checks that it is translated from the executed program
+    void PrepareModule();
+
+    void PrepareContext();
+
+    // adds the memory accesses, the calls and the stack depth counted
+    // by the native code to the statistics of the execution
+    void CountNativeStats();
+
+    ReturnCode RunNative();
+
+   public:
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    NativeExecutor(const std::shared_ptr<Storage>& storage)
+        : TableExecutor{storage} {}
+
+    ReturnCode Run();
+
+   private:
+    std::optional<NativeModule> module_;
+    detail::specs::native::Context context_{};
+
+    // the result of the command executed by the step function,
+    // which stops the native code to be reported by the main loop
+    MaybeReturnCode return_code_;
+    std::exception_ptr error_;
+
+    // the code has been modified at runtime, so the translated code
+    // is not executed until the end of the execution
+    bool code_modified_{false};
+    uint64_t generation_{0};
+};
+
+}  // namespace karma
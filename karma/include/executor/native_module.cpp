@@ -0,0 +1,83 @@
+#include "native_module.hpp"
+
+#include <dlfcn.h>  // for dlopen, dlsym, dlclose, dlerror, RTLD_*
+
+#include <algorithm>   // for equal
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t
+#include <filesystem>  // for absolute
+#include <sstream>     // for ostringstream
+#include <string>      // for string
+
+#include "specs/architecture.hpp"
+#include "specs/native.hpp"
+
+namespace karma {
+
+namespace arch   = detail::specs::arch;
+namespace native = detail::specs::native;
+
+void Executor::NativeModule::Close::operator()(void* handle) const {
+    dlclose(handle);
+}
+
+Executor::NativeModule::NativeModule(const std::string& path)
+    : path_(path) {
+    // dlopen searches the library paths for the names without a slash,
+    // so the module is always loaded by its absolute path
+    const std::string absolute = std::filesystem::absolute(path).string();
+
+    handle_.reset(dlopen(absolute.c_str(), RTLD_NOW | RTLD_LOCAL));
+    if (!handle_) {
+        const char* reason = dlerror();
+        throw ExecutionError::NativeModuleNotLoaded(
+            path_,
+            reason != nullptr ? reason : "unknown dlopen error");
+    }
+
+    const auto* abi = static_cast<const uint32_t*>(Symbol(native::kAbiSymbol));
+    if (*abi != native::kAbiVersion) {
+        std::ostringstream ss;
+        ss << "the interface version " << *abi << " is not supported "
+           << "(expected " << native::kAbiVersion << ")";
+        throw ExecutionError::NativeModuleNotLoaded(path_, ss.str());
+    }
+
+    code_size_ =
+        *static_cast<const uint32_t*>(Symbol(native::kCodeSizeSymbol));
+    code_ = static_cast<const uint32_t*>(Symbol(native::kCodeSymbol));
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    run_ = reinterpret_cast<native::Run>(Symbol(native::kRunSymbol));
+}
+
+void* Executor::NativeModule::Symbol(const char* name) const {
+    // clear the error of a previous call
+    dlerror();
+
+    void* symbol = dlsym(handle_.get(), name);
+    if (symbol == nullptr) {
+        const char* reason = dlerror();
+        throw ExecutionError::NativeModuleNotLoaded(
+            path_,
+            reason != nullptr ? reason : "missing symbol " + std::string(name));
+    }
+
+    return symbol;
+}
+
+const std::string& Executor::NativeModule::Path() const {
+    return path_;
+}
+
+bool Executor::NativeModule::Matches(const arch::Word* code,
+                                     size_t code_size) const {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return code_size == code_size_ && std::equal(code, code + code_size, code_);
+}
+
+int32_t Executor::NativeModule::Run(native::Context* context) const {
+    return run_(context);
+}
+
+}  // namespace karma
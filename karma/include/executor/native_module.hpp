@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint32_t
+#include <memory>   // for unique_ptr
+#include <string>   // for string
+
+#include "executor/errors.hpp"
+#include "executor/executor.hpp"
+#include "specs/architecture.hpp"
+#include "specs/native.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the shared object produced by the translator from a Karma executable file
+// (see the Translator class and the specs/native.hpp file for the interface)
+class Executor::NativeModule : detail::utils::traits::NonCopyableMovable {
+   private:
+    using ExecutionError = errors::executor::ExecutionError::Builder;
+
+    struct Close {
+        void operator()(void*) const;
+    };
+
+   private:
+    void* Symbol(const char* name) const;
+
+   public:
+    // loads the module and checks the version of its interface
+    explicit NativeModule(const std::string& path);
+
+    [[nodiscard]] const std::string& Path() const;
+
+    // true if the module is translated from the specified code segment
+    [[nodiscard]] bool Matches(const detail::specs::arch::Word* code,
+                               size_t code_size) const;
+
+    // executes the translated code (see the native::Status enum)
+    int32_t Run(detail::specs::native::Context*) const;
+
+   private:
+    std::string path_;
+    std::unique_ptr<void, Close> handle_;
+
+    const uint32_t* code_{nullptr};
+    size_t code_size_{0};
+
+    detail::specs::native::Run run_{nullptr};
+};
+
+}  // namespace karma
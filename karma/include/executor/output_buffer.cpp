@@ -0,0 +1,113 @@
+#include "output_buffer.hpp"
+
+#include <array>         // for array
+#include <charconv>      // for to_chars, chars_format
+#include <cstddef>       // for size_t
+#include <memory>        // for shared_ptr
+#include <string_view>   // for string_view
+#include <system_error>  // for errc
+#include <utility>       // for move
+
+#include "executor/config.hpp"
+#include "executor/io.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+
+namespace karma {
+
+namespace arch    = detail::specs::arch;
+namespace syscall = detail::specs::cmd::syscall;
+
+void Executor::OutputBuffer::Prepare(std::shared_ptr<OutputDevice> device,
+                                     Config::OutputBuffering buffering,
+                                     size_t buffer_size) {
+    Flush();
+
+    device_      = std::move(device);
+    buffering_   = buffering;
+    buffer_size_ = buffer_size;
+
+    buffer_.reserve(buffer_size_);
+    bytes_written_ = 0;
+}
+
+void Executor::OutputBuffer::Write(std::string_view text) {
+    bytes_written_ += text.size();
+
+    if (buffering_ == Config::UNBUFFERED) {
+        device_->Write(text);
+        device_->Flush();
+        return;
+    }
+
+    buffer_ += text;
+
+    if (buffer_.size() >= buffer_size_) {
+        Flush();
+    }
+}
+
+void Executor::OutputBuffer::Write(Int value) {
+    // enough for the sign and the decimal digits of any 32-bit integer
+    std::array<char, 16> chars{};
+
+    auto [end, _] = std::to_chars(chars.begin(), chars.end(), value);
+    Write(std::string_view(chars.begin(), end));
+}
+
+void Executor::OutputBuffer::Write(arch::Double value) {
+    // std::ostream formats the real numbers as std::printf("%.6g") does
+    static constexpr int kPrecision = 6;
+
+    // enough for "-d.ddddde-ddd" and the special values
+    std::array<char, 32> chars{};
+
+    auto [end, _] = std::to_chars(chars.begin(),
+                                  chars.end(),
+                                  value,
+                                  std::chars_format::general,
+                                  kPrecision);
+    Write(std::string_view(chars.begin(), end));
+}
+
+void Executor::OutputBuffer::Write(syscall::Char value) {
+    const auto chr = static_cast<char>(value);
+    Write(std::string_view(&chr, 1));
+
+    // the integers and the real numbers are never printed with a newline
+    if (buffering_ == Config::LINE && chr == '\n') {
+        Flush();
+    }
+}
+
+void Executor::OutputBuffer::WriteChars(std::string_view chars) {
+    const size_t last_newline = chars.rfind('\n');
+    if (buffering_ != Config::LINE || last_newline == std::string_view::npos) {
+        Write(chars);
+        return;
+    }
+
+    // the characters after the last newline stay in the buffer
+    Write(chars.substr(0, last_newline + 1));
+    Flush();
+    Write(chars.substr(last_newline + 1));
+}
+
+void Executor::OutputBuffer::Flush() {
+    if (!device_) {
+        return;
+    }
+
+    if (!buffer_.empty()) {
+        device_->Write(buffer_);
+        buffer_.clear();
+    }
+
+    device_->Flush();
+}
+
+uint64_t Executor::OutputBuffer::BytesWritten() const {
+    return bytes_written_;
+}
+
+}  // namespace karma
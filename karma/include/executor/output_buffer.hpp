@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint64_t
+#include <memory>       // for shared_ptr
+#include <string>       // for string
+#include <string_view>  // for string_view
+#include <type_traits>  // for make_signed_t
+
+#include "executor/config.hpp"
+#include "executor/executor.hpp"
+#include "executor/io.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+class Executor::OutputBuffer : detail::utils::traits::NonCopyableMovable {
+   private:
+    using Int = std::make_signed_t<detail::specs::arch::Word>;
+
+   private:
+    void Write(std::string_view);
+
+   public:
+    void Prepare(std::shared_ptr<OutputDevice>,
+                 Config::OutputBuffering,
+                 size_t buffer_size);
+
+    void Write(Int);
+    void Write(detail::specs::arch::Double);
+    void Write(detail::specs::cmd::syscall::Char);
+
+    // writes the characters as if they were written one by one
+    void WriteChars(std::string_view);
+
+    void Flush();
+
+    // the number of the bytes printed since the last Prepare call
+    [[nodiscard]] uint64_t BytesWritten() const;
+
+   private:
+    std::shared_ptr<OutputDevice> device_;
+
+    Config::OutputBuffering buffering_{Config::UNBUFFERED};
+    size_t buffer_size_{0};
+
+    std::string buffer_;
+
+    uint64_t bytes_written_{0};
+};
+
+}  // namespace karma
@@ -0,0 +1,238 @@
+#include "paged_memory.hpp"
+
+#include <fcntl.h>     // for O_CREAT, O_EXCL, O_RDWR
+#include <sys/mman.h>  // for mmap, munmap, madvise, memfd_create, shm_*
+#include <unistd.h>    // for close, ftruncate, pwrite, getpid
+
+#include <algorithm>     // for copy, count, fill
+#include <atomic>        // for atomic
+#include <cerrno>        // for errno, EINTR, EEXIST
+#include <cstddef>       // for size_t, ptrdiff_t
+#include <cstdint>       // for uint8_t, uint64_t
+#include <memory>        // for unique_ptr, shared_ptr, make_shared
+#include <new>           // for bad_alloc
+#include <string>        // for string, to_string
+#include <system_error>  // for system_error, system_category
+#include <vector>        // for vector
+
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+
+namespace karma {
+
+namespace arch = detail::specs::arch;
+namespace cmd  = detail::specs::cmd;
+
+void Executor::PagedMemory::Unmap::operator()(arch::Word* data) const {
+    munmap(data, kBytes);
+}
+
+std::unique_ptr<arch::Word, Executor::PagedMemory::Unmap>
+Executor::PagedMemory::Map(arch::Word* fixed_address) {
+    // the anonymous mapping is zero-filled by the operating system
+    // on the first access to each page, MAP_FIXED atomically replaces
+    // the existing mapping at the specified address with a new one
+    void* data = mmap(fixed_address,
+                      kBytes,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS |
+                          (fixed_address != nullptr ? MAP_FIXED : 0),
+                      -1,
+                      0);
+
+    if (data == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    return std::unique_ptr<arch::Word, Unmap>(static_cast<arch::Word*>(data));
+}
+
+int Executor::PagedMemory::CreateFile() {
+#if defined(__linux__)
+    const int fd = memfd_create("karma-memory", 0);
+#else
+    // the shared memory object is unlinked right after it is created,
+    // so that it exists only until the last descriptor is closed
+    static std::atomic<uint64_t> counter{0};
+
+    int fd = -1;
+    do {
+        const std::string name = "/karma-memory-" + std::to_string(getpid()) +
+                                 "-" + std::to_string(counter++);
+
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd != -1) {
+            shm_unlink(name.c_str());
+        }
+    } while (fd == -1 && errno == EEXIST);
+#endif
+
+    if (fd == -1) {
+        throw std::system_error(errno,
+                                std::system_category(),
+                                "failed to create a memory image");
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(kBytes)) != 0) {
+        const int error = errno;
+        close(fd);
+        throw std::system_error(error,
+                                std::system_category(),
+                                "failed to create a memory image");
+    }
+
+    return fd;
+}
+
+Executor::PagedMemory::Image::~Image() {
+    close(fd_);
+}
+
+Executor::PagedMemory::PagedMemory()
+    : data_(Map()) {}
+
+Executor::PagedMemory Executor::PagedMemory::Share() {
+    return PagedMemory(data_);
+}
+
+void Executor::PagedMemory::Merge(const PagedMemory& shared) {
+    for (size_t page = 0; page < kNPages; ++page) {
+        dirty_[page] |= shared.dirty_[page];
+    }
+}
+
+void Executor::PagedMemory::Zero(size_t page) {
+    Word* begin = data_.get() + page * kPageSize;
+    std::fill(begin, begin + kPageSize, 0);
+}
+
+void Executor::PagedMemory::Reset(const std::vector<cmd::Bin>& code,
+                                  const std::vector<Word>& constants) {
+    if (restored_ || DirtyPages() > kMaxZeroedPages) {
+        // the new mapping replaces the old one, so the unique_ptr
+        // still owns the memory at the same address
+        Map(data_.get()).release();
+        dirty_.fill(0);
+        huge_pages_ = false;
+        restored_   = false;
+    } else {
+        for (size_t page = 0; page < kNPages; ++page) {
+            if (dirty_[page] != 0) {
+                Zero(page);
+                dirty_[page] = 0;
+            }
+        }
+    }
+
+    Word* data = data_.get();
+    std::copy(code.begin(), code.end(), data);
+    std::copy(constants.begin(), constants.end(), data + code.size());
+
+    const size_t size = code.size() + constants.size();
+    for (size_t page = 0; page * kPageSize < size; ++page) {
+        dirty_[page] = 1;
+    }
+}
+
+std::shared_ptr<const Executor::PagedMemory::Image>
+Executor::PagedMemory::Capture() const {
+    auto image = std::make_shared<Image>(CreateFile());
+    image->dirty_ = dirty_;
+
+    // the pages which have never been written to are zero both
+    // in the memory and in the file, so they are not written
+    for (size_t page = 0; page < kNPages; ++page) {
+        if (dirty_[page] == 0) {
+            continue;
+        }
+
+        const auto* bytes =
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            reinterpret_cast<const char*>(data_.get() + page * kPageSize);
+        const size_t page_bytes = kPageSize * arch::kWordSize;
+
+        size_t written = 0;
+        while (written < page_bytes) {
+            const ssize_t count =
+                pwrite(image->fd_,
+                       bytes + written,
+                       page_bytes - written,
+                       static_cast<off_t>(page * page_bytes + written));
+
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (count <= 0) {
+                throw std::system_error(errno,
+                                        std::system_category(),
+                                        "failed to capture the memory");
+            }
+
+            written += static_cast<size_t>(count);
+        }
+    }
+
+    return image;
+}
+
+void Executor::PagedMemory::Restore(const Image& image) {
+    // the private mapping of the file shares the physical pages
+    // of the image until they are written to, the mapping stays valid
+    // after the image (and thus the file descriptor) is destroyed
+    void* data = mmap(data_.get(),
+                      kBytes,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_FIXED,
+                      image.fd_,
+                      0);
+
+    if (data == MAP_FAILED) {
+        throw std::system_error(errno,
+                                std::system_category(),
+                                "failed to restore the memory");
+    }
+
+    dirty_      = image.dirty_;
+    huge_pages_ = false;
+    restored_   = true;
+}
+
+void Executor::PagedMemory::AdviseHugePages(bool huge_pages) {
+    if (huge_pages == huge_pages_) {
+        return;
+    }
+
+    huge_pages_ = huge_pages;
+
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+    // the advice is only a hint, so its failure is not an error
+    madvise(data_.get(), kBytes, huge_pages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#endif
+}
+
+void Executor::PagedMemory::MarkDirty(arch::Address address, size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    const size_t first = address / kPageSize;
+    const size_t last  = (address + size - 1) / kPageSize;
+    std::fill(dirty_.begin() + static_cast<std::ptrdiff_t>(first),
+              dirty_.begin() + static_cast<std::ptrdiff_t>(last) + 1,
+              1);
+}
+
+size_t Executor::PagedMemory::DirtyPages() const {
+    return static_cast<size_t>(std::count(dirty_.begin(), dirty_.end(), 1));
+}
+
+arch::Word* Executor::PagedMemory::Data() {
+    return data_.get();
+}
+
+uint8_t* Executor::PagedMemory::DirtyData() {
+    return dirty_.data();
+}
+
+}  // namespace karma
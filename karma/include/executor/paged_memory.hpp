@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>    // for array
+#include <atomic>   // for atomic_ref, memory_order_relaxed
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint8_t
+#include <memory>   // for unique_ptr, shared_ptr
+#include <utility>  // for move
+#include <vector>   // for vector
+
+#include "executor/executor.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "specs/native.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the memory of the Karma computer mapped via mmap, so that the operating
+// system commits its pages lazily on the first access, and only the pages
+// touched by an execution occupy the physical memory
+//
+// the pages written to are tracked, so that resetting the memory
+// for the next execution only zeroes the pages written to by the previous one
+class Executor::PagedMemory : detail::utils::traits::NonCopyableMovable {
+   private:
+    using Word = detail::specs::arch::Word;
+
+    struct Unmap {
+        void operator()(Word*) const;
+    };
+
+   public:
+    // the number of words in a page, i.e. the pages are 4 KiB
+    static constexpr size_t kPageSize = 1 << 10;
+    static constexpr size_t kNPages =
+        detail::specs::arch::kMemorySize / kPageSize;
+
+    // the native modules mark the pages they write to themselves
+    static_assert(kPageSize == 1 << detail::specs::native::kPageShift);
+
+    // the contents of the memory captured at some point of an execution
+    // in a file existing only in the memory (which is never modified
+    // after the capture), restoring the memory from an image maps the file
+    // privately, so the pages are copied only when written to
+    class Image {
+       private:
+        friend class PagedMemory;
+
+       public:
+        explicit Image(int fd)
+            : fd_(fd) {}
+
+        ~Image();
+
+        // the file descriptor is owned, so the image is neither copied
+        // nor moved, but shared via an std::shared_ptr instead
+
+        Image(const Image&)            = delete;
+        Image& operator=(const Image&) = delete;
+        Image(Image&&)                 = delete;
+        Image& operator=(Image&&)      = delete;
+
+       private:
+        int fd_;
+        std::array<uint8_t, kNPages> dirty_{};
+    };
+
+    // a word of the memory for writing, the memory may be shared by
+    // the threads of an execution (see the Threads class), so its words
+    // are only accessed atomically (see the Load and Store methods)
+    class SharedWord {
+       public:
+        explicit SharedWord(Word& word)
+            : word_(word) {}
+
+        // NOLINTNEXTLINE(cppcoreguidelines-c-copy-assignment-signature)
+        SharedWord& operator=(Word value) {
+            Store(word_, value);
+            return *this;
+        }
+
+        // for the atomic commands, which both read and write the word
+        [[nodiscard]] std::atomic_ref<Word> Atomic() const {
+            return std::atomic_ref<Word>(word_);
+        }
+
+       private:
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+        Word& word_;
+    };
+
+    // the relaxed atomic accesses compile to the same instructions as
+    // the plain ones, but the threads accessing the same word concurrently
+    // (e.g. via the cas and the xadd commands) do not race with each other
+
+    static Word Load(const Word& word) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        return std::atomic_ref<Word>(const_cast<Word&>(word))
+            .load(std::memory_order_relaxed);
+    }
+
+    static void Store(Word& word, Word value) {
+        std::atomic_ref<Word>(word).store(value, std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr size_t kBytes =
+        detail::specs::arch::kMemorySize * detail::specs::arch::kWordSize;
+
+    // resetting more dirty pages than this one by one is slower than
+    // replacing the whole mapping, which also releases the physical memory
+    static constexpr size_t kMaxZeroedPages = kNPages / 4;
+
+   private:
+    static std::unique_ptr<Word, Unmap> Map(Word* fixed_address = nullptr);
+
+    // creates an anonymous file of the memory size existing only in memory
+    static int CreateFile();
+
+    void Zero(size_t page);
+
+    explicit PagedMemory(std::shared_ptr<Word> data)
+        : data_(std::move(data)) {}
+
+   public:
+    PagedMemory();
+
+    // the memory of a spawned thread (see the Threads class) sharing
+    // the mapping of this one, but tracking the pages written to by
+    // the thread on its own, the mapping is never reset while it is shared
+    PagedMemory Share();
+
+    // marks the pages written to via the shared memory (see the above)
+    void Merge(const PagedMemory& shared);
+
+    // zeroes the pages written to since the previous reset
+    // and copies the code and the constants segments to the beginning
+    void Reset(const std::vector<detail::specs::cmd::Bin>& code,
+               const std::vector<Word>& constants);
+
+    // writes the dirty pages to a new image, so the image is the size
+    // of the memory actually used by the execution
+    [[nodiscard]] std::shared_ptr<const Image> Capture() const;
+
+    // replaces the memory with the copy-on-write mapping of the image
+    void Restore(const Image&);
+
+    // asks the operating system to back the memory with the huge pages
+    // (if supported), which reduces the TLB misses of the programs
+    // accessing a lot of memory, but commits the memory by 2 MiB at once
+    void AdviseHugePages(bool);
+
+    [[nodiscard]] Word Read(detail::specs::arch::Address address) const {
+        return Load(data_.get()[address]);
+    }
+
+    SharedWord Write(detail::specs::arch::Address address) {
+        MarkDirty(address);
+        return SharedWord(data_.get()[address]);
+    }
+
+    // marks the page as written to without writing, the native code
+    // generated by the JitCompiler class writes to the memory directly,
+    // so the compiler marks the pages once when compiling the commands
+    void MarkDirty(detail::specs::arch::Address address) {
+        dirty_[address / kPageSize] = 1;
+    }
+
+    // the same as the above, but for all the pages of the range
+    // (see the Storage::WMemRange method)
+    void MarkDirty(detail::specs::arch::Address address, size_t size);
+
+    [[nodiscard]] size_t DirtyPages() const;
+
+    Word* Data();
+
+    // the flags of the dirty pages for the native modules,
+    // which write to the memory directly (see the NativeExecutor class)
+    uint8_t* DirtyData();
+
+   private:
+    // is shared with the memories of the spawned threads
+    std::shared_ptr<Word> data_;
+
+    // the flag number i is set if the page number i has been written to
+    std::array<uint8_t, kNPages> dirty_{};
+
+    // the advice is dropped together with the mapping it was given for
+    bool huge_pages_{false};
+
+    // the memory is mapped from an image rather than anonymously,
+    // so it is never zeroed page by page, but always mapped anew
+    bool restored_{false};
+};
+
+}  // namespace karma
@@ -0,0 +1,454 @@
+#include "profiler.hpp"
+
+#include <algorithm>   // for partial_sort, min, sort
+#include <chrono>      // for duration
+#include <cstddef>     // for size_t, ptrdiff_t
+#include <cstdint>     // for uint64_t
+#include <functional>  // for greater
+#include <iomanip>     // for setw, setfill, setprecision
+#include <ios>         // for hex, dec, fixed, left, right, streamoff
+#include <memory>      // for shared_ptr
+#include <optional>    // for optional
+#include <sstream>     // for ostringstream
+#include <string>      // for string, to_string
+#include <utility>     // for move, pair
+#include <vector>      // for vector
+
+#include "disassembler/disassembler.hpp"
+#include "disassembler/impl.hpp"
+#include "disassembler/labels.hpp"
+#include "exec/exec.hpp"
+#include "exec/symbols.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "utils/error.hpp"
+
+namespace karma {
+
+namespace arch = detail::specs::arch;
+namespace cmd  = detail::specs::cmd;
+
+namespace {
+
+constexpr int kCountWidth    = 14;
+constexpr int kShareWidth    = 8;
+constexpr int kAddressWidth  = 5;
+constexpr int kLocationWidth = 24;
+
+constexpr double kPercent = 100.0;
+
+constexpr std::streamoff kTraceChunkSize = 1 << 16;
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+using Microseconds = std::chrono::duration<double, std::micro>;
+
+// the source lines contain the paths of the files, which may contain
+// the characters to be escaped in the JSON strings
+std::string EscapeJSON(const std::string& str) {
+    constexpr char kLastControl       = 0x1f;
+    constexpr int kUnicodeEscapeWidth = 4;
+
+    std::ostringstream out;
+    for (const char symbol : str) {
+        if (symbol == '"' || symbol == '\\') {
+            out << '\\' << symbol;
+        } else if (symbol >= 0 && symbol <= kLastControl) {
+            out << "\\u" << std::hex << std::setfill('0')
+                << std::setw(kUnicodeEscapeWidth) << static_cast<int>(symbol)
+                << std::dec;
+        } else {
+            out << symbol;
+        }
+    }
+
+    return out.str();
+}
+
+}  // namespace
+
+void Executor::Profiler::Prepare(const Config& config) {
+    profile_       = config.GetProfile();
+    folded_stacks_ = config.GetFoldedStacks();
+    trace_         = config.GetTrace();
+
+    by_address_.assign(IsEnabled() ? arch::kMemorySize : 0, 0);
+    by_code_.fill(0);
+    retired_ = 0;
+
+    stack_.clear();
+    functions_.clear();
+    active_.clear();
+    folded_.clear();
+    spans_.clear();
+}
+
+bool Executor::Profiler::IsEnabled() const {
+    return profile_ != nullptr || folded_stacks_ != nullptr ||
+           trace_ != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                             Shadow call stack                            ///
+////////////////////////////////////////////////////////////////////////////////
+
+void Executor::Profiler::Start(Address entry) {
+    started_ = Clock::now();
+
+    stack_.clear();
+    stack_.push_back({.function = entry,
+                      .retired_at_entry = retired_,
+                      .entered = started_});
+    ++active_[entry];
+}
+
+void Executor::Profiler::Call(Address callee) {
+    stack_.push_back({.function = callee,
+                      .retired_at_entry = retired_,
+                      .entered = Clock::now()});
+    ++active_[callee];
+}
+
+void Executor::Profiler::Return() {
+    // the root function is only left when the execution is finished,
+    // so that the unbalanced RET commands do not empty the stack
+    if (stack_.size() > 1) {
+        Leave();
+    }
+}
+
+void Executor::Profiler::Leave() {
+    const Frame frame = stack_.back();
+
+    const uint64_t inclusive = retired_ - frame.retired_at_entry;
+    const uint64_t exclusive = inclusive - frame.retired_by_callees;
+
+    const Clock::duration inclusive_time = Clock::now() - frame.entered;
+    const Clock::duration exclusive_time =
+        inclusive_time - frame.time_in_callees;
+
+    if (folded_stacks_) {
+        std::vector<Address> path;
+        path.reserve(stack_.size());
+        for (const Frame& curr : stack_) {
+            path.push_back(curr.function);
+        }
+
+        folded_[path] += exclusive;
+    }
+
+    stack_.pop_back();
+
+    FunctionStats& stats = functions_[frame.function];
+    ++stats.calls;
+    stats.exclusive += exclusive;
+    stats.exclusive_time += exclusive_time;
+
+    if (--active_[frame.function] == 0) {
+        stats.inclusive += inclusive;
+        stats.inclusive_time += inclusive_time;
+    }
+
+    if (!stack_.empty()) {
+        stack_.back().retired_by_callees += inclusive;
+        stack_.back().time_in_callees += inclusive_time;
+    }
+
+    if (trace_ && spans_.size() < kMaxTraceSpans) {
+        spans_.push_back({.function = frame.function,
+                          .depth    = stack_.size(),
+                          .start    = frame.entered - started_,
+                          .duration = inclusive_time,
+                          .retired  = inclusive});
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Report                                   ///
+////////////////////////////////////////////////////////////////////////////////
+
+std::string Executor::Profiler::FunctionName(const Disassembler::Labels& labels,
+                                             Address address) {
+    if (std::optional<std::string> label = labels.TryGetLabel(address)) {
+        return *label;
+    }
+
+    std::ostringstream name;
+    name << "0x" << std::hex << std::setfill('0') << std::setw(kAddressWidth)
+         << address;
+
+    return name.str();
+}
+
+void Executor::Profiler::Report(const Exec::Data& data,
+                                const Exec::Symbols& symbols) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    // the functions not returned from by the end of the execution
+    // (at least, the root one) are considered to be left at this point
+    while (!stack_.empty()) {
+        Leave();
+    }
+
+    // the code modified at runtime may contain the words which are not
+    // commands, in which case it is reported without the labels
+    Disassembler::Labels labels;
+    try {
+        labels.RecordSymbols(symbols, data);
+        labels.PrepareCommandLabels(data);
+    } catch (const errors::Error&) {
+        labels = Disassembler::Labels();
+    }
+
+    if (profile_) {
+        profile_->Write("instructions retired: " + std::to_string(retired_) +
+                        '\n');
+
+        ReportAddresses(data, symbols, labels);
+        ReportCodes();
+        ReportFunctions(labels);
+
+        profile_->Flush();
+    }
+
+    if (folded_stacks_) {
+        ReportFoldedStacks(labels);
+        folded_stacks_->Flush();
+    }
+
+    if (trace_) {
+        ReportTrace(symbols, labels);
+        trace_->Flush();
+    }
+}
+
+void Executor::Profiler::ReportAddresses(const Exec::Data& data,
+                                         const Exec::Symbols& symbols,
+                                         const Disassembler::Labels& labels) {
+    std::vector<std::pair<uint64_t, Address>> hot;
+    for (size_t address = 0; address < by_address_.size(); ++address) {
+        if (by_address_[address] != 0) {
+            hot.emplace_back(by_address_[address],
+                             static_cast<Address>(address));
+        }
+    }
+
+    const size_t n_hot = std::min(hot.size(), kNHotAddresses);
+
+    // the most executed addresses first, the lower addresses first
+    // among the equally executed ones
+    std::partial_sort(hot.begin(),
+                      hot.begin() + static_cast<std::ptrdiff_t>(n_hot),
+                      hot.end(),
+                      [](const auto& lhs, const auto& rhs) {
+                          if (lhs.first != rhs.first) {
+                              return lhs.first > rhs.first;
+                          }
+                          return lhs.second < rhs.second;
+                      });
+
+    // the source lines are only reported if the program has them
+    const bool with_source = !symbols.lines.empty();
+
+    std::ostringstream out;
+    out << "\nhot addresses:\n"
+        << std::setw(kCountWidth) << "count" << std::setw(kShareWidth)
+        << "share" << "  " << std::left << std::setw(kAddressWidth + 2)
+        << "address" << "  " << std::setw(kLocationWidth) << "location";
+
+    if (with_source) {
+        out << std::setw(kLocationWidth) << "command" << "source\n";
+    } else {
+        out << "command\n";
+    }
+
+    out << std::right;
+
+    for (size_t i = 0; i < n_hot; ++i) {
+        const auto [count, address] = hot[i];
+
+        // the location is the nearest label at or before the address,
+        // which is usually the function the command belongs to
+        std::string location;
+        if (address < data.code.size()) {
+            for (Address curr = address;; --curr) {
+                if (std::optional<std::string> label =
+                        labels.TryGetLabel(curr)) {
+                    location = *label;
+                    if (curr != address) {
+                        location += '+' + std::to_string(address - curr);
+                    }
+                    break;
+                }
+
+                if (curr == 0) {
+                    break;
+                }
+            }
+        }
+
+        std::string command;
+        if (address < data.code.size()) {
+            try {
+                command =
+                    Disassembler::Impl::GetCommandString(data.code[address],
+                                                         labels);
+            } catch (const errors::Error&) {
+                command = "<unknown command>";
+            }
+        } else {
+            command = "<outside the code segment>";
+        }
+
+        out << std::setw(kCountWidth) << count << std::setw(kShareWidth - 1)
+            << std::fixed << std::setprecision(2)
+            << kPercent * static_cast<double>(count) /
+                   static_cast<double>(retired_)
+            << "%  0x" << std::hex << std::setfill('0')
+            << std::setw(kAddressWidth) << address << std::dec
+            << std::setfill(' ') << "  " << std::left
+            << std::setw(kLocationWidth) << location;
+
+        if (with_source) {
+            out << std::setw(kLocationWidth) << command
+                << symbols.TryGetSourceLine(address).value_or("");
+        } else {
+            out << command;
+        }
+
+        out << '\n' << std::right;
+    }
+
+    profile_->Write(out.str());
+}
+
+void Executor::Profiler::ReportCodes() {
+    std::vector<std::pair<uint64_t, cmd::Code>> codes;
+    for (size_t code = 0; code < kNCodes; ++code) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        if (by_code_[code] != 0) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            codes.emplace_back(by_code_[code], static_cast<cmd::Code>(code));
+        }
+    }
+
+    std::sort(codes.begin(), codes.end(), std::greater<>());
+
+    std::ostringstream out;
+    out << "\ncommands:\n"
+        << std::setw(kCountWidth) << "count" << std::setw(kShareWidth)
+        << "share" << "  " << "command\n";
+
+    for (const auto& [count, code] : codes) {
+        const std::string name = cmd::kCodeToName.contains(code)
+                                     ? cmd::kCodeToName.at(code)
+                                     : "<unknown " + std::to_string(code) + ">";
+
+        out << std::setw(kCountWidth) << count << std::setw(kShareWidth - 1)
+            << std::fixed << std::setprecision(2)
+            << kPercent * static_cast<double>(count) /
+                   static_cast<double>(retired_)
+            << "%  " << name << '\n';
+    }
+
+    profile_->Write(out.str());
+}
+
+void Executor::Profiler::ReportFunctions(const Disassembler::Labels& labels) {
+    std::vector<std::pair<Address, FunctionStats>> functions(
+        functions_.begin(),
+        functions_.end());
+
+    // the functions executing the most commands themselves first
+    std::sort(functions.begin(),
+              functions.end(),
+              [](const auto& lhs, const auto& rhs) {
+                  if (lhs.second.exclusive != rhs.second.exclusive) {
+                      return lhs.second.exclusive > rhs.second.exclusive;
+                  }
+                  return lhs.first < rhs.first;
+              });
+
+    std::ostringstream out;
+    out << "\nfunctions:\n"
+        << std::setw(kCountWidth) << "calls" << std::setw(kCountWidth)
+        << "inclusive" << std::setw(kCountWidth) << "exclusive"
+        << std::setw(kCountWidth) << "inclusive ms" << std::setw(kCountWidth)
+        << "exclusive ms" << "  " << "function\n";
+
+    for (const auto& [function, stats] : functions) {
+        out << std::setw(kCountWidth) << stats.calls << std::setw(kCountWidth)
+            << stats.inclusive << std::setw(kCountWidth) << stats.exclusive
+            << std::fixed << std::setprecision(3) << std::setw(kCountWidth)
+            << Milliseconds(stats.inclusive_time).count()
+            << std::setw(kCountWidth)
+            << Milliseconds(stats.exclusive_time).count() << "  "
+            << FunctionName(labels, function) << '\n';
+    }
+
+    profile_->Write(out.str());
+}
+
+void Executor::Profiler::ReportFoldedStacks(
+    const Disassembler::Labels& labels) {
+    std::ostringstream out;
+
+    // the format is the one accepted by the flamegraph.pl script, i.e.
+    // the semicolon separated functions of a call stack followed by
+    // the number of the commands retired in its top function
+    for (const auto& [path, retired] : folded_) {
+        if (retired == 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < path.size(); ++i) {
+            out << (i == 0 ? "" : ";") << FunctionName(labels, path[i]);
+        }
+
+        out << ' ' << retired << '\n';
+    }
+
+    folded_stacks_->Write(out.str());
+}
+
+void Executor::Profiler::ReportTrace(const Exec::Symbols& symbols,
+                                     const Disassembler::Labels& labels) {
+    // the format is the JSON object format of the Trace Event Format
+    // (understood by chrome://tracing and Perfetto) with a complete event
+    // per a function call, the times are in microseconds
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+    for (size_t i = 0; i < spans_.size(); ++i) {
+        const Span& span = spans_[i];
+
+        out << (i == 0 ? "\n" : ",\n") << R"({"name":")"
+            << FunctionName(labels, span.function)
+            << R"(","cat":"karma","ph":"X","pid":1,"tid":1,"ts":)"
+            << Microseconds(span.start).count()
+            << R"(,"dur":)" << Microseconds(span.duration).count()
+            << R"(,"args":{"depth":)" << span.depth
+            << R"(,"instructions":)" << span.retired;
+
+        // the source line of the first command of the function
+        if (std::optional<std::string> line =
+                symbols.TryGetSourceLine(span.function)) {
+            out << R"(,"source":")" << EscapeJSON(*line) << '"';
+        }
+
+        out << "}}";
+
+        // do not keep the whole trace in memory twice
+        if (out.tellp() > kTraceChunkSize) {
+            trace_->Write(out.str());
+            out.str("");
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    trace_->Write(out.str());
+}
+
+}  // namespace karma
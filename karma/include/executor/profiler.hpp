@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>          // for array
+#include <chrono>         // for steady_clock
+#include <cstddef>        // for size_t
+#include <cstdint>        // for uint64_t
+#include <map>            // for map
+#include <memory>         // for shared_ptr
+#include <string>         // for string
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
+
+#include "disassembler/labels.hpp"
+#include "exec/exec.hpp"
+#include "exec/symbols.hpp"
+#include "executor/config.hpp"
+#include "executor/executor.hpp"
+#include "executor/io.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// counts the commands retired by an execution per their address and
+// per their code, and maintains the shadow call stack of the execution
+// to attribute the commands and the time to the called functions,
+// the counting is only performed by the main loop of the TableExecutor
+// class instantiated for the profiled executions, so that the executions
+// without profiling do not pay for it at all
+class Executor::Profiler : detail::utils::traits::NonCopyableMovable {
+   private:
+    using Address = detail::specs::arch::Address;
+    using Clock   = std::chrono::steady_clock;
+
+    // the command code takes the 8 most significant bits of a command
+    static constexpr size_t kNCodes = 1 << 8;
+
+    // the number of the most executed addresses listed in the report
+    static constexpr size_t kNHotAddresses = 32;
+
+    // the calls exceeding this number are not put to the trace
+    // to keep its size reasonable, the other reports are complete
+    static constexpr size_t kMaxTraceSpans = 1 << 20;
+
+   private:
+    struct Frame {
+        Address function{0};
+
+        uint64_t retired_at_entry{0};
+        uint64_t retired_by_callees{0};
+
+        Clock::time_point entered;
+        Clock::duration time_in_callees{};
+    };
+
+    struct FunctionStats {
+        uint64_t calls{0};
+
+        // the inclusive values are not accounted for the recursive calls
+        // of the function to avoid counting the same commands twice
+        uint64_t inclusive{0};
+        uint64_t exclusive{0};
+
+        Clock::duration inclusive_time{};
+        Clock::duration exclusive_time{};
+    };
+
+    struct Span {
+        Address function{0};
+        size_t depth{0};
+
+        // relative to the start of the execution
+        Clock::duration start{};
+        Clock::duration duration{};
+
+        uint64_t retired{0};
+    };
+
+   private:
+    // pops the frame of the current function and accounts for its call
+    void Leave();
+
+    static std::string FunctionName(const Disassembler::Labels&, Address);
+
+    void ReportAddresses(const Exec::Data&,
+                         const Exec::Symbols&,
+                         const Disassembler::Labels&);
+    void ReportCodes();
+    void ReportFunctions(const Disassembler::Labels&);
+    void ReportFoldedStacks(const Disassembler::Labels&);
+    void ReportTrace(const Exec::Symbols&, const Disassembler::Labels&);
+
+   public:
+    // discards the counts of the previous execution, the counting is enabled
+    // if any of the profile, folded stacks or trace devices is specified
+    // by the config of the current execution
+    void Prepare(const Config&);
+
+    [[nodiscard]] bool IsEnabled() const;
+
+    // is called once before the first command of the execution
+    // with the address of the command, which is the entry to the root
+    // function of the call stack (usually, the main function)
+    void Start(Address entry);
+
+    void Record(Address address, detail::specs::cmd::Code code) {
+        ++by_address_[address];
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        ++by_code_[code];
+        ++retired_;
+    }
+
+    // are called after the CALL or CALLI and the RET commands respectively
+    void Call(Address callee);
+    void Return();
+
+    // writes the reports to the devices, the data is expected to hold
+    // the code and the constants segments as they are at the end
+    // of the execution, so that the code modified at runtime
+    // is reported the way it was executed last, the labels and the source
+    // lines are taken from the debug info of the program if it has one
+    void Report(const Exec::Data&, const Exec::Symbols&);
+
+   private:
+    std::shared_ptr<OutputDevice> profile_;
+    std::shared_ptr<OutputDevice> folded_stacks_;
+    std::shared_ptr<OutputDevice> trace_;
+
+    // allocated only for the profiled executions
+    std::vector<uint64_t> by_address_;
+    std::array<uint64_t, kNCodes> by_code_{};
+    uint64_t retired_{0};
+
+    Clock::time_point started_;
+    std::vector<Frame> stack_;
+
+    std::unordered_map<Address, FunctionStats> functions_;
+    // the number of the frames of each function on the stack
+    std::unordered_map<Address, size_t> active_;
+
+    // the call stack from the root -> the commands retired in its top
+    // function itself (i.e. not in its callees)
+    std::map<std::vector<Address>, uint64_t> folded_;
+
+    std::vector<Span> spans_;
+};
+
+}  // namespace karma
@@ -0,0 +1,63 @@
+#include "program.hpp"
+
+#include <cstddef>   // for size_t
+#include <iostream>  // for cerr
+#include <memory>    // for make_shared
+#include <optional>  // for optional, nullopt
+#include <string>    // for string
+
+#include "compiler/impl.hpp"
+#include "executor/impl.hpp"
+#include "executor/program_image.hpp"
+#include "utils/error.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+Executor::Program Executor::Program::MustLoad(const std::string& exec_path,
+                                              Logger log) {
+    return Program(Impl::MustLoad(exec_path, log.log));
+}
+
+std::optional<Executor::Program> Executor::Program::Load(
+    const std::string& exec_path,
+    Logger log) {
+    try {
+        return MustLoad(exec_path, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return std::nullopt;
+    }
+}
+
+Executor::Program Executor::Program::MustCompile(const std::string& src,
+                                                 Logger log) {
+    return MustCompile(src, Compiler::Impl::DefaultWorkers(), log);
+}
+
+std::optional<Executor::Program> Executor::Program::Compile(
+    const std::string& src,
+    Logger log) {
+    return Compile(src, Compiler::Impl::DefaultWorkers(), log);
+}
+
+Executor::Program Executor::Program::MustCompile(const std::string& src,
+                                                 size_t n_workers,
+                                                 Logger log) {
+    return Program(std::make_shared<const ProgramImage>(
+        Compiler::Impl::MustCompile(src, n_workers, log.log)));
+}
+
+std::optional<Executor::Program> Executor::Program::Compile(
+    const std::string& src,
+    size_t n_workers,
+    Logger log) {
+    try {
+        return MustCompile(src, n_workers, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return std::nullopt;
+    }
+}
+
+}  // namespace karma
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <memory>    // for shared_ptr
+#include <optional>  // for optional
+#include <string>    // for string
+#include <utility>   // for move
+
+#include "executor.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+// a Karma executable file loaded into the memory once, which can then be
+// executed any number of times without reading the file again
+//
+// the loaded data is immutable and shared between the copies of an instance,
+// so the copies are cheap and the same program can be executed by several
+// executors (see the ExecutorPool class) concurrently
+class Executor::Program {
+   private:
+    friend class Executor::Impl;
+    friend class Executor::ProgramCache;
+
+   public:
+    static Program MustLoad(const std::string& exec_path,
+                            Logger log = Logger::NoOp());
+    static std::optional<Program> Load(const std::string& exec_path,
+                                       Logger log = Logger::NoOp());
+
+    // compile the Karma assembler program (see the Compiler class)
+    // directly into the memory without writing the executable file,
+    // the compilation errors are thrown as is
+
+    static Program MustCompile(const std::string& src,
+                               Logger log = Logger::NoOp());
+    static std::optional<Program> Compile(const std::string& src,
+                                          Logger log = Logger::NoOp());
+
+    static Program MustCompile(const std::string& src,
+                               size_t n_workers,
+                               Logger log = Logger::NoOp());
+    static std::optional<Program> Compile(const std::string& src,
+                                          size_t n_workers,
+                                          Logger log = Logger::NoOp());
+
+   private:
+    explicit Program(std::shared_ptr<const ProgramImage> image)
+        : image_(std::move(image)) {}
+
+   private:
+    std::shared_ptr<const ProgramImage> image_;
+};
+
+}  // namespace karma
@@ -0,0 +1,200 @@
+#include "program_cache.hpp"
+
+#include <sys/stat.h>  // for stat
+
+#include <cstddef>        // for size_t
+#include <cstdint>        // for int64_t
+#include <filesystem>     // for canonical, absolute
+#include <iostream>       // for cerr
+#include <list>           // for list
+#include <memory>         // for shared_ptr
+#include <mutex>          // for mutex, lock_guard
+#include <optional>       // for optional, nullopt
+#include <ostream>        // for ostream
+#include <string>         // for string
+#include <system_error>   // for error_code
+#include <unordered_map>  // for unordered_map
+
+#include "executor/impl.hpp"
+#include "executor/program.hpp"
+#include "executor/program_image.hpp"
+#include "utils/error.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+namespace {
+
+// the size and the modification time of the file, the cached program
+// is only reused while they are the same as when it was loaded
+struct Stamp {
+    size_t size{0};
+    int64_t mtime{0};
+
+    bool operator==(const Stamp&) const = default;
+};
+
+std::optional<Stamp> GetStamp(const std::string& path) {
+    struct stat file_stat {};
+    if (stat(path.c_str(), &file_stat) != 0) {
+        return std::nullopt;
+    }
+
+    constexpr int64_t kNanosecondsInSecond = 1'000'000'000;
+
+    return Stamp{
+        .size  = static_cast<size_t>(file_stat.st_size),
+        .mtime = static_cast<int64_t>(file_stat.st_mtim.tv_sec) *
+                         kNanosecondsInSecond +
+                 static_cast<int64_t>(file_stat.st_mtim.tv_nsec),
+    };
+}
+
+// the key of the cached program, the file which does not exist (anymore)
+// is identified by its normalized absolute path
+std::string GetKey(const std::string& exec_path) {
+    std::error_code error;
+    std::filesystem::path path = std::filesystem::canonical(exec_path, error);
+    if (error) {
+        path = std::filesystem::absolute(exec_path, error).lexically_normal();
+    }
+
+    return error ? exec_path : path.string();
+}
+
+}  // namespace
+
+struct Executor::ProgramCache::State {
+    struct Entry {
+        std::string key;
+        Stamp stamp;
+        std::shared_ptr<const ProgramImage> image;
+    };
+
+    using Entries = std::list<Entry>;
+
+    void Erase(const std::string& key) {
+        if (auto it = index.find(key); it != index.end()) {
+            entries.erase(it->second);
+            index.erase(it);
+        }
+    }
+
+    void Evict() {
+        while (entries.size() > capacity) {
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+
+    std::mutex mutex;
+
+    // the most recently used programs are at the front
+    Entries entries;
+    std::unordered_map<std::string, Entries::iterator> index;
+
+    size_t capacity{kDefaultCapacity};
+};
+
+Executor::ProgramCache::State& Executor::ProgramCache::GetState() {
+    // is constructed on the first use to avoid
+    // the static initialization order issues
+    static State state;
+    return state;
+}
+
+std::shared_ptr<const Executor::ProgramImage>
+Executor::ProgramCache::MustGetImage(const std::string& exec_path,
+                                     std::ostream& log) {
+    const std::string key = GetKey(exec_path);
+
+    // the file is stamped before it is read, so that the program is reloaded
+    // if the file is modified while it is being read
+    const std::optional<Stamp> stamp = GetStamp(key);
+    if (!stamp) {
+        // let reading the file report the error
+        return Impl::LoadImpl(exec_path, log);
+    }
+
+    State& state = GetState();
+
+    {
+        const std::lock_guard lock(state.mutex);
+
+        if (auto it = state.index.find(key);
+            it != state.index.end() && it->second->stamp == *stamp) {
+            state.entries.splice(state.entries.begin(),
+                                 state.entries,
+                                 it->second);
+
+            log << "[executor]: using the cached executable file\n";
+            return it->second->image;
+        }
+    }
+
+    // the file is read without holding the lock, so the loads of different
+    // files do not wait for each other
+    auto image = Impl::LoadImpl(exec_path, log);
+
+    const std::lock_guard lock(state.mutex);
+
+    state.Erase(key);
+    if (state.capacity > 0) {
+        state.entries.push_front(
+            {.key = key, .stamp = *stamp, .image = image});
+        state.index.emplace(key, state.entries.begin());
+        state.Evict();
+    }
+
+    return image;
+}
+
+Executor::Program Executor::ProgramCache::MustGet(const std::string& exec_path,
+                                                  Logger log) {
+    return Program(Impl::MustLoadCached(exec_path, log.log));
+}
+
+std::optional<Executor::Program> Executor::ProgramCache::Get(
+    const std::string& exec_path,
+    Logger log) {
+    try {
+        return MustGet(exec_path, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+        return std::nullopt;
+    }
+}
+
+void Executor::ProgramCache::Invalidate(const std::string& exec_path) {
+    State& state = GetState();
+    const std::lock_guard lock(state.mutex);
+    state.Erase(GetKey(exec_path));
+}
+
+void Executor::ProgramCache::Clear() {
+    State& state = GetState();
+    const std::lock_guard lock(state.mutex);
+    state.entries.clear();
+    state.index.clear();
+}
+
+void Executor::ProgramCache::SetCapacity(size_t capacity) {
+    State& state = GetState();
+    const std::lock_guard lock(state.mutex);
+    state.capacity = capacity;
+    state.Evict();
+}
+
+size_t Executor::ProgramCache::Capacity() {
+    State& state = GetState();
+    const std::lock_guard lock(state.mutex);
+    return state.capacity;
+}
+
+size_t Executor::ProgramCache::Size() {
+    State& state = GetState();
+    const std::lock_guard lock(state.mutex);
+    return state.entries.size();
+}
+
+}  // namespace karma
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <memory>    // for shared_ptr
+#include <optional>  // for optional
+#include <ostream>   // for ostream
+#include <string>    // for string
+
+#include "executor.hpp"
+#include "program.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+// a process-wide cache of the loaded programs, which is also used by
+// the methods of the Executor class accepting the path to the executable file,
+// so that executing the same files repeatedly does not read and verify them
+// again on each execution
+//
+// a program is cached by the canonical path of its file and is only reused
+// while the size and the modification time of the file stay the same as when
+// it was loaded, the least recently used programs are evicted once the number
+// of the cached ones exceeds the capacity
+class Executor::ProgramCache {
+   private:
+    friend class Executor::Impl;
+
+   private:
+    struct State;
+
+   public:
+    static constexpr size_t kDefaultCapacity = 64;
+
+   public:
+    // utils::traits::Static
+
+    // do not include utils/traits, because we don't want to expose
+    // internal features of the karma library to the user
+
+    ProgramCache()  = delete;
+    ~ProgramCache() = delete;
+
+    ProgramCache(const ProgramCache&)            = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    ProgramCache(ProgramCache&&)            = delete;
+    ProgramCache& operator=(ProgramCache&&) = delete;
+
+   public:
+    // the same as Program::MustLoad and Program::Load, but return
+    // the cached program if the file has not changed since it was loaded
+
+    static Program MustGet(const std::string& exec_path,
+                           Logger log = Logger::NoOp());
+    static std::optional<Program> Get(const std::string& exec_path,
+                                      Logger log = Logger::NoOp());
+
+    // drops the cached program of the file (if any), which is needed if
+    // the file may be rewritten without changing its size within
+    // the resolution of the modification time of the file system
+    static void Invalidate(const std::string& exec_path);
+    static void Clear();
+
+    // the programs are not cached at all if the capacity is zero
+    static void SetCapacity(size_t capacity);
+
+    [[nodiscard]] static size_t Capacity();
+    [[nodiscard]] static size_t Size();
+
+   private:
+    static State& GetState();
+
+    static std::shared_ptr<const ProgramImage> MustGetImage(
+        const std::string& exec_path,
+        std::ostream& log);
+};
+
+}  // namespace karma
@@ -0,0 +1,35 @@
+#include "program_image.hpp"
+
+#include <memory>   // for make_shared, shared_ptr
+#include <utility>  // for move
+
+#include "exec/exec.hpp"
+#include "executor/debug_info.hpp"
+#include "executor/decode_cache.hpp"
+#include "executor/verifier.hpp"
+
+namespace karma {
+
+Executor::ProgramImage::ProgramImage(Exec::Data data)
+    : data_(std::move(data)),
+      debug_(std::make_shared<const DebugInfo>(std::move(data_.symbols))) {
+    decoded_.Prepare(data_.code);
+
+    // verifying once per loaded program rather than per execution
+    Verifier::Verify(decoded_);
+}
+
+const Exec::Data& Executor::ProgramImage::Data() const {
+    return data_;
+}
+
+const Executor::DecodeCache& Executor::ProgramImage::Decoded() const {
+    return decoded_;
+}
+
+const std::shared_ptr<const Executor::DebugInfo>&
+Executor::ProgramImage::Debug() const {
+    return debug_;
+}
+
+}  // namespace karma
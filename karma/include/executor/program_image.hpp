@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>  // for shared_ptr
+
+#include "exec/exec.hpp"
+#include "executor/debug_info.hpp"
+#include "executor/decode_cache.hpp"
+#include "executor/executor.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the immutable data of a loaded Karma executable file, which is shared
+// by all the Program instances copied from the same loaded one and is only
+// read during the executions, so that it can be used by several executions
+// running concurrently in different threads
+class Executor::ProgramImage : detail::utils::traits::NonCopyableMovable {
+   public:
+    explicit ProgramImage(Exec::Data data);
+
+    [[nodiscard]] const Exec::Data& Data() const;
+
+    // the commands of the code segment decoded and verified (see the Verifier
+    // class) once when loading the file, which are copied to the DecodeCache
+    // of each execution
+    [[nodiscard]] const DecodeCache& Decoded() const;
+
+    // the SYMBOLS section of the data is moved here
+    // to be decoded on the first use
+    [[nodiscard]] const std::shared_ptr<const DebugInfo>& Debug() const;
+
+   private:
+    Exec::Data data_;
+    DecodeCache decoded_;
+    std::shared_ptr<const DebugInfo> debug_;
+};
+
+}  // namespace karma
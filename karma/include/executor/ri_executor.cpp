@@ -1,10 +1,5 @@
 #include "ri_executor.hpp"
 
-#include <bit>          // for bit_cast
-#include <csignal>      // for sigset_t, sigfillset, sigwait
-#include <iostream>     // for cin, cout
-#include <type_traits>  // for make_signed_t
-
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
 
@@ -18,77 +13,13 @@ arch::Word Executor::RIExecutor::ImmWord(const Args& args) {
     return static_cast<arch::Word>(args.imm);
 }
 
-// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 Executor::RIExecutor::Operation Executor::RIExecutor::HALT() {
-    return [](Args) -> MaybeReturnCode {
-        sigset_t wset{};
-        sigfillset(&wset);
-
-        int sig{};
-        sigwait(&wset, &sig);
-        return {};
-    };
+    return [this](Args) -> MaybeReturnCode { return Halt(); };
 }
 
 Executor::RIExecutor::Operation Executor::RIExecutor::SYSCALL() {
     return [this](Args args) -> MaybeReturnCode {
-        switch (auto code = static_cast<syscall::Code>(ImmWord(args))) {
-            case syscall::EXIT: {
-                return RReg(args.reg);
-            }
-
-            case syscall::SCANINT: {
-                std::make_signed_t<arch::Word> val{};
-                std::cin >> val;
-
-                WReg(args.reg) = static_cast<arch::Word>(val);
-                break;
-            }
-
-            case syscall::SCANDOUBLE: {
-                arch::Double val{};
-                std::cin >> val;
-
-                PutTwoRegisters(std::bit_cast<arch::TwoWords>(val), args.reg);
-                break;
-            }
-
-            case syscall::PRINTINT: {
-                using Int = std::make_signed_t<arch::Word>;
-                std::cout << static_cast<Int>(RReg(args.reg)) << std::flush;
-                break;
-            }
-
-            case syscall::PRINTDOUBLE: {
-                const arch::TwoWords words = GetTwoRegisters(args.reg);
-                std::cout << std::bit_cast<arch::Double>(words) << std::flush;
-                break;
-            }
-
-            case syscall::GETCHAR: {
-                syscall::Char val{};
-                std::cin >> val;
-
-                WReg(args.reg) = static_cast<arch::Word>(val);
-                break;
-            }
-
-            case syscall::PUTCHAR: {
-                if (RReg(args.reg) > syscall::kMaxChar) {
-                    throw ExecutionError::InvalidPutCharValue(RReg(args.reg));
-                }
-
-                std::cout << static_cast<syscall::Char>(RReg(args.reg))
-                          << std::flush;
-                break;
-            }
-
-            default: {
-                throw ExecutionError::UnknownSyscallCode(code);
-            }
-        }
-
-        return {};
+        return Syscall(args.reg, static_cast<syscall::Code>(ImmWord(args)));
     };
 }
 
@@ -4,7 +4,6 @@
 #include <unordered_map>  // for unordered_map
 
 #include "executor/common_executor.hpp"
-#include "executor/errors.hpp"
 #include "executor/executor.hpp"
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
@@ -13,8 +12,6 @@ namespace karma {
 
 class Executor::RIExecutor : public CommonExecutor {
    private:
-    using ExecutionError = errors::executor::ExecutionError::Builder;
-
     using Args      = detail::specs::cmd::args::RIArgs;
     using Operation = std::function<MaybeReturnCode(Args)>;
 
@@ -1,7 +1,8 @@
 #include "rr_executor.hpp"
 
-#include <bit>    // for bit_cast
-#include <cmath>  // for floor
+#include <atomic>  // for atomic_ref
+#include <bit>     // for bit_cast
+#include <cmath>   // for floor
 
 #include "specs/architecture.hpp"
 #include "specs/commands.hpp"
@@ -221,6 +222,71 @@ Executor::RRExecutor::Operation Executor::RRExecutor::CALL() {
     };
 }
 
+Executor::RRExecutor::Operation Executor::RRExecutor::CAS() {
+    return [this](Args args) -> MaybeReturnCode {
+        std::atomic_ref<arch::Word> word = AMem(RHSWord(args));
+
+        const arch::Word expected = LHSWord(args);
+        arch::Word actual         = expected;
+
+        // the actual value is written to the expected one if they differ
+        word.compare_exchange_strong(actual, RReg(args.recv + 1));
+
+        WriteComparisonToFlags(actual, expected);
+        WReg(args.recv) = actual;
+        return {};
+    };
+}
+
+Executor::RRExecutor::Operation Executor::RRExecutor::XADD() {
+    return [this](Args args) -> MaybeReturnCode {
+        std::atomic_ref<arch::Word> word = AMem(RHSWord(args));
+
+        WReg(args.recv) = word.fetch_add(LHSWord(args));
+        return {};
+    };
+}
+
+Executor::RRExecutor::Operation Executor::RRExecutor::MCOPY() {
+    return [this](Args args) -> MaybeReturnCode {
+        const args::Address dst = LHSWord(args);
+        const args::Address src = RHSWord(args);
+
+        CopyMemory(dst, src, RReg(args.recv + 1));
+        return {};
+    };
+}
+
+Executor::RRExecutor::Operation Executor::RRExecutor::MFILL() {
+    return [this](Args args) -> MaybeReturnCode {
+        const args::Address dst = LHSWord(args);
+        const arch::Word value  = RHSWord(args);
+
+        FillMemory(dst, value, RReg(args.recv + 1));
+        return {};
+    };
+}
+
+Executor::RRExecutor::Operation Executor::RRExecutor::MCMP() {
+    return [this](Args args) -> MaybeReturnCode {
+        const args::Address lhs = LHSWord(args);
+        const args::Address rhs = RHSWord(args);
+
+        CompareMemory(lhs, rhs, RReg(args.recv + 1));
+        return {};
+    };
+}
+
+Executor::RRExecutor::Operation Executor::RRExecutor::MFIND() {
+    return [this](Args args) -> MaybeReturnCode {
+        const args::Address begin = LHSWord(args);
+        const arch::Word value    = RHSWord(args);
+
+        WReg(args.recv) = FindInMemory(begin, value, RReg(args.recv + 1));
+        return {};
+    };
+}
+
 Executor::RRExecutor::Map Executor::RRExecutor::GetMap() {
     return {
         {cmd::ADD,     ADD()    },
@@ -246,6 +312,12 @@ Executor::RRExecutor::Map Executor::RRExecutor::GetMap() {
         {cmd::STORER,  STORER() },
         {cmd::STORER2, STORER2()},
         {cmd::CALL,    CALL()   },
+        {cmd::CAS,     CAS()    },
+        {cmd::XADD,    XADD()   },
+        {cmd::MCOPY,   MCOPY()  },
+        {cmd::MFILL,   MFILL()  },
+        {cmd::MCMP,    MCMP()   },
+        {cmd::MFIND,   MFIND()  },
     };
 }
 
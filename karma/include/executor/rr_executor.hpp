@@ -49,6 +49,12 @@ class Executor::RRExecutor : public CommonExecutor {
     Operation STORER();
     Operation STORER2();
     Operation CALL();
+    Operation CAS();
+    Operation XADD();
+    Operation MCOPY();
+    Operation MFILL();
+    Operation MCMP();
+    Operation MFIND();
 
    public:
     using Map = std::unordered_map<detail::specs::cmd::Code, Operation>;
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>   // for shared_ptr
+#include <utility>  // for move
+
+#include "executor.hpp"
+
+namespace karma {
+
+// the complete state of the Karma computer (the registers, the flags,
+// the memory and the position of the input) captured at the snapshot point
+// of an execution, i.e. at the SNAPSHOT system call (see Executor::Capture)
+//
+// the captured state is immutable and shared between the copies
+// of an instance, the executions resumed from it map the captured memory
+// copy-on-write, so only the pages they write to are copied
+class Executor::Snapshot {
+   private:
+    friend class Executor::Impl;
+
+   private:
+    explicit Snapshot(std::shared_ptr<const SnapshotImage> image)
+        : image_(std::move(image)) {}
+
+   private:
+    std::shared_ptr<const SnapshotImage> image_;
+};
+
+}  // namespace karma
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>    // for array
+#include <cstddef>  // for size_t
+#include <memory>   // for shared_ptr
+
+#include "executor/config.hpp"
+#include "executor/debug_info.hpp"
+#include "executor/decode_cache.hpp"
+#include "executor/executor.hpp"
+#include "executor/io.hpp"
+#include "executor/paged_memory.hpp"
+#include "specs/architecture.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the complete state of the Karma computer captured at the snapshot point
+// of an execution (see the SNAPSHOT system call), which is never modified
+// after the capture, so that any number of executions (including concurrent
+// ones) can be resumed from it
+struct Executor::SnapshotImage : detail::utils::traits::NonCopyableMovable {
+    // the config of the captured execution without the devices,
+    // because the devices cannot be shared by the resumed executions
+    Config config;
+
+    size_t code_end{0};
+    size_t constants_end{0};
+    detail::specs::arch::Address entrypoint{0};
+
+    // the debug info of the program of the captured execution
+    std::shared_ptr<const DebugInfo> debug;
+
+    std::array<detail::specs::arch::Word, detail::specs::arch::kNRegisters>
+        registers{};
+    detail::specs::arch::Word flags{0};
+
+    std::shared_ptr<const PagedMemory::Image> memory;
+
+    // the commands modified before the snapshot point are not cached,
+    // so the cache is captured as well rather than taken from the program
+    DecodeCache decoded;
+
+    // the fork of the input device of the captured execution positioned
+    // after the input read before the snapshot point (see the InputDevice
+    // class), or nullptr if the device does not support forking
+    std::shared_ptr<const InputDevice> input;
+};
+
+}  // namespace karma
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>   // for nanoseconds
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint32_t, uint64_t
+#include <map>      // for map
+
+#include "executor.hpp"
+
+namespace karma {
+
+// the statistics of a single execution, which are always collected
+// and are stored to the object specified by Config::SetStats
+// after the execution is finished (including with an error)
+struct Executor::ExecutionStats {
+    struct Time {
+        std::chrono::nanoseconds wall{0};
+        std::chrono::nanoseconds cpu{0};
+    };
+
+    // the number of the executed commands and its split by the command format
+    uint64_t instructions{0};
+    uint64_t rm_instructions{0};
+    uint64_t rr_instructions{0};
+    uint64_t ri_instructions{0};
+    uint64_t j_instructions{0};
+
+    uint64_t calls{0};
+    uint64_t returns{0};
+
+    // the number of the calls run natively (see Config::SetIntrinsics),
+    // the commands of such calls are not executed and thus not counted
+    uint64_t intrinsic_calls{0};
+
+    // the number of the words read from and written to the memory
+    // by the commands (including the stack operations)
+    uint64_t memory_reads{0};
+    uint64_t memory_writes{0};
+
+    // system call code -> the number of its calls
+    std::map<uint32_t, uint64_t> syscalls;
+
+    // the number of the values read by the input system calls
+    // and the number of the bytes printed by the output ones
+    uint64_t input_values{0};
+    uint64_t output_bytes{0};
+
+    // the maximum number of the words the stack has occupied
+    // and the maximum allowed one (see Config::BoundStack)
+    size_t max_stack_depth{0};
+    size_t max_stack_size{0};
+
+    // reading the executable file (zero for the executions of an already
+    // loaded Program or Snapshot), preparing the Karma computer for
+    // the execution and executing the commands respectively
+    Time load;
+    Time setup;
+    Time run;
+};
+
+}  // namespace karma
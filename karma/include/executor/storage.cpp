@@ -1,34 +1,509 @@
 #include "storage.hpp"
 
-#include <ostream>  // for ostream
+#include <algorithm>  // for max, min
+#include <atomic>     // for atomic_ref
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint16_t, uint8_t, uint64_t
+#include <exception>  // for rethrow_exception
+#include <memory>     // for shared_ptr, make_shared
+#include <mutex>      // for mutex, unique_lock
+#include <optional>   // for optional
+#include <ostream>    // for ostream
+#include <span>       // for span
+#include <string>     // for string
+#include <vector>     // for vector
 
 #include "exec/exec.hpp"
+#include "exec/symbols.hpp"
 #include "executor/config.hpp"
+#include "executor/debug_info.hpp"
+#include "executor/decode_cache.hpp"
+#include "executor/io.hpp"
+#include "executor/output_buffer.hpp"
+#include "executor/paged_memory.hpp"
+#include "executor/profiler.hpp"
+#include "executor/program_image.hpp"
+#include "executor/snapshot_image.hpp"
+#include "executor/stats.hpp"
+#include "executor/threads.hpp"
 #include "specs/architecture.hpp"
-#include "utils/vector.hpp"
+#include "specs/commands.hpp"
 
 namespace karma {
 
-namespace utils = detail::utils;
-namespace arch  = detail::specs::arch;
+namespace arch = detail::specs::arch;
+namespace cmd  = detail::specs::cmd;
+
+Executor::Storage::Storage(Storage& spawning,
+                           Threads::Id id,
+                           arch::Address entry,
+                           arch::Address stack)
+    : base_config_(spawning.curr_config_),
+      masks_(spawning.masks_),
+      permissive_(spawning.permissive_),
+      memory_(spawning.memory_.Share()),
+      curr_code_end_(spawning.curr_code_end_),
+      curr_constants_end_(spawning.curr_constants_end_),
+      curr_entrypoint_(spawning.curr_entrypoint_),
+      debug_(spawning.debug_),
+      registers_(spawning.registers_),
+      flags_(spawning.flags_),
+      main_(&spawning.Main()),
+      thread_id_(id),
+      code_writes_read_(spawning.code_writes_read_),
+      input_(spawning.input_),
+      stop_at_snapshot_(spawning.stop_at_snapshot_),
+      sliced_(spawning.sliced_) {
+    // the code modified by the other threads after the spawning one has
+    // synchronized with them last is invalidated once the thread starts
+    decode_cache_.Prepare(spawning.decode_cache_);
+
+    registers_.at(arch::kCallFrameRegister)   = stack;
+    registers_.at(arch::kStackRegister)       = stack;
+    registers_.at(arch::kInstructionRegister) = entry;
+
+    // the first push writes to the stack address
+    stack_end_ = static_cast<size_t>(stack) + 1;
+    min_stack_address_ =
+        stack_end_ - std::min(stack_end_, curr_config_.MaxStackSize());
+    lowest_stack_address_ = stack_end_;
+
+    stats_.max_stack_size = curr_config_.MaxStackSize();
+}
+
+void Executor::Storage::PrepareConfig(const Config& config,
+                                      std::ostream& log) {
+    // the threads of the previous execution may still be paused
+    // if it has been run in the slices and has not been finished
+    StopThreads();
 
-void Executor::Storage::PrepareForExecution(const Exec::Data& exec_data,
-                                            const Config& config,
-                                            std::ostream& log) {
     curr_config_ = base_config_ & config;
+    PrepareAccessMasks();
 
     log << "[executor]: current execution config:\n" << curr_config_ << '\n';
 
-    utils::vector::CopyToBegin(memory_, exec_data.code, exec_data.constants);
+    input_ = curr_config_.GetInput();
+    output_.Prepare(curr_config_.GetOutput(),
+                    curr_config_.GetOutputBuffering(),
+                    curr_config_.OutputBufferSize());
+
+    profiler_.Prepare(curr_config_);
+
+    stats_                = {};
+    stats_.max_stack_size = curr_config_.MaxStackSize();
+    retired_.fill(0);
+
+    min_stack_address_    = curr_config_.MinStackAddress();
+    stack_end_            = arch::kMemorySize;
+    lowest_stack_address_ = arch::kMemorySize;
+
+    failed_at_.reset();
+
+    stop_at_snapshot_ = false;
+    snapshot_reached_ = false;
+
+    sliced_       = false;
+    fuel_         = 0;
+    interruption_ = NOT_INTERRUPTED;
+}
+
+void Executor::Storage::PrepareForExecution(const ProgramImage& image,
+                                            const Config& config,
+                                            std::ostream& log) {
+    const Exec::Data& exec_data = image.Data();
+
+    PrepareConfig(config, log);
+
+    // the previous execution could have left its data anywhere,
+    // so the machine is reset to its initial state
+    memory_.Reset(exec_data.code, exec_data.constants);
+    memory_.AdviseHugePages(curr_config_.UsesHugePages());
     curr_code_end_      = exec_data.code.size();
     curr_constants_end_ = curr_code_end_ + exec_data.constants.size();
+    curr_entrypoint_    = exec_data.entrypoint;
+    debug_              = image.Debug();
+    PrepareBlockedRanges();
+
+    decode_cache_.Prepare(image.Decoded());
+    PrepareIntrinsics();
+
+    registers_.fill(0);
+    flags_ = 0;
 
     registers_.at(arch::kCallFrameRegister)   = exec_data.initial_stack;
     registers_.at(arch::kStackRegister)       = exec_data.initial_stack;
     registers_.at(arch::kInstructionRegister) = exec_data.entrypoint;
 }
 
-void Executor::Storage::CheckPushAllowed() const {
+void Executor::Storage::PrepareForExecution(const SnapshotImage& image,
+                                            const Config& config,
+                                            std::ostream& log) {
+    // the blocks of the captured execution stay in effect
+    Config resumed_config = image.config;
+    resumed_config &= config;
+
+    PrepareConfig(resumed_config, log);
+
+    // the input is continued from the snapshot point
+    // unless another device is explicitly specified
+    if (!curr_config_.InputIsSet() && image.input) {
+        input_ = image.input->Fork();
+    }
+
+    memory_.Restore(*image.memory);
+    memory_.AdviseHugePages(curr_config_.UsesHugePages());
+    curr_code_end_      = image.code_end;
+    curr_constants_end_ = image.constants_end;
+    curr_entrypoint_    = image.entrypoint;
+    debug_              = image.debug;
+    PrepareBlockedRanges();
+
+    decode_cache_.Prepare(image.decoded);
+    PrepareIntrinsics();
+
+    registers_ = image.registers;
+    flags_     = image.flags;
+}
+
+void Executor::Storage::StopAtSnapshot() {
+    stop_at_snapshot_ = true;
+}
+
+bool Executor::Storage::ReachSnapshot() {
+    // the snapshot image only holds the registers of a single thread
+    if (stop_at_snapshot_ && IsMultithreaded()) {
+        throw ExecutionError::MultithreadedSnapshot();
+    }
+
+    snapshot_reached_ = stop_at_snapshot_;
+    return snapshot_reached_;
+}
+
+bool Executor::Storage::SnapshotReached() const {
+    return snapshot_reached_;
+}
+
+void Executor::Storage::StartSlice(uint64_t fuel) {
+    sliced_       = true;
+    fuel_         = fuel;
+    interruption_ = NOT_INTERRUPTED;
+}
+
+bool Executor::Storage::IsSliced() const {
+    return sliced_;
+}
+
+bool Executor::Storage::IsFueled() const {
+    return sliced_ || IsMultithreaded();
+}
+
+uint64_t& Executor::Storage::Fuel() {
+    return fuel_;
+}
+
+void Executor::Storage::Interrupt(Interruption interruption) {
+    interruption_ = interruption;
+}
+
+Executor::Storage::Interruption Executor::Storage::GetInterruption() const {
+    return interruption_;
+}
+
+bool Executor::Storage::IsMultithreaded() const {
+    return main_ != nullptr || threads_.IsMultithreaded();
+}
+
+Executor::Threads::Id Executor::Storage::Spawn(arch::Address entry,
+                                               arch::Address stack) {
+    return Main().threads_.Spawn([&](Threads::Id id) {
+        return std::make_shared<Storage>(*this, id, entry, stack);
+    });
+}
+
+std::optional<arch::Word> Executor::Storage::TryJoin(Threads::Id id) {
+    return Main().threads_.TryJoin(thread_id_, id);
+}
+
+bool Executor::Storage::StartTurn() {
+    if (main_ == nullptr) {
+        ThrowThreadError();
+    }
+
+    const std::optional<uint64_t> fuel =
+        Main().threads_.StartTurn(thread_id_);
+    if (!fuel) {
+        return false;
+    }
+
+    fuel_         = *fuel;
+    interruption_ = NOT_INTERRUPTED;
+    return true;
+}
+
+void Executor::Storage::EndTurn() {
+    // the thread may wait for the others to see its writes
+    PublishCodeWrites();
+    Main().threads_.EndTurn(fuel_);
+}
+
+void Executor::Storage::Wait() {
+    Main().threads_.Wait(thread_id_);
+}
+
+bool Executor::Storage::Synchronize() {
+    if (!IsMultithreaded()) {
+        return true;
+    }
+
+    Threads& threads = Main().threads_;
+    if (threads.Stopped()) {
+        return false;
+    }
+
+    PublishCodeWrites();
+    code_writes_read_ = threads.ReadCodeWrites(code_writes_read_, decode_cache_);
+    return true;
+}
+
+bool Executor::Storage::Stopped() const {
+    return main_ != nullptr ? main_->threads_.Stopped() : threads_.Stopped();
+}
+
+void Executor::Storage::Exit() {
+    if (main_ == nullptr && threads_.IsMultithreaded()) {
+        threads_.Cancel();
+    }
+}
+
+void Executor::Storage::ResumeThreads() {
+    threads_.Resume(sliced_, fuel_);
+}
+
+void Executor::Storage::PauseThreads() {
+    const std::shared_ptr<const Storage> blocked = threads_.Pause();
+    ThrowThreadError();
+
+    // the main thread blocked by itself takes precedence
+    if (interruption_ == HALTED || interruption_ == BLOCKED_ON_INPUT) {
+        return;
+    }
+
+    interruption_ = blocked ? blocked->interruption_ : OUT_OF_FUEL;
+}
+
+void Executor::Storage::StopThreads() {
+    const std::vector<std::shared_ptr<Storage>> stopped = threads_.Stop();
+    if (stopped.empty()) {
+        return;
+    }
+
+    for (const std::shared_ptr<Storage>& thread : stopped) {
+        memory_.Merge(thread->memory_);
+        AddStats(*thread);
+    }
+
+    // the code segment writes are counted anew by the next execution
+    code_writes_.clear();
+    code_writes_read_ = 0;
+
+    // the output may be printed by the spawned threads
+    // after the main one has failed
+    output_.Flush();
+}
+
+std::unique_lock<std::mutex> Executor::Storage::LockDevices() {
+    if (!IsMultithreaded()) {
+        return {};
+    }
+
+    return std::unique_lock(Main().threads_.Devices());
+}
+
+arch::Address Executor::Storage::FailedAddress() const {
+    // all the engines advance the instruction register before executing
+    // a command, so the failed command is the one preceding it
+    return failed_at_.value_or(registers_.at(arch::kInstructionRegister) - 1);
+}
+
+Executor::Storage& Executor::Storage::Main() {
+    return main_ != nullptr ? *main_ : *this;
+}
+
+void Executor::Storage::ThrowThreadError() {
+    auto [error, address] = threads_.Error();
+    if (error) {
+        failed_at_ = address;
+        std::rethrow_exception(error);
+    }
+}
+
+void Executor::Storage::AddStats(const Storage& thread) {
+    const ExecutionStats& stats = thread.stats_;
+
+    stats_.calls += stats.calls;
+    stats_.returns += stats.returns;
+    stats_.intrinsic_calls += stats.intrinsic_calls;
+    stats_.memory_reads += stats.memory_reads;
+    stats_.memory_writes += stats.memory_writes;
+    stats_.input_values += stats.input_values;
+
+    for (const auto& [code, count] : stats.syscalls) {
+        stats_.syscalls[code] += count;
+    }
+
+    // the depth of the stack of each thread is measured
+    // from the address it has been spawned with
+    stats_.max_stack_depth =
+        std::max<size_t>(stats_.max_stack_depth,
+                         thread.stack_end_ - thread.lowest_stack_address_);
+
+    for (size_t code = 0; code < retired_.size(); ++code) {
+        retired_.at(code) += thread.retired_.at(code);
+    }
+}
+
+std::shared_ptr<const Executor::SnapshotImage> Executor::Storage::Capture()
+    const {
+    auto image = std::make_shared<SnapshotImage>();
+
+    image->config = curr_config_;
+    image->config.SetInput(nullptr);
+    image->config.SetOutput(nullptr);
+    image->config.SetProfile(nullptr);
+    image->config.SetFoldedStacks(nullptr);
+    image->config.SetTrace(nullptr);
+    image->config.SetStats(nullptr);
+
+    image->code_end      = curr_code_end_;
+    image->constants_end = curr_constants_end_;
+    image->entrypoint    = curr_entrypoint_;
+    image->debug         = debug_;
+
+    image->registers = registers_;
+    image->flags     = flags_;
+
+    image->memory = memory_.Capture();
+    image->decoded.Prepare(decode_cache_);
+    image->input = input_->Fork();
+
+    return image;
+}
+
+void Executor::Storage::PrepareAccessMasks() {
+    masks_ = {};
+
+    for (arch::Register reg = 0; reg < arch::kNRegisters; ++reg) {
+        const auto bit = static_cast<uint16_t>(1U << reg);
+
+        if (curr_config_.RegisterIsWriteBlocked(reg)) {
+            masks_.write_blocked_registers |= bit;
+        }
+
+        if (curr_config_.RegisterIsReadWriteBlocked(reg)) {
+            masks_.read_write_blocked_registers |= bit;
+        }
+    }
+
+    masks_.code_write_blocked = curr_config_.CodeSegmentIsWriteBlocked();
+    masks_.code_read_write_blocked =
+        curr_config_.CodeSegmentIsReadWriteBlocked();
+    masks_.constants_read_write_blocked =
+        curr_config_.ConstantsSegmentIsReadWriteBlocked();
+
+    // the constants segment write block is not checked separately,
+    // because the WMem method checks the code segment write block for it
+    permissive_ = masks_.write_blocked_registers == 0 &&
+                  masks_.read_write_blocked_registers == 0 &&
+                  !masks_.code_write_blocked &&
+                  !masks_.code_read_write_blocked &&
+                  !masks_.constants_read_write_blocked;
+}
+
+Executor::Config::Engine Executor::Storage::GetEngine() const {
+    return curr_config_.GetEngine();
+}
+
+bool Executor::Storage::IsPermissive() const {
+    return permissive_;
+}
+
+void Executor::Storage::PrepareBlockedRanges() {
+    // the blocked segments are adjacent, so if both are blocked,
+    // the range spans from the start of the code to the end of the constants
+    size_t read_begin = curr_code_end_;
+    size_t read_end   = curr_code_end_;
+
+    if (masks_.code_read_write_blocked) {
+        read_begin = 0;
+    }
+
+    if (masks_.constants_read_write_blocked) {
+        read_end = curr_constants_end_;
+    }
+
+    masks_.read_blocked_begin = read_begin;
+    masks_.read_blocked_size  = read_end - read_begin;
+
+    // the code segment write block also covers the constants
+    // (see the PrepareAccessMasks method)
+    masks_.write_blocked_begin = 0;
+    masks_.write_blocked_size =
+        masks_.code_write_blocked ? curr_constants_end_ : 0;
+}
+
+void Executor::Storage::PrepareIntrinsics() {
+    intrinsics_ = nullptr;
+
+    // the profiled executions report the routines as they are interpreted,
+    // and the routines of a snapshot whose code has been modified are not
+    // necessarily the ones found in the initial code
+    if (!curr_config_.UsesIntrinsics() || profiler_.IsEnabled() || !debug_ ||
+        decode_cache_.Modified()) {
+        return;
+    }
+
+    // the interpreted routines use the general purpose registers and read
+    // the stack register and the constants of the library, so they fail
+    // under such access blocks, which are left for them to report
+    for (arch::Register reg = 0; reg < arch::kCallFrameRegister; ++reg) {
+        if (!CanRReg(reg) || !CanWReg(reg)) {
+            return;
+        }
+    }
+
+    if (!CanRReg(arch::kStackRegister) ||
+        masks_.constants_read_write_blocked) {
+        return;
+    }
+
+    const Word* data = memory_.Data();
+    const Intrinsics& intrinsics = debug_->Intrinsics(
+        {data, curr_code_end_},
+        {data + curr_code_end_, curr_constants_end_ - curr_code_end_},
+        curr_entrypoint_);
+
+    // the calls are not checked at all for the programs without the library
+    if (!intrinsics.Empty()) {
+        intrinsics_ = &intrinsics;
+    }
+}
+
+void Executor::Storage::InvalidateCode(arch::Address address, size_t size) {
+    decode_cache_.Invalidate(address, size);
+
+    if (IsMultithreaded()) {
+        code_writes_.emplace_back(address, size);
+    }
+}
+
+void Executor::Storage::PublishCodeWrites() {
+    if (!code_writes_.empty()) {
+        Main().threads_.WriteCode(code_writes_);
+        code_writes_.clear();
+    }
+}
+
+void Executor::Storage::ThrowPushNotAllowed() const {
     const arch::Address curr_stack_address =
         registers_.at(arch::kStackRegister);
 
@@ -38,76 +513,322 @@ void Executor::Storage::CheckPushAllowed() const {
         throw ExecutionError::StackPointerOutOfMemory(curr_stack_address);
     }
 
-    if (curr_stack_address < curr_config_.MinStackAddress()) {
-        throw ExecutionError::StackOverflow(curr_config_.MaxStackSize());
+    throw ExecutionError::StackOverflow(curr_config_.MaxStackSize());
+}
+
+void Executor::Storage::ThrowSegmentBlocked(arch::Address address) const {
+    if (address < curr_code_end_) {
+        throw ExecutionError::CodeSegmentBlocked(address);
     }
+
+    throw ExecutionError::ConstantsSegmentBlocked(address);
 }
 
 arch::Word Executor::Storage::RReg(arch::Register reg,
                                    bool internal_usage) const {
-    if (reg >= arch::kNRegisters) {
-        throw ExecutionError::InvalidRegister(reg);
-    }
-
-    if (!internal_usage && curr_config_.RegisterIsReadWriteBlocked(reg)) {
-        throw ExecutionError::RegisterIsBlocked(reg);
+    if (permissive_) {
+        return RReg<Permissive>(reg, internal_usage);
     }
 
-    return registers_.at(reg);
+    return RReg<Restricted>(reg, internal_usage);
 }
 
 arch::Word Executor::Storage::RMem(arch::Address address,
                                    bool internal_usage) const {
-    if (address >= arch::kMemorySize) {
-        throw ExecutionError::AddressOutOfMemory(address);
+    if (permissive_) {
+        return RMem<Permissive>(address, internal_usage);
     }
 
-    if (!internal_usage && curr_config_.CodeSegmentIsReadWriteBlocked() &&
-        address < curr_code_end_) {
-        throw ExecutionError::CodeSegmentBlocked(address);
+    return RMem<Restricted>(address, internal_usage);
+}
+
+arch::Word& Executor::Storage::WReg(arch::Register reg, bool internal_usage) {
+    if (permissive_) {
+        return WReg<Permissive>(reg, internal_usage);
     }
 
-    if (!internal_usage && curr_config_.ConstantsSegmentIsReadWriteBlocked() &&
-        address >= curr_code_end_ && address < curr_constants_end_) {
-        throw ExecutionError::ConstantsSegmentBlocked(address);
+    return WReg<Restricted>(reg, internal_usage);
+}
+
+Executor::PagedMemory::SharedWord Executor::Storage::WMem(
+    arch::Address address,
+    bool internal_usage) {
+    if (permissive_) {
+        return WMem<Permissive>(address, internal_usage);
     }
 
-    return memory_.at(address);
+    return WMem<Restricted>(address, internal_usage);
 }
 
-arch::Word& Executor::Storage::WReg(arch::Register reg, bool internal_usage) {
-    if (reg >= arch::kNRegisters) {
-        throw ExecutionError::InvalidRegister(reg);
+std::atomic_ref<arch::Word> Executor::Storage::AMem(arch::Address address) {
+    if (permissive_) {
+        return AMem<Permissive>(address);
+    }
+
+    return AMem<Restricted>(address);
+}
+
+void Executor::Storage::CheckRange(arch::Address address,
+                                   size_t size,
+                                   size_t blocked_begin,
+                                   size_t blocked_size) const {
+    const size_t end = static_cast<size_t>(address) + size;
+
+    if (end > arch::kMemorySize) {
+        // the first address of the range out of the memory
+        throw ExecutionError::AddressOutOfMemory(
+            std::max<arch::Address>(address, arch::kMemorySize));
     }
 
-    if (!internal_usage && curr_config_.RegisterIsWriteBlocked(reg)) {
-        throw ExecutionError::RegisterIsBlocked(reg);
+    if (permissive_) {
+        return;
     }
 
-    return registers_.at(reg);
+    // the first blocked address of the range (if any)
+    const size_t first = std::max(static_cast<size_t>(address), blocked_begin);
+    if (first < std::min(end, blocked_begin + blocked_size)) {
+        ThrowSegmentBlocked(static_cast<arch::Address>(first));
+    }
 }
 
-arch::Word& Executor::Storage::WMem(arch::Address address,
-                                    bool internal_usage) {
-    if (address >= arch::kMemorySize) {
-        throw ExecutionError::AddressOutOfMemory(address);
+const arch::Word* Executor::Storage::RMemRange(arch::Address address,
+                                               Word size) {
+    if (size == 0) {
+        return memory_.Data();
     }
 
-    if (!internal_usage && curr_config_.CodeSegmentIsWriteBlocked() &&
-        address < curr_code_end_) {
-        throw ExecutionError::CodeSegmentBlocked(address);
+    CheckRange(address,
+               size,
+               masks_.read_blocked_begin,
+               masks_.read_blocked_size);
+
+    stats_.memory_reads += size;
+
+    return memory_.Data() + address;
+}
+
+arch::Word* Executor::Storage::WMemRange(arch::Address address, Word size) {
+    if (size == 0) {
+        return memory_.Data();
     }
 
-    if (!internal_usage && curr_config_.CodeSegmentIsWriteBlocked() &&
-        address >= curr_code_end_ && address < curr_constants_end_) {
-        throw ExecutionError::ConstantsSegmentBlocked(address);
+    CheckRange(address,
+               size,
+               masks_.write_blocked_begin,
+               masks_.write_blocked_size);
+
+    stats_.memory_writes += size;
+
+    if (address < curr_code_end_) {
+        InvalidateCode(address, size);
     }
 
-    return memory_.at(address);
+    memory_.MarkDirty(address, size);
+
+    return memory_.Data() + address;
 }
 
 arch::Word& Executor::Storage::Flags() {
     return flags_;
 }
 
+Executor::InputDevice& Executor::Storage::Input() {
+    return *input_;
+}
+
+Executor::OutputBuffer& Executor::Storage::Output() {
+    return Main().output_;
+}
+
+Executor::Profiler& Executor::Storage::Profile() {
+    return profiler_;
+}
+
+void Executor::Storage::ReportProfile() {
+    if (!profiler_.IsEnabled()) {
+        return;
+    }
+
+    Exec::Data data;
+    data.entrypoint = curr_entrypoint_;
+
+    for (size_t address = 0; address < curr_code_end_; ++address) {
+        data.code.push_back(memory_.Read(static_cast<arch::Address>(address)));
+    }
+
+    for (size_t address = curr_code_end_; address < curr_constants_end_;
+         ++address) {
+        data.constants.push_back(
+            memory_.Read(static_cast<arch::Address>(address)));
+    }
+
+    profiler_.Report(data, debug_->Symbols());
+}
+
+std::optional<std::string> Executor::Storage::TryDescribe(
+    arch::Address address) const {
+    return debug_->TryDescribe(address);
+}
+
+Executor::ExecutionStats& Executor::Storage::Stats() {
+    return stats_;
+}
+
+Executor::Storage::RetiredCommands& Executor::Storage::Retired() {
+    return retired_;
+}
+
+void Executor::Storage::FinishStats(const ExecutionStats::Time& run) {
+    stats_.run          = run;
+    stats_.output_bytes = output_.BytesWritten();
+
+    // the stack depth is measured in the same way as the stack size
+    // is bounded, i.e. from the end of the memory (see also AddStats)
+    stats_.max_stack_depth = std::max<size_t>(
+        stats_.max_stack_depth, stack_end_ - lowest_stack_address_);
+
+    for (size_t code = 0; code < retired_.size(); ++code) {
+        const uint64_t count = retired_.at(code);
+        if (count == 0) {
+            continue;
+        }
+
+        stats_.instructions += count;
+
+        const auto cmd_code = static_cast<cmd::Code>(code);
+        if (!cmd::kCodeToFormat.contains(cmd_code)) {
+            continue;
+        }
+
+        switch (cmd::kCodeToFormat.at(cmd_code)) {
+            case cmd::RM: {
+                stats_.rm_instructions += count;
+                break;
+            }
+
+            case cmd::RR: {
+                stats_.rr_instructions += count;
+                break;
+            }
+
+            case cmd::RI: {
+                stats_.ri_instructions += count;
+                break;
+            }
+
+            case cmd::J: {
+                stats_.j_instructions += count;
+                break;
+            }
+        }
+    }
+
+    if (const std::shared_ptr<ExecutionStats> stats = curr_config_.GetStats()) {
+        *stats = stats_;
+    }
+}
+
+Executor::DecodeCache::Instruction Executor::Storage::Fetch(
+    arch::Address address) {
+    if (decode_cache_.Contains(address)) {
+        return decode_cache_.Get(address);
+    }
+
+    const DecodeCache::Instruction instr =
+        DecodeCache::Decode(RMem(address, true));
+    decode_cache_.Put(address, instr);
+
+    return instr;
+}
+
+size_t Executor::Storage::BlockLength(arch::Address address) const {
+    return decode_cache_.BlockLength(address);
+}
+
+const std::vector<uint8_t>* Executor::Storage::CodeLeaders() const {
+    return decode_cache_.Modified() ? nullptr : &decode_cache_.Leaders();
+}
+
+size_t Executor::Storage::CodeSegmentSize() const {
+    return curr_code_end_;
+}
+
+uint64_t Executor::Storage::CodeGeneration() const {
+    return decode_cache_.Generation();
+}
+
+std::optional<std::span<const arch::Address>>
+Executor::Storage::InvalidatedCodeSince(uint64_t generation) const {
+    return decode_cache_.InvalidatedSince(generation);
+}
+
+bool Executor::Storage::CanRReg(arch::Register reg) const {
+    return reg < arch::kNRegisters &&
+           !IsBlocked(masks_.read_write_blocked_registers, reg);
+}
+
+bool Executor::Storage::CanRMem(arch::Address address) const {
+    return address < arch::kMemorySize &&
+           !InRange(address,
+                    masks_.read_blocked_begin,
+                    masks_.read_blocked_size);
+}
+
+bool Executor::Storage::CanWReg(arch::Register reg) const {
+    return reg < arch::kNRegisters &&
+           !IsBlocked(masks_.write_blocked_registers, reg);
+}
+
+bool Executor::Storage::CanWMem(arch::Address address) const {
+    return address < arch::kMemorySize &&
+           !InRange(address,
+                    masks_.write_blocked_begin,
+                    masks_.write_blocked_size);
+}
+
+arch::Word* Executor::Storage::RegistersData() {
+    return registers_.data();
+}
+
+arch::Word* Executor::Storage::MemoryData() {
+    return memory_.Data();
+}
+
+void Executor::Storage::MarkMemoryDirty(arch::Address address) {
+    memory_.MarkDirty(address);
+}
+
+uint8_t* Executor::Storage::DirtyPagesData() {
+    return memory_.DirtyData();
+}
+
+size_t Executor::Storage::MinStackAddress() const {
+    return min_stack_address_;
+}
+
+const Executor::Intrinsics* Executor::Storage::GetIntrinsics() const {
+    // the routines found in the initial code may have been overwritten
+    return IsMultithreaded() || decode_cache_.Modified() ? nullptr
+                                                         : intrinsics_;
+}
+
+size_t Executor::Storage::StackSpace() const {
+    const auto curr_stack_address =
+        static_cast<size_t>(registers_.at(arch::kStackRegister));
+
+    // the same bounds as the CheckPushAllowed method checks, except that
+    // the stack is not counted to extend into the code or the constants
+    const size_t min_address =
+        std::max(min_stack_address_, curr_constants_end_);
+    if (curr_stack_address < min_address || curr_stack_address >= stack_end_) {
+        return 0;
+    }
+
+    return curr_stack_address - min_address + 1;
+}
+
+const std::string& Executor::Storage::NativeModulePath() const {
+    return curr_config_.GetNativeModule();
+}
+
 }  // namespace karma
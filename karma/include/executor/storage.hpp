@@ -1,15 +1,32 @@
 #pragma once
 
-#include <array>    // for array
-#include <cstddef>  // for size_t
-#include <ostream>  // for ostream
-#include <utility>  // for pair
-#include <vector>   // for vector
+#include <algorithm>  // for min
+#include <array>      // for array
+#include <atomic>     // for atomic_ref
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint16_t, uint32_t, uint8_t, uint64_t
+#include <memory>     // for shared_ptr
+#include <mutex>      // for mutex, unique_lock
+#include <optional>   // for optional
+#include <ostream>    // for ostream
+#include <span>       // for span
+#include <string>     // for string
+#include <utility>    // for pair
+#include <vector>     // for vector
 
-#include "exec/exec.hpp"
 #include "executor/config.hpp"
+#include "executor/debug_info.hpp"
+#include "executor/decode_cache.hpp"
 #include "executor/errors.hpp"
 #include "executor/executor.hpp"
+#include "executor/io.hpp"
+#include "executor/output_buffer.hpp"
+#include "executor/paged_memory.hpp"
+#include "executor/profiler.hpp"
+#include "executor/program_image.hpp"
+#include "executor/snapshot_image.hpp"
+#include "executor/stats.hpp"
+#include "executor/threads.hpp"
 #include "specs/architecture.hpp"
 #include "utils/traits.hpp"
 
@@ -20,15 +37,292 @@ class Executor::Storage : detail::utils::traits::NonCopyableMovable {
     using ExecutionError = errors::executor::ExecutionError::Builder;
     using Word           = detail::specs::arch::Word;
 
+   public:
+    // the number of the retired commands per their code,
+    // the command code takes the 8 most significant bits of a command
+    using RetiredCommands = std::array<uint64_t, 1 << 8>;
+
+   public:
+    // the access policies the RReg, RMem, WReg and WMem methods are templated
+    // on, the policy for an execution is chosen once in the PrepareForExecution
+    // method, so that the executors are able to instantiate their main loops
+    // for the chosen policy and avoid the checks it cannot trigger
+
+    // no access blocks are specified by the current config,
+    // so only the register numbers and the addresses are checked
+    struct Permissive {
+        static constexpr bool kChecksAccess = false;
+        static constexpr bool kChecksBounds = true;
+    };
+
+    // the current config specifies some access blocks (e.g. it is produced
+    // by the Strict or ExtraStrict presets or is a custom one), so they
+    // are checked via the bitmasks precomputed from the config
+    struct Restricted {
+        static constexpr bool kChecksAccess = true;
+        static constexpr bool kChecksBounds = true;
+    };
+
+    // the same as Permissive, but for the commands proven by the Verifier
+    // class to access only the existing registers and the addresses inside
+    // the memory, so nothing is checked at all
+    struct Verified {
+        static constexpr bool kChecksAccess = false;
+        static constexpr bool kChecksBounds = false;
+    };
+
+   private:
+    struct AccessMasks {
+        // the bit number i is set if the register ri is blocked
+        uint16_t write_blocked_registers{0};
+        uint16_t read_write_blocked_registers{0};
+
+        bool code_write_blocked{false};
+        bool code_read_write_blocked{false};
+        bool constants_read_write_blocked{false};
+
+        // the blocked segments are adjacent, so the addresses blocked for
+        // each kind of the access form a single range, and an access
+        // is checked via a single unsigned comparison (the range is empty
+        // if no segment is blocked)
+        size_t read_blocked_begin{0};
+        size_t read_blocked_size{0};
+        size_t write_blocked_begin{0};
+        size_t write_blocked_size{0};
+    };
+
+   private:
+    static bool IsBlocked(uint16_t mask, detail::specs::arch::Register reg) {
+        return ((static_cast<uint32_t>(mask) >> reg) & 1U) != 0;
+    }
+
+    static bool InRange(detail::specs::arch::Address address,
+                        size_t begin,
+                        size_t size) {
+        return static_cast<size_t>(address) - begin < size;
+    }
+
+    void PrepareAccessMasks();
+
+    // is called once the segments of the execution are known
+    void PrepareBlockedRanges();
+
+    // is called once the debug info and the blocks of the execution are known
+    void PrepareIntrinsics();
+
+    // invalidates the decoded commands of the range of the code segment,
+    // the range is invalidated for the other threads (if any) only once
+    // the words are stored (see the PublishCodeWrites method)
+    void InvalidateCode(detail::specs::arch::Address, size_t size);
+
+    // passes the code segment writes of the thread to the other threads
+    void PublishCodeWrites();
+
+    // the cold paths of the checks, which choose the error to throw
+    [[noreturn]] void ThrowPushNotAllowed() const;
+    [[noreturn]] void ThrowSegmentBlocked(detail::specs::arch::Address) const;
+
+    // checks all the addresses of the range at once
+    // against the memory bounds and the blocked addresses
+    void CheckRange(detail::specs::arch::Address,
+                    size_t size,
+                    size_t blocked_begin,
+                    size_t blocked_size) const;
+
+    void PrepareConfig(const Config&, std::ostream& log);
+
+    // the storage of the main thread of the execution
+    Storage& Main();
+
+    // rethrows the error of a spawned thread (if any)
+    void ThrowThreadError();
+
+    // adds the statistics of the finished spawned thread to the ones
+    // of the execution
+    void AddStats(const Storage& thread);
+
    public:
     explicit Storage(Config config)
         : base_config_(std::move(config)) {}
 
-    void PrepareForExecution(const Exec::Data& exec_data,
+    // the storage of the thread with the id spawned by the thread running
+    // on the specified storage (see the Spawn method), which shares
+    // the memory and the devices with the main thread of the execution
+    Storage(Storage& spawning,
+            Threads::Id,
+            detail::specs::arch::Address entry,
+            detail::specs::arch::Address stack);
+
+    void PrepareForExecution(const ProgramImage&,
                              const Config& config,
                              std::ostream& log);
 
-    void CheckPushAllowed() const;
+    // the same as the above, but restores the state of the Karma computer
+    // captured at the snapshot point of another execution
+    void PrepareForExecution(const SnapshotImage&,
+                             const Config& config,
+                             std::ostream& log);
+
+    // makes the current execution stop at the snapshot point
+    // rather than ignore the SNAPSHOT system call
+    void StopAtSnapshot();
+
+    // is called by the SNAPSHOT system call and returns true
+    // if the execution is to be stopped at it
+    bool ReachSnapshot();
+
+    [[nodiscard]] bool SnapshotReached() const;
+
+    // captures the state of the Karma computer (with the copy-on-write
+    // memory image), the output is expected to be already flushed
+    [[nodiscard]] std::shared_ptr<const SnapshotImage> Capture() const;
+
+    // the reasons for an execution run in the slices (see the Job class)
+    // to be stopped before it finishes
+    enum Interruption : uint8_t {
+        NOT_INTERRUPTED,
+
+        // the slice has executed all the commands allowed for it
+        OUT_OF_FUEL,
+
+        // the program waits for a signal (the HALT command)
+        HALTED,
+
+        // the program reads the input, which is not available yet
+        BLOCKED_ON_INPUT,
+
+        // the current thread of a multithreaded execution has spawned,
+        // joined or yielded to another thread, so its turn is over
+        // (see the Threads class)
+        RESCHEDULED,
+    };
+
+    // makes the current execution run in the slices rather than until
+    // it finishes, and starts the next slice of at most the number
+    // of the commands
+    void StartSlice(uint64_t fuel);
+
+    [[nodiscard]] bool IsSliced() const;
+
+    // the execution is sliced or multithreaded,
+    // so the executors are to charge the fuel
+    [[nodiscard]] bool IsFueled() const;
+
+    // the number of the commands the current slice or turn is still allowed
+    // to execute, which is charged by the executors per basic block
+    uint64_t& Fuel();
+
+    // stops the current slice, the return code
+    // of the stopped execution is ignored in this case
+    void Interrupt(Interruption);
+
+    [[nodiscard]] Interruption GetInterruption() const;
+
+    // the hardware threads of the execution (see the Threads class)
+
+    [[nodiscard]] bool IsMultithreaded() const;
+
+    // copies the registers and the flags of the current thread to the new one,
+    // which starts at the entry address with the stack at the stack address
+    // bounded by the same maximum stack size as the main thread is
+    Threads::Id Spawn(detail::specs::arch::Address entry,
+                      detail::specs::arch::Address stack);
+
+    // see the Threads::TryJoin method
+    std::optional<Word> TryJoin(Threads::Id);
+
+    // the following methods run the turns of the current thread (see
+    // the Threads class), they are called by the Impl class for the main
+    // thread and by the Threads class for the spawned ones
+
+    // returns false if the thread is not to take the next turn,
+    // rethrows the error of a spawned thread in the main one
+    bool StartTurn();
+    void EndTurn();
+
+    // see the Threads::Wait method
+    void Wait();
+
+    // is called by the TableExecutor class at the boundaries of the blocks
+    // of a multithreaded execution and by the threads waiting for a signal
+    // or the input, exchanges the code segment writes with the other threads
+    // (see the Threads::ReadCodeWrites method) and returns false
+    // if the execution is stopped, so the turn is to be ended
+    bool Synchronize();
+
+    // the execution is multithreaded and is being stopped, so the threads
+    // neither use the devices nor wait for a signal or the input anymore
+    [[nodiscard]] bool Stopped() const;
+
+    // is called by the EXIT system call with the devices locked, the one
+    // of the main thread stops the spawned threads before they are able
+    // to use the devices again
+    void Exit();
+
+    // the following methods are only called for the main thread
+
+    // starts the turns of the spawned threads, the turns of a sliced execution
+    // share the fuel left in the current slice
+    void ResumeThreads();
+
+    // stops the current slice once all the threads are paused, which is
+    // interrupted for the same reason as the thread which has stopped it
+    void PauseThreads();
+
+    // the statistics of the spawned threads and the pages written to
+    // by them are added to the ones of the execution
+    void StopThreads();
+
+    // the system calls using the input and the output devices of
+    // a multithreaded execution hold the lock while they are executed
+    std::unique_lock<std::mutex> LockDevices();
+
+    // the address of the command the execution has failed at, which is
+    // the one of a spawned thread if its error is rethrown by the main one
+    [[nodiscard]] detail::specs::arch::Address FailedAddress() const;
+
+    [[nodiscard]] Config::Engine GetEngine() const;
+
+    [[nodiscard]] bool IsPermissive() const;
+
+    // also records the depth of the stack for the execution statistics
+    void CheckPushAllowed() {
+        const auto curr_stack_address = static_cast<size_t>(
+            registers_[detail::specs::arch::kStackRegister]);
+
+        // both bounds of the stack are checked via a single comparison,
+        // the address below the minimal one wraps around to a huge value
+        if (curr_stack_address - min_stack_address_ >
+            stack_end_ - min_stack_address_) {
+            ThrowPushNotAllowed();
+        }
+
+        // the lowest pushed address is converted to the stack depth
+        // only once the execution is finished (see FinishStats)
+        lowest_stack_address_ =
+            std::min(lowest_stack_address_, curr_stack_address);
+    }
+
+    template <typename Policy>
+    [[nodiscard]] Word RReg(detail::specs::arch::Register,
+                            bool internal_usage = false) const;
+    template <typename Policy>
+    [[nodiscard]] Word RMem(detail::specs::arch::Address,
+                            bool internal_usage = false) const;
+
+    template <typename Policy>
+    Word& WReg(detail::specs::arch::Register, bool internal_usage = false);
+    template <typename Policy>
+    PagedMemory::SharedWord WMem(detail::specs::arch::Address,
+                                 bool internal_usage = false);
+
+    // the word the atomic commands (cas and xadd) both read and write,
+    // so the access is checked and counted as both
+    template <typename Policy>
+    std::atomic_ref<Word> AMem(detail::specs::arch::Address);
+
+    // the same as the above, but for the policy chosen for the current
+    // execution, which is checked on each call
 
     [[nodiscard]] Word RReg(detail::specs::arch::Register,
                             bool internal_usage = false) const;
@@ -36,23 +330,277 @@ class Executor::Storage : detail::utils::traits::NonCopyableMovable {
                             bool internal_usage = false) const;
 
     Word& WReg(detail::specs::arch::Register, bool internal_usage = false);
-    Word& WMem(detail::specs::arch::Address, bool internal_usage = false);
+    PagedMemory::SharedWord WMem(detail::specs::arch::Address,
+                                 bool internal_usage = false);
+    std::atomic_ref<Word> AMem(detail::specs::arch::Address);
     Word& Flags();
 
+    // the raw memory of the range of the specified number of the words
+    // for the bulk memory commands, the range is checked and counted
+    // in the statistics as if each of its addresses were accessed via the RMem
+    // and the WMem methods, but the checks are performed once for the whole
+    // range before accessing it, so nothing is accessed if any address fails,
+    // the words are accessed via the PagedMemory::Load and Store methods
+    // if the execution is multithreaded
+
+    const Word* RMemRange(detail::specs::arch::Address, Word size);
+    Word* WMemRange(detail::specs::arch::Address, Word size);
+
+    InputDevice& Input();
+    OutputBuffer& Output();
+    Profiler& Profile();
+
+    // writes the profile report of the current execution (if it is profiled)
+    // with the code as it is at the moment of the call
+    void ReportProfile();
+
+    // the location of the address in the source of the executed program
+    // (see the DebugInfo class), is only called once an execution fails
+    [[nodiscard]] std::optional<std::string> TryDescribe(
+        detail::specs::arch::Address) const;
+
+    // the statistics of the current execution, the memory accesses,
+    // the stack depth and the output bytes are counted by the Storage
+    // class itself, the rest is counted by the executors
+    ExecutionStats& Stats();
+    RetiredCommands& Retired();
+
+    // completes the statistics of the current execution with the counts
+    // of the retired commands and the run time, and stores them to
+    // the object specified by the config (if any)
+    void FinishStats(const ExecutionStats::Time& run);
+
+    // reads the command at the specified address the same way as RMem does
+    // for the internal usage, but returns it already decoded
+    DecodeCache::Instruction Fetch(detail::specs::arch::Address);
+
+    // see the DecodeCache::BlockLength method
+    [[nodiscard]] size_t BlockLength(detail::specs::arch::Address) const;
+
+    // see the DecodeCache::Leaders method, returns nullptr
+    // if the code has been modified since it was loaded
+    [[nodiscard]] const std::vector<uint8_t>* CodeLeaders() const;
+
+    [[nodiscard]] size_t CodeSegmentSize() const;
+    [[nodiscard]] uint64_t CodeGeneration() const;
+
+    // see the DecodeCache::InvalidatedSince method
+    [[nodiscard]] std::optional<std::span<const detail::specs::arch::Address>>
+    InvalidatedCodeSince(uint64_t generation) const;
+
+    // the following methods check if the respective RReg, RMem, WReg and WMem
+    // calls (not for the internal usage) succeed without performing them,
+    // so that the JitCompiler class is able to check the access rights once
+    // when compiling the commands rather than on each their execution
+
+    [[nodiscard]] bool CanRReg(detail::specs::arch::Register) const;
+    [[nodiscard]] bool CanRMem(detail::specs::arch::Address) const;
+    [[nodiscard]] bool CanWReg(detail::specs::arch::Register) const;
+    [[nodiscard]] bool CanWMem(detail::specs::arch::Address) const;
+
+    // the raw registers and memory for the native code generated by
+    // the JitCompiler class, which performs all the checks beforehand
+
+    Word* RegistersData();
+    Word* MemoryData();
+
+    // the native code writes to the raw memory directly, so the JitCompiler
+    // class marks the written pages for the next reset of the memory
+    void MarkMemoryDirty(detail::specs::arch::Address);
+
+    // the native modules mark the written pages themselves
+    // (see the NativeExecutor class)
+    uint8_t* DirtyPagesData();
+
+    [[nodiscard]] size_t MinStackAddress() const;
+
+    // the routines of the executed program run natively (see the Intrinsics
+    // class), nullptr if they are not enabled for the current execution
+    // or other threads are running, which the interpreted routine could be
+    // interleaved with
+    [[nodiscard]] const Intrinsics* GetIntrinsics() const;
+
+    // the number of the words the current thread is surely able to push
+    [[nodiscard]] size_t StackSpace() const;
+    [[nodiscard]] const std::string& NativeModulePath() const;
+
    private:
     Config base_config_;
     Config curr_config_{base_config_};
 
-    // allocate the memory on the heap, and all the registers on the stack
-    // to provide emulation that register operations are faster
+    AccessMasks masks_;
+    bool permissive_{true};
+
+    // is cached from the config, as it is checked on each push,
+    // the stack of the main thread ends at the end of the memory,
+    // and the stacks of the other threads end where they are spawned with
+    size_t min_stack_address_{0};
+    size_t stack_end_{detail::specs::arch::kMemorySize};
+    size_t lowest_stack_address_{detail::specs::arch::kMemorySize};
 
-    std::vector<Word> memory_ =
-        std::vector<Word>(detail::specs::arch::kMemorySize);
+    // map the memory lazily (see the PagedMemory class), and allocate
+    // all the registers in place to provide emulation that register
+    // operations are faster
+
+    PagedMemory memory_;
     size_t curr_code_end_{0};
     size_t curr_constants_end_{0};
+    detail::specs::arch::Address curr_entrypoint_{0};
+
+    // the debug info of the executed program,
+    // is set by the PrepareForExecution methods
+    std::shared_ptr<const DebugInfo> debug_;
+
+    // are owned by the debug info
+    const Intrinsics* intrinsics_{nullptr};
+
+    // the commands of the initial code segment decoded once before
+    // the execution, the cached command is invalidated on each write
+    // to its address, so the code modified at runtime is decoded again
+    DecodeCache decode_cache_;
 
     std::array<Word, detail::specs::arch::kNRegisters> registers_{};
     Word flags_{0};
+
+    // the spawned threads of the execution, which are only kept
+    // by the storage of the main thread
+    Threads threads_;
+
+    // the storage of the main thread for the storages of the spawned ones,
+    // which share its devices and its threads
+    Storage* main_{nullptr};
+    Threads::Id thread_id_{0};
+
+    // the code segment writes of the thread not passed to the other threads
+    // yet and the number of the writes of the other threads the decode cache
+    // is up to date with (see the Synchronize method)
+    Threads::CodeWrites code_writes_;
+    uint64_t code_writes_read_{0};
+
+    // the address a spawned thread has failed at (see FailedAddress)
+    std::optional<detail::specs::arch::Address> failed_at_;
+
+    // the devices of the input and the output system calls
+    // of the current execution
+    std::shared_ptr<InputDevice> input_;
+    OutputBuffer output_;
+
+    Profiler profiler_;
+
+    // the accessors counting the memory accesses are const for reading
+    mutable ExecutionStats stats_;
+    RetiredCommands retired_{};
+
+    bool stop_at_snapshot_{false};
+    bool snapshot_reached_{false};
+
+    bool sliced_{false};
+    uint64_t fuel_{0};
+    Interruption interruption_{NOT_INTERRUPTED};
 };
 
+template <typename Policy>
+Executor::Storage::Word Executor::Storage::RReg(
+    detail::specs::arch::Register reg,
+    bool internal_usage) const {
+    if constexpr (Policy::kChecksBounds) {
+        if (reg >= detail::specs::arch::kNRegisters) {
+            throw ExecutionError::InvalidRegister(reg);
+        }
+    }
+
+    if constexpr (Policy::kChecksAccess) {
+        if (!internal_usage &&
+            IsBlocked(masks_.read_write_blocked_registers, reg)) {
+            throw ExecutionError::RegisterIsBlocked(reg);
+        }
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    return registers_[reg];
+}
+
+template <typename Policy>
+Executor::Storage::Word Executor::Storage::RMem(
+    detail::specs::arch::Address address,
+    bool internal_usage) const {
+    if constexpr (Policy::kChecksBounds) {
+        if (address >= detail::specs::arch::kMemorySize) {
+            throw ExecutionError::AddressOutOfMemory(address);
+        }
+    }
+
+    if constexpr (Policy::kChecksAccess) {
+        if (!internal_usage && InRange(address,
+                                       masks_.read_blocked_begin,
+                                       masks_.read_blocked_size)) {
+            ThrowSegmentBlocked(address);
+        }
+    }
+
+    if (!internal_usage) {
+        ++stats_.memory_reads;
+    }
+
+    return memory_.Read(address);
+}
+
+template <typename Policy>
+Executor::Storage::Word& Executor::Storage::WReg(
+    detail::specs::arch::Register reg,
+    bool internal_usage) {
+    if constexpr (Policy::kChecksBounds) {
+        if (reg >= detail::specs::arch::kNRegisters) {
+            throw ExecutionError::InvalidRegister(reg);
+        }
+    }
+
+    if constexpr (Policy::kChecksAccess) {
+        if (!internal_usage && IsBlocked(masks_.write_blocked_registers, reg)) {
+            throw ExecutionError::RegisterIsBlocked(reg);
+        }
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    return registers_[reg];
+}
+
+template <typename Policy>
+Executor::PagedMemory::SharedWord Executor::Storage::WMem(
+    detail::specs::arch::Address address,
+    bool internal_usage) {
+    if constexpr (Policy::kChecksBounds) {
+        if (address >= detail::specs::arch::kMemorySize) {
+            throw ExecutionError::AddressOutOfMemory(address);
+        }
+    }
+
+    if constexpr (Policy::kChecksAccess) {
+        if (!internal_usage && InRange(address,
+                                       masks_.write_blocked_begin,
+                                       masks_.write_blocked_size)) {
+            ThrowSegmentBlocked(address);
+        }
+    }
+
+    if (!internal_usage) {
+        ++stats_.memory_writes;
+    }
+
+    // the word is returned for writing, so the cached command
+    // at this address (if any) is to be considered stale
+    if (address < curr_code_end_) {
+        InvalidateCode(address, 1);
+    }
+
+    return memory_.Write(address);
+}
+
+template <typename Policy>
+std::atomic_ref<Executor::Storage::Word> Executor::Storage::AMem(
+    detail::specs::arch::Address address) {
+    static_cast<void>(RMem<Policy>(address));
+    return WMem<Policy>(address).Atomic();
+}
+
 }  // namespace karma
@@ -0,0 +1,768 @@
+#include "table_executor.hpp"
+
+#include <algorithm>  // for min
+#include <atomic>     // for atomic_ref
+#include <bit>        // for bit_cast
+#include <cmath>      // for floor
+#include <cstdint>    // for uint64_t
+
+#include "executor/profiler.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "specs/flags.hpp"
+
+namespace karma {
+
+namespace arch    = detail::specs::arch;
+namespace cmd     = detail::specs::cmd;
+namespace args    = cmd::args;
+namespace flags   = detail::specs::flags;
+namespace syscall = cmd::syscall;
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Operands                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Policy>
+arch::Word Executor::TableExecutor::RHSWord(const Instruction& instr) {
+    return RReg<Policy>(instr.src) + instr.operand;
+}
+
+arch::Double Executor::TableExecutor::LHSDouble(const Instruction& instr) {
+    return std::bit_cast<arch::Double>(GetTwoRegisters(instr.recv));
+}
+
+arch::Double Executor::TableExecutor::RHSDouble(const Instruction& instr) {
+    return std::bit_cast<arch::Double>(GetTwoRegisters(instr.src));
+}
+
+void Executor::TableExecutor::PutDouble(arch::Double value,
+                                        args::Receiver recv) {
+    PutTwoRegisters(std::bit_cast<arch::TwoWords>(value), recv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Dispatch                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+// the cases of the following switch statement form a dense range
+// of the commands codes, so the compiler lowers the switch statement
+// to a single jump table indexed by the code, and since all the handlers
+// are defined in this translation unit, they are inlined into the cases
+//
+template <typename Policy>
+// NOLINTNEXTLINE(*-function-size)
+Executor::MaybeReturnCode Executor::TableExecutor::Execute(
+    const Instruction& instr) {
+    switch (const cmd::Code code = instr.code) {
+        ////////////////////////////////////////////////////////////////////////
+        ///                            System                                ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::HALT: {
+            return Halt();
+        }
+
+        case cmd::SYSCALL: {
+            return Syscall(instr.recv,
+                           static_cast<syscall::Code>(instr.operand));
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                       Integer arithmetic                         ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::ADD: {
+            WReg<Policy>(instr.recv) += RHSWord<Policy>(instr);
+            return {};
+        }
+
+        case cmd::ADDI: {
+            WReg<Policy>(instr.recv) += instr.operand;
+            return {};
+        }
+
+        case cmd::SUB: {
+            WReg<Policy>(instr.recv) -= RHSWord<Policy>(instr);
+            return {};
+        }
+
+        case cmd::SUBI: {
+            WReg<Policy>(instr.recv) -= instr.operand;
+            return {};
+        }
+
+        case cmd::MUL: {
+            auto res = static_cast<arch::TwoWords>(RReg<Policy>(instr.recv)) *
+                       static_cast<arch::TwoWords>(RHSWord<Policy>(instr));
+            PutTwoRegisters(res, instr.recv);
+            return {};
+        }
+
+        case cmd::MULI: {
+            auto res = static_cast<arch::TwoWords>(RReg<Policy>(instr.recv)) *
+                       static_cast<arch::TwoWords>(instr.operand);
+            PutTwoRegisters(res, instr.recv);
+            return {};
+        }
+
+        case cmd::DIV: {
+            Divide(GetTwoRegisters(instr.recv),
+                   static_cast<arch::TwoWords>(RHSWord<Policy>(instr)),
+                   instr.recv);
+            return {};
+        }
+
+        case cmd::DIVI: {
+            Divide(GetTwoRegisters(instr.recv),
+                   static_cast<arch::TwoWords>(instr.operand),
+                   instr.recv);
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                       Bitwise operators                          ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::NOT: {
+            WReg<Policy>(instr.recv) = ~RReg<Policy>(instr.recv);
+            return {};
+        }
+
+        case cmd::SHL: {
+            const arch::Word rhs = RHSWord<Policy>(instr);
+            CheckBitwiseShiftRHS(rhs, code);
+            WReg<Policy>(instr.recv) <<= rhs;
+            return {};
+        }
+
+        case cmd::SHLI: {
+            const arch::Word rhs = instr.operand;
+            CheckBitwiseShiftRHS(rhs, code);
+            WReg<Policy>(instr.recv) <<= rhs;
+            return {};
+        }
+
+        case cmd::SHR: {
+            const arch::Word rhs = RHSWord<Policy>(instr);
+            CheckBitwiseShiftRHS(rhs, code);
+            WReg<Policy>(instr.recv) >>= rhs;
+            return {};
+        }
+
+        case cmd::SHRI: {
+            const arch::Word rhs = instr.operand;
+            CheckBitwiseShiftRHS(rhs, code);
+            WReg<Policy>(instr.recv) >>= rhs;
+            return {};
+        }
+
+        case cmd::AND: {
+            WReg<Policy>(instr.recv) &= RHSWord<Policy>(instr);
+            return {};
+        }
+
+        case cmd::ANDI: {
+            WReg<Policy>(instr.recv) &= instr.operand;
+            return {};
+        }
+
+        case cmd::OR: {
+            WReg<Policy>(instr.recv) |= RHSWord<Policy>(instr);
+            return {};
+        }
+
+        case cmd::ORI: {
+            WReg<Policy>(instr.recv) |= instr.operand;
+            return {};
+        }
+
+        case cmd::XOR: {
+            WReg<Policy>(instr.recv) ^= RHSWord<Policy>(instr);
+            return {};
+        }
+
+        case cmd::XORI: {
+            WReg<Policy>(instr.recv) ^= instr.operand;
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                     Real-valued operators                        ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::ITOD: {
+            PutDouble(static_cast<arch::Double>(RHSWord<Policy>(instr)),
+                      instr.recv);
+            return {};
+        }
+
+        case cmd::DTOI: {
+            const arch::Double dbl = RHSDouble(instr);
+            if (dbl >= static_cast<arch::Double>(arch::kMaxWord)) {
+                throw ExecutionError::DtoiOverflow(dbl);
+            }
+
+            // static cast does not produce UB, because the resulting
+            // value fits into arch::Word due to the check above
+            WReg<Policy>(instr.recv) = static_cast<arch::Word>(floor(dbl));
+            return {};
+        }
+
+        case cmd::ADDD: {
+            PutDouble(LHSDouble(instr) + RHSDouble(instr), instr.recv);
+            return {};
+        }
+
+        case cmd::SUBD: {
+            PutDouble(LHSDouble(instr) - RHSDouble(instr), instr.recv);
+            return {};
+        }
+
+        case cmd::MULD: {
+            PutDouble(LHSDouble(instr) * RHSDouble(instr), instr.recv);
+            return {};
+        }
+
+        case cmd::DIVD: {
+            const arch::Double lhs = LHSDouble(instr);
+            const arch::Double rhs = RHSDouble(instr);
+
+            if (rhs == 0) {
+                throw ExecutionError::DivisionByZero(lhs, rhs);
+            }
+
+            PutDouble(lhs / rhs, instr.recv);
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                          Comparisons                             ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::CMP: {
+            WriteComparisonToFlags(RReg<Policy>(instr.recv),
+                                   RHSWord<Policy>(instr));
+            return {};
+        }
+
+        case cmd::CMPI: {
+            WriteComparisonToFlags(RReg<Policy>(instr.recv), instr.operand);
+            return {};
+        }
+
+        case cmd::CMPD: {
+            WriteComparisonToFlags(LHSDouble(instr), RHSDouble(instr));
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                             Jumps                                ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::JMP: {
+            WReg<Policy>(arch::kInstructionRegister, kInternalUse) =
+                instr.operand;
+            return {};
+        }
+
+        case cmd::JNE: {
+            Jump(flags::NOT_EQUAL, instr.operand);
+            return {};
+        }
+
+        case cmd::JEQ: {
+            Jump(flags::EQUAL, instr.operand);
+            return {};
+        }
+
+        case cmd::JLE: {
+            Jump(flags::LESS_OR_EQUAL, instr.operand);
+            return {};
+        }
+
+        case cmd::JL: {
+            Jump(flags::LESS, instr.operand);
+            return {};
+        }
+
+        case cmd::JGE: {
+            Jump(flags::GREATER_OR_EQUAL, instr.operand);
+            return {};
+        }
+
+        case cmd::JG: {
+            Jump(flags::GREATER, instr.operand);
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                             Stack                                ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::PUSH: {
+            Push(RReg<Policy>(instr.recv) + instr.operand);
+            return {};
+        }
+
+        case cmd::POP: {
+            Pop(instr.recv, instr.operand);
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                         Data transfer                            ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::LC: {
+            WReg<Policy>(instr.recv) = instr.operand;
+            return {};
+        }
+
+        case cmd::LA: {
+            WReg<Policy>(instr.recv) = instr.operand;
+            return {};
+        }
+
+        case cmd::MOV: {
+            WReg<Policy>(instr.recv) = RHSWord<Policy>(instr);
+            return {};
+        }
+
+        case cmd::LOAD: {
+            WReg<Policy>(instr.recv) = RMem<Policy>(instr.operand);
+            return {};
+        }
+
+        case cmd::LOAD2: {
+            WReg<Policy>(instr.recv)     = RMem<Policy>(instr.operand);
+            WReg<Policy>(instr.recv + 1) = RMem<Policy>(instr.operand + 1);
+            return {};
+        }
+
+        case cmd::STORE: {
+            WMem<Policy>(instr.operand) = RReg<Policy>(instr.recv);
+            return {};
+        }
+
+        case cmd::STORE2: {
+            WMem<Policy>(instr.operand)     = RReg<Policy>(instr.recv);
+            WMem<Policy>(instr.operand + 1) = RReg<Policy>(instr.recv + 1);
+            return {};
+        }
+
+        case cmd::LOADR: {
+            WReg<Policy>(instr.recv) = RMem<Policy>(RHSWord<Policy>(instr));
+            return {};
+        }
+
+        case cmd::LOADR2: {
+            const args::Address address = RHSWord<Policy>(instr);
+
+            WReg<Policy>(instr.recv)     = RMem<Policy>(address);
+            WReg<Policy>(instr.recv + 1) = RMem<Policy>(address + 1);
+            return {};
+        }
+
+        case cmd::STORER: {
+            WMem<Policy>(RHSWord<Policy>(instr)) = RReg<Policy>(instr.recv);
+            return {};
+        }
+
+        case cmd::STORER2: {
+            const args::Address address = RHSWord<Policy>(instr);
+
+            WMem<Policy>(address)     = RReg<Policy>(instr.recv);
+            WMem<Policy>(address + 1) = RReg<Policy>(instr.recv + 1);
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                        Function calls                            ///
+        ////////////////////////////////////////////////////////////////////////
+
+        case cmd::PRC: {
+            PrepareCall();
+            return {};
+        }
+
+        case cmd::CALL: {
+            WReg<Policy>(instr.recv) = Call(RHSWord<Policy>(instr));
+            return {};
+        }
+
+        case cmd::CALLI: {
+            Call(instr.operand);
+            return {};
+        }
+
+        case cmd::RET: {
+            Return();
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                       Atomic operations                          ///
+        ////////////////////////////////////////////////////////////////////////
+
+        // the threads run on the host threads (see the Threads class),
+        // so the memory word is accessed via the atomic operations
+
+        case cmd::CAS: {
+            std::atomic_ref<arch::Word> word =
+                AMem<Policy>(RHSWord<Policy>(instr));
+
+            const arch::Word expected = RReg<Policy>(instr.recv);
+            arch::Word actual         = expected;
+
+            // the actual value is written to the expected one if they differ
+            word.compare_exchange_strong(actual,
+                                         RReg<Policy>(instr.recv + 1));
+
+            WriteComparisonToFlags(actual, expected);
+            WReg<Policy>(instr.recv) = actual;
+            return {};
+        }
+
+        case cmd::XADD: {
+            std::atomic_ref<arch::Word> word =
+                AMem<Policy>(RHSWord<Policy>(instr));
+
+            WReg<Policy>(instr.recv) =
+                word.fetch_add(RReg<Policy>(instr.recv));
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        ///                     Bulk memory operations                       ///
+        ////////////////////////////////////////////////////////////////////////
+
+        // the ranges are checked once per command,
+        // so the words are accessed without the per-word checks
+
+        case cmd::MCOPY: {
+            const args::Address dst = RReg<Policy>(instr.recv);
+            const args::Address src = RHSWord<Policy>(instr);
+            const arch::Word size   = RReg<Policy>(instr.recv + 1);
+
+            CopyMemory(dst, src, size);
+            return {};
+        }
+
+        case cmd::MFILL: {
+            const args::Address dst = RReg<Policy>(instr.recv);
+            const arch::Word value  = RHSWord<Policy>(instr);
+            const arch::Word size   = RReg<Policy>(instr.recv + 1);
+
+            FillMemory(dst, value, size);
+            return {};
+        }
+
+        case cmd::MCMP: {
+            const args::Address lhs = RReg<Policy>(instr.recv);
+            const args::Address rhs = RHSWord<Policy>(instr);
+            const arch::Word size   = RReg<Policy>(instr.recv + 1);
+
+            CompareMemory(lhs, rhs, size);
+            return {};
+        }
+
+        case cmd::MFIND: {
+            const args::Address begin = RReg<Policy>(instr.recv);
+            const arch::Word value    = RHSWord<Policy>(instr);
+            const arch::Word size     = RReg<Policy>(instr.recv + 1);
+
+            WReg<Policy>(instr.recv) = FindInMemory(begin, value, size);
+            return {};
+        }
+
+        default: {
+            throw ExecutionError::UnknownCommand(code);
+        }
+    }
+}
+
+template Executor::MaybeReturnCode
+Executor::TableExecutor::Execute<Executor::Storage::Permissive>(
+    const Instruction&);
+template Executor::MaybeReturnCode
+Executor::TableExecutor::Execute<Executor::Storage::Restricted>(
+    const Instruction&);
+template Executor::MaybeReturnCode
+Executor::TableExecutor::Execute<Executor::Storage::Verified>(
+    const Instruction&);
+
+////////////////////////////////////////////////////////////////////////////////
+///                                  Fusion                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// the same as checking the respective flag written by comparing the operands,
+// so the fused comparison does not read the flags back to take the jump
+bool IsJumpTaken(cmd::Code jump, arch::Word lhs, arch::Word rhs) {
+    switch (jump) {
+        case cmd::JNE: {
+            return lhs != rhs;
+        }
+
+        case cmd::JEQ: {
+            return lhs == rhs;
+        }
+
+        case cmd::JLE: {
+            return lhs <= rhs;
+        }
+
+        case cmd::JL: {
+            return lhs < rhs;
+        }
+
+        case cmd::JGE: {
+            return lhs >= rhs;
+        }
+
+        case cmd::JG: {
+            return lhs > rhs;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+}  // namespace
+
+template <typename Policy>
+size_t Executor::TableExecutor::ExecuteFused(arch::Address address,
+                                             const Instruction& head) {
+    Storage::RetiredCommands& retired = Retired();
+
+    // the instruction register already points to the second command,
+    // it is moved to the next command before executing each of the rest,
+    // so a failed command is reported at its own address
+
+    switch (head.fusion) {
+        case DecodeCache::COMPARE_JUMP: {
+            const Instruction jump = Fetch(address + 1);
+
+            const arch::Word lhs = RReg<Policy>(head.recv);
+            const arch::Word rhs =
+                head.code == cmd::CMP ? RHSWord<Policy>(head) : head.operand;
+
+            // the flags are still written, since they are visible
+            // to the commands following the jump and to the snapshots
+            WriteComparisonToFlags(lhs, rhs);
+
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            ++retired[jump.code];
+            WReg<Policy>(arch::kInstructionRegister, kInternalUse) =
+                IsJumpTaken(jump.code, lhs, rhs) ? jump.operand : address + 2;
+            return 2;
+        }
+
+        case DecodeCache::CALL_SEQUENCE: {
+            const Instruction push  = Fetch(address + 1);
+            const Instruction calli = Fetch(address + 2);
+
+            // the pushes may overwrite the following commands of the sequence,
+            // in which case the rest of it is left to the main loop
+            const uint64_t generation = CodeGeneration();
+
+            PrepareCall();
+            if (CodeGeneration() != generation) {
+                return 1;
+            }
+
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            ++retired[push.code];
+            WReg<Policy>(arch::kInstructionRegister, kInternalUse) =
+                address + 2;
+
+            Push(RReg<Policy>(push.recv) + push.operand);
+            if (CodeGeneration() != generation) {
+                return 2;
+            }
+
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            ++retired[calli.code];
+            WReg<Policy>(arch::kInstructionRegister, kInternalUse) =
+                address + 3;
+
+            Call(calli.operand);
+            return 3;
+        }
+
+        case DecodeCache::LOAD_ARGUMENTS: {
+            const Instruction second = Fetch(address + 1);
+
+            // the first load does not change the stack register
+            // (see the DecodeCache::Fuse method)
+            const arch::Word stack = RReg<Policy>(head.src);
+
+            WReg<Policy>(head.recv) = RMem<Policy>(stack + head.operand);
+
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            ++retired[second.code];
+            WReg<Policy>(arch::kInstructionRegister, kInternalUse) =
+                address + 2;
+
+            WReg<Policy>(second.recv) = RMem<Policy>(stack + second.operand);
+            return 2;
+        }
+
+        case DecodeCache::NO_FUSION: {
+            // is never called for the commands not starting a sequence
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+template size_t
+Executor::TableExecutor::ExecuteFused<Executor::Storage::Permissive>(
+    arch::Address,
+    const Instruction&);
+template size_t
+Executor::TableExecutor::ExecuteFused<Executor::Storage::Restricted>(
+    arch::Address,
+    const Instruction&);
+
+////////////////////////////////////////////////////////////////////////////////
+///                                Main loop                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Policy, bool kProfiled, bool kSliced>
+Executor::ReturnCode Executor::TableExecutor::Run() {
+    Storage::RetiredCommands& retired = Retired();
+    Profiler& profiler                = Profile();
+
+    if constexpr (kProfiled) {
+        profiler.Start(RReg<Policy>(arch::kInstructionRegister, kInternalUse));
+    }
+
+    // the fuel of a sliced execution is charged for a whole basic block
+    // at once, so the slice is checked for ending once per block rather
+    // than once per command, the commands left in the current batch
+    // are returned to the fuel once the slice is stopped by a command
+    uint64_t batch = 0;
+
+    while (true) {
+        const arch::Address curr_address =
+            RReg<Policy>(arch::kInstructionRegister, kInternalUse);
+
+        if constexpr (kSliced) {
+            if (batch == 0) {
+                if (Fuel() == 0) {
+                    Interrupt(Storage::OUT_OF_FUEL);
+                    return 0;
+                }
+
+                // the other threads may have modified the code
+                // or stopped the execution since the previous block
+                if (!Synchronize()) {
+                    Interrupt(Storage::RESCHEDULED);
+                    return 0;
+                }
+
+                batch = std::min<uint64_t>(Fuel(), BlockLength(curr_address));
+                Fuel() -= batch;
+            }
+        }
+
+        if (curr_address >= arch::kMemorySize) {
+            throw ExecutionError::ExecPointerOutOfMemory(curr_address);
+        }
+
+        WReg<Policy>(arch::kInstructionRegister, kInternalUse)++;
+
+        // do not check if the current command address is out of the initial
+        // code segment to allow for programs to write and execute the code
+        // at runtime (see the Impl::RunMapped method for details), the decode
+        // cache takes care of the commands modified at runtime
+
+        const Instruction instr = Fetch(curr_address);
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        ++retired[instr.code];
+
+        if constexpr (kProfiled) {
+            profiler.Record(curr_address, instr.code);
+        } else {
+            // the profiled executions record each command separately,
+            // so only the other ones execute the fused sequences at once,
+            // and the sliced ones only if the whole sequence fits the batch
+            if (instr.fusion != DecodeCache::NO_FUSION) {
+                if constexpr (kSliced) {
+                    const size_t length = DecodeCache::Length(instr.fusion);
+
+                    // only the commands executed before the rest of
+                    // the sequence is left to the main loop are charged
+                    if (batch >= length) {
+                        batch -= ExecuteFused<Policy>(curr_address, instr);
+                        continue;
+                    }
+                } else {
+                    ExecuteFused<Policy>(curr_address, instr);
+                    continue;
+                }
+            }
+        }
+
+        // the commands proven by the Verifier class never fail and never
+        // finish the execution, so they are executed without the checks
+        // if the config specifies no access blocks
+        if (!Policy::kChecksAccess && instr.verified) {
+            Execute<Storage::Verified>(instr);
+        } else if (MaybeReturnCode return_code = Execute<Policy>(instr)) {
+            if constexpr (kSliced) {
+                Fuel() += batch - 1;
+            }
+
+            return *return_code;
+        }
+
+        if constexpr (kSliced) {
+            --batch;
+        }
+
+        if constexpr (kProfiled) {
+            if (instr.code == cmd::CALL || instr.code == cmd::CALLI) {
+                profiler.Call(
+                    RReg<Policy>(arch::kInstructionRegister, kInternalUse));
+            } else if (instr.code == cmd::RET) {
+                profiler.Return();
+            }
+        }
+    }
+}
+
+Executor::ReturnCode Executor::TableExecutor::Run() {
+    // the sliced executions are never profiled (see the Impl class),
+    // and the multithreaded ones are only profiled up to the first spawn
+    if (IsFueled()) {
+        if (IsPermissive()) {
+            return Run<Storage::Permissive, false, true>();
+        }
+
+        return Run<Storage::Restricted, false, true>();
+    }
+
+    if (Profile().IsEnabled()) {
+        if (IsPermissive()) {
+            return Run<Storage::Permissive, true, false>();
+        }
+
+        return Run<Storage::Restricted, true, false>();
+    }
+
+    if (IsPermissive()) {
+        return Run<Storage::Permissive, false, false>();
+    }
+
+    return Run<Storage::Restricted, false, false>();
+}
+
+}  // namespace karma
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+
+#include "executor/common_executor.hpp"
+#include "executor/decode_cache.hpp"
+#include "executor/errors.hpp"
+#include "executor/executor.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+
+namespace karma {
+
+class Executor::TableExecutor : public CommonExecutor {
+   protected:
+    using ExecutionError = errors::executor::ExecutionError::Builder;
+
+    using Instruction = DecodeCache::Instruction;
+
+   private:
+    template <typename Policy>
+    detail::specs::arch::Word RHSWord(const Instruction&);
+    detail::specs::arch::Double LHSDouble(const Instruction&);
+    detail::specs::arch::Double RHSDouble(const Instruction&);
+
+    void PutDouble(detail::specs::arch::Double,
+                   detail::specs::cmd::args::Receiver);
+
+   protected:
+    // the commands are executed with the accessors instantiated for
+    // the access policy of the current execution (see the Storage class)
+    template <typename Policy>
+    MaybeReturnCode Execute(const Instruction&);
+
+    // executes the sequence of commands starting with the fused command
+    // (see the DecodeCache class) at the address, the effects (including
+    // the flags, the retired commands counts and the address of a failed
+    // command) are the same as of executing the commands one by one,
+    // returns the number of the commands executed, which is less than
+    // the length of the sequence if the rest of it is left to the main loop
+    template <typename Policy>
+    size_t ExecuteFused(detail::specs::arch::Address, const Instruction&);
+
+   private:
+    // the profiled executions count each command in the main loop instantiated
+    // for them (see the Profiler class), and the sliced ones charge the fuel
+    // in the one instantiated for them (see the Job class), so that
+    // the other executions do not check either of them on each step
+    template <typename Policy, bool kProfiled, bool kSliced>
+    ReturnCode Run();
+
+   public:
+    ReturnCode Run();
+};
+
+}  // namespace karma
@@ -0,0 +1,363 @@
+#include "threads.hpp"
+
+#include <algorithm>   // for min
+#include <atomic>      // for memory_order_acquire, memory_order_release
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <exception>   // for exception_ptr, current_exception
+#include <functional>  // for function
+#include <memory>      // for shared_ptr
+#include <mutex>       // for mutex, lock_guard, unique_lock
+#include <optional>    // for optional, nullopt
+#include <thread>      // for thread, yield
+#include <utility>     // for move, exchange, pair
+#include <vector>      // for vector
+
+#include "executor/decode_cache.hpp"
+#include "executor/storage.hpp"
+#include "executor/table_executor.hpp"
+#include "specs/architecture.hpp"
+
+namespace karma {
+
+namespace arch = detail::specs::arch;
+
+Executor::Threads::~Threads() {
+    Stop();
+}
+
+void Executor::Threads::Run(Id id, const std::shared_ptr<Storage>& storage) {
+    TableExecutor table{storage};
+
+    try {
+        while (storage->StartTurn()) {
+            const ReturnCode return_code = table.Run();
+            storage->EndTurn();
+
+            switch (storage->GetInterruption()) {
+                // the EXIT system call of a spawned thread only finishes it
+                case Storage::NOT_INTERRUPTED: {
+                    const std::lock_guard lock(mutex_);
+
+                    Context& context    = contexts_.at(id);
+                    context.state       = FINISHED;
+                    context.return_code = return_code;
+
+                    changed_.notify_all();
+                    return;
+                }
+
+                case Storage::OUT_OF_FUEL: {
+                    break;
+                }
+
+                case Storage::RESCHEDULED: {
+                    Wait(id);
+                    break;
+                }
+
+                // the thread continues with the next slice
+                // as the main thread does
+                case Storage::HALTED:
+                case Storage::BLOCKED_ON_INPUT: {
+                    Block(id);
+                    break;
+                }
+            }
+        }
+    } catch (...) {
+        Fail(std::current_exception(), storage->FailedAddress());
+    }
+}
+
+void Executor::Threads::Fail(std::exception_ptr error, arch::Address address) {
+    const std::lock_guard lock(mutex_);
+
+    // the first error is reported, the other threads
+    // may have failed only because of it
+    if (!error_) {
+        error_     = std::move(error);
+        failed_at_ = address;
+    }
+
+    // the thread has failed in the middle of its turn
+    --running_;
+    stopped_ = true;
+
+    changed_.notify_all();
+}
+
+bool Executor::Threads::IsWaiting(Id id) const {
+    const Context& context = contexts_.at(id);
+    return context.state == JOINING &&
+           contexts_.at(context.joined).state < FINISHED;
+}
+
+bool Executor::Threads::IsMultithreaded() const {
+    return multithreaded_;
+}
+
+Executor::Threads::Id Executor::Threads::Spawn(
+    const std::function<std::shared_ptr<Storage>(Id)>& create) {
+    const std::lock_guard lock(mutex_);
+
+    if (contexts_.size() >= kMaxThreads) {
+        throw ExecutionError::TooManyThreads(kMaxThreads);
+    }
+
+    const auto id = static_cast<Id>(contexts_.size());
+
+    std::shared_ptr<Storage> storage = create(id);
+
+    // the thread waits for the lock to take its first turn
+    Context& context = contexts_.emplace_back();
+    context.host     = std::thread(&Threads::Run, this, id, storage);
+    context.storage  = std::move(storage);
+
+    multithreaded_ = true;
+
+    return id;
+}
+
+void Executor::Threads::Resume(bool sliced, uint64_t fuel) {
+    const std::lock_guard lock(mutex_);
+
+    sliced_ = sliced;
+    fuel_   = fuel;
+    paused_ = false;
+
+    changed_.notify_all();
+}
+
+std::shared_ptr<Executor::Storage> Executor::Threads::Pause() {
+    std::unique_lock lock(mutex_);
+
+    paused_ = true;
+    changed_.notify_all();
+
+    changed_.wait(lock, [this] { return running_ == 0 || stopped_; });
+
+    return std::exchange(blocked_, nullptr);
+}
+
+void Executor::Threads::Block(Id id) {
+    const std::lock_guard lock(mutex_);
+
+    if (!blocked_) {
+        blocked_ = contexts_.at(id).storage;
+    }
+
+    paused_ = true;
+    changed_.notify_all();
+}
+
+void Executor::Threads::Cancel() {
+    const std::lock_guard lock(mutex_);
+
+    stopped_ = true;
+    changed_.notify_all();
+}
+
+bool Executor::Threads::Stopped() const {
+    return stopped_;
+}
+
+std::vector<std::shared_ptr<Executor::Storage>> Executor::Threads::Stop() {
+    Cancel();
+
+    // the running threads may spawn more threads until they are stopped,
+    // which are added after them and thus are joined after them
+    for (size_t id = 1;; ++id) {
+        std::thread host;
+
+        {
+            const std::lock_guard lock(mutex_);
+            if (id >= contexts_.size()) {
+                break;
+            }
+
+            host = std::move(contexts_.at(id).host);
+        }
+
+        if (host.joinable()) {
+            host.join();
+        }
+    }
+
+    const std::lock_guard lock(mutex_);
+
+    std::vector<std::shared_ptr<Storage>> storages;
+    for (size_t id = 1; id < contexts_.size(); ++id) {
+        storages.push_back(std::move(contexts_.at(id).storage));
+    }
+
+    contexts_.resize(1);
+    contexts_.front() = {};
+    multithreaded_    = false;
+
+    paused_  = true;
+    stopped_ = false;
+    running_ = 0;
+    sliced_  = false;
+    fuel_    = 0;
+
+    blocked_   = nullptr;
+    error_     = nullptr;
+    failed_at_ = 0;
+
+    const std::lock_guard code_writes_lock(code_writes_mutex_);
+
+    code_writes_.clear();
+    code_writes_begin_ = 0;
+    code_writes_end_   = 0;
+
+    return storages;
+}
+
+std::optional<uint64_t> Executor::Threads::StartTurn(Id id) {
+    std::unique_lock lock(mutex_);
+
+    // the waiting threads do not spend the fuel of the slice
+    // on executing the JOIN system call again
+    while (!stopped_) {
+        if (!paused_ && !IsWaiting(id)) {
+            uint64_t turn = kQuantum;
+
+            if (sliced_) {
+                turn = std::min(fuel_, kQuantum);
+                fuel_ -= turn;
+            }
+
+            if (turn != 0) {
+                contexts_.at(id).state = RUNNING;
+
+                ++running_;
+                return turn;
+            }
+
+            // the slice is over, so the threads are paused
+            // until the next one
+            paused_ = true;
+            changed_.notify_all();
+        }
+
+        // the main thread stops the slice
+        // rather than waits for the next one
+        if (id == 0 && paused_) {
+            break;
+        }
+
+        changed_.wait(lock);
+    }
+
+    return std::nullopt;
+}
+
+void Executor::Threads::EndTurn(uint64_t unspent) {
+    const std::lock_guard lock(mutex_);
+
+    if (sliced_) {
+        fuel_ += unspent;
+    }
+
+    --running_;
+    changed_.notify_all();
+}
+
+std::pair<std::exception_ptr, arch::Address> Executor::Threads::Error() {
+    const std::lock_guard lock(mutex_);
+    return {error_, failed_at_};
+}
+
+std::optional<arch::Word> Executor::Threads::TryJoin(Id current, Id joined) {
+    const std::lock_guard lock(mutex_);
+
+    // the main thread finishes the whole execution,
+    // so it is never waited for
+    if (joined == 0 || joined == current || joined >= contexts_.size() ||
+        contexts_.at(joined).state == JOINED) {
+        throw ExecutionError::InvalidThread(joined);
+    }
+
+    Context& waited = contexts_.at(joined);
+    if (waited.state == FINISHED) {
+        waited.state = JOINED;
+        return waited.return_code;
+    }
+
+    // the threads never wait for each other in a cycle, so the chain
+    // of the waiting threads ends unless it leads to the current one
+    for (Id id = joined; contexts_.at(id).state == JOINING;) {
+        id = contexts_.at(id).joined;
+
+        if (id == current) {
+            throw ExecutionError::ThreadsDeadlocked();
+        }
+    }
+
+    Context& context = contexts_.at(current);
+    context.state    = JOINING;
+    context.joined   = joined;
+
+    return std::nullopt;
+}
+
+void Executor::Threads::Wait(Id id) {
+    std::unique_lock lock(mutex_);
+
+    if (contexts_.at(id).state != JOINING) {
+        lock.unlock();
+        std::this_thread::yield();
+        return;
+    }
+
+    // the JOIN system call is executed again once the joined thread
+    // has finished, so the thread keeps waiting in the next slice
+    // if this one is over before that
+    changed_.wait(lock,
+                  [this, id] { return !IsWaiting(id) || paused_ || stopped_; });
+}
+
+std::mutex& Executor::Threads::Devices() {
+    return devices_;
+}
+
+void Executor::Threads::WriteCode(const CodeWrites& writes) {
+    const std::lock_guard lock(code_writes_mutex_);
+
+    if (code_writes_.size() + writes.size() > kMaxCodeWrites) {
+        code_writes_begin_ += code_writes_.size();
+        code_writes_.clear();
+    }
+
+    code_writes_.insert(code_writes_.end(), writes.begin(), writes.end());
+
+    // the written words are seen by the threads which have seen the writes
+    code_writes_end_.store(code_writes_begin_ + code_writes_.size(),
+                           std::memory_order_release);
+}
+
+uint64_t Executor::Threads::ReadCodeWrites(uint64_t read,
+                                           DecodeCache& decode_cache) {
+    // the threads mostly do not modify the code,
+    // so the lock is only taken if there are new writes
+    if (code_writes_end_.load(std::memory_order_acquire) == read) {
+        return read;
+    }
+
+    const std::lock_guard lock(code_writes_mutex_);
+
+    if (read < code_writes_begin_) {
+        decode_cache.Invalidate(0, decode_cache.Size());
+        read = code_writes_begin_;
+    }
+
+    for (size_t i = read - code_writes_begin_; i < code_writes_.size(); ++i) {
+        const auto [address, size] = code_writes_[i];
+        decode_cache.Invalidate(address, size);
+    }
+
+    return code_writes_begin_ + code_writes_.size();
+}
+
+}  // namespace karma
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <atomic>              // for atomic
+#include <chrono>              // for milliseconds
+#include <condition_variable>  // for condition_variable
+#include <cstddef>             // for size_t
+#include <cstdint>             // for uint8_t, uint64_t
+#include <exception>           // for exception_ptr
+#include <functional>          // for function
+#include <memory>              // for shared_ptr
+#include <mutex>               // for mutex
+#include <optional>            // for optional
+#include <thread>              // for thread
+#include <utility>             // for pair
+#include <vector>              // for vector
+
+#include "executor/decode_cache.hpp"
+#include "executor/errors.hpp"
+#include "executor/executor.hpp"
+#include "specs/architecture.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the hardware threads of an execution (see the SPAWN, JOIN and YIELD system
+// calls), which share the memory of the Karma computer, but have their own
+// registers, flags and stacks
+//
+// each spawned thread is run on its own host thread with its own Storage
+// and TableExecutor instances, while the main thread is run by the Impl class,
+// all the threads run in turns of at most kQuantum commands, between which
+// they are paused at the end of a slice or wait for another thread,
+// so this class mostly coordinates the threads between their turns
+//
+// the threads check if the execution is stopped and invalidate
+// the commands written by the other threads at the boundaries of
+// their blocks (see the Storage::Synchronize method), so a stopped thread
+// does not finish its turn, and the code modified by a thread is seen
+// by the others once they reach the next block
+class Executor::Threads : detail::utils::traits::NonCopyableMovable {
+   private:
+    using ExecutionError = errors::executor::ExecutionError::Builder;
+    using Word           = detail::specs::arch::Word;
+
+   public:
+    // the index of the thread in the order of spawning,
+    // the main thread of the execution is 0
+    using Id = Word;
+
+    enum State : uint8_t {
+        RUNNING,
+
+        // waits for another thread to finish (the JOIN system call)
+        JOINING,
+
+        // has finished, but has not been joined yet
+        FINISHED,
+
+        JOINED,
+    };
+
+    static constexpr size_t kMaxThreads = 64;
+
+    // the number of the commands a thread executes before checking
+    // if its slice is over or another thread is to take a turn
+    static constexpr uint64_t kQuantum = 10'000;
+
+    // the interval the threads waiting for a signal or for the input
+    // check if the execution is stopped at
+    static constexpr std::chrono::milliseconds kPollInterval{10};
+
+    // the code segment writes are only kept until there are as many of them,
+    // the threads which have not read them yet invalidate all their commands
+    static constexpr size_t kMaxCodeWrites = 1 << 12;
+
+   private:
+    struct Context {
+        // the storage the thread is run on, the main thread is run
+        // on the storage owning this object, so it is not stored
+        std::shared_ptr<Storage> storage;
+        std::thread host;
+
+        State state{RUNNING};
+
+        // the thread waited for in the JOINING state
+        Id joined{0};
+
+        // the code the thread has finished with
+        Word return_code{0};
+    };
+
+   private:
+    // runs the turns of the spawned thread on its host thread
+    // until it finishes or the execution is stopped
+    void Run(Id, const std::shared_ptr<Storage>&);
+
+    // the thread is joining a thread which has not finished yet
+    [[nodiscard]] bool IsWaiting(Id) const;
+
+    // the thread has failed with the error at the address,
+    // so the whole execution is stopped
+    void Fail(std::exception_ptr, detail::specs::arch::Address);
+
+   public:
+    Threads() = default;
+
+    // the storages of the spawned threads may outlive the executions
+    // paused by a slice, so they are stopped at the latest here
+    ~Threads();
+
+    // the execution has spawned at least one thread,
+    // even if all of them have already finished
+    [[nodiscard]] bool IsMultithreaded() const;
+
+    // starts the thread on the storage created by the function for its id,
+    // the thread only takes its first turn once the threads are resumed
+    Id Spawn(const std::function<std::shared_ptr<Storage>(Id)>& create);
+
+    // makes the threads take their turns, the turns of a sliced execution
+    // share the fuel, which is the number of the commands left in the slice
+    void Resume(bool sliced, uint64_t fuel);
+
+    // pauses the threads at the end of their current turns (i.e. stops
+    // the slice) and waits for them, returns the storage of the spawned thread
+    // which has stopped the slice by blocking (if any)
+    std::shared_ptr<Storage> Pause();
+
+    // the spawned thread is blocked on the HALT command or the input,
+    // so the slice is stopped
+    void Block(Id);
+
+    // makes the threads stop at the boundaries of their current blocks
+    // without waiting for them
+    void Cancel();
+
+    [[nodiscard]] bool Stopped() const;
+
+    // cancels the threads, waits for them to finish, and returns
+    // the storages they have been run on, only the main thread is left
+    // afterwards
+    std::vector<std::shared_ptr<Storage>> Stop();
+
+    // returns the number of the commands of the next turn of the thread,
+    // the main thread gets std::nullopt once the threads are paused
+    // or stopped, while the spawned ones wait until they are resumed
+    // and only get it once they are stopped
+    std::optional<uint64_t> StartTurn(Id);
+
+    // returns the fuel not spent by the turn to the slice
+    void EndTurn(uint64_t unspent);
+
+    // the error a spawned thread has failed with (if any)
+    // and the address of the command it has failed at
+    [[nodiscard]] std::pair<std::exception_ptr, detail::specs::arch::Address>
+    Error();
+
+    // returns the return code of the finished thread, otherwise the current
+    // thread starts waiting for it and std::nullopt is returned
+    std::optional<Word> TryJoin(Id current, Id joined);
+
+    // waits for the thread joined by the current one to finish
+    // or for the threads to be paused or stopped, and lets the other threads
+    // run if the current one is only yielding to them
+    void Wait(Id);
+
+    // the input and the output devices are shared by the threads,
+    // so the system calls using them are serialized
+    std::mutex& Devices();
+
+    // the ranges of the code segment (the addresses and the sizes)
+    // the thread has written to, which have already been stored
+    using CodeWrites =
+        std::vector<std::pair<detail::specs::arch::Address, size_t>>;
+
+    void WriteCode(const CodeWrites&);
+
+    // invalidates the commands of the decode cache written by the threads
+    // after the specified number of the code segment writes,
+    // and returns the number of the writes the cache is up to date with
+    uint64_t ReadCodeWrites(uint64_t read, DecodeCache&);
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+
+    std::vector<Context> contexts_{1};
+    std::atomic<bool> multithreaded_{false};
+
+    bool paused_{true};
+
+    // is also read by the threads without the lock
+    // (see the Storage::Synchronize method)
+    std::atomic<bool> stopped_{false};
+
+    // the number of the threads in the middle of their turns
+    size_t running_{0};
+
+    bool sliced_{false};
+    uint64_t fuel_{0};
+
+    // the first spawned thread which has stopped the current slice by blocking
+    std::shared_ptr<Storage> blocked_;
+
+    std::exception_ptr error_;
+    detail::specs::arch::Address failed_at_{0};
+
+    std::mutex devices_;
+
+    // the ranges of the code segment written by the threads, the first one
+    // is the write number code_writes_begin_, the total number of the writes
+    // is also read by the threads without the lock
+    std::mutex code_writes_mutex_;
+    CodeWrites code_writes_;
+    uint64_t code_writes_begin_{0};
+    std::atomic<uint64_t> code_writes_end_{0};
+};
+
+}  // namespace karma
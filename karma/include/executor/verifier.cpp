@@ -0,0 +1,93 @@
+#include "verifier.hpp"
+
+#include "executor/decode_cache.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "utils/types.hpp"
+
+namespace karma {
+
+namespace utils = detail::utils;
+namespace arch  = detail::specs::arch;
+namespace cmd   = detail::specs::cmd;
+namespace args  = cmd::args;
+
+bool Executor::Verifier::HasPair(args::Register reg) {
+    return reg + 1 < arch::kNRegisters;
+}
+
+bool Executor::Verifier::IsProven(const Instruction& instr) {
+    // the register operands are 4-bit fields, so a single register
+    // always exists, and the address operands are 20-bit fields,
+    // so a single address (including a jump target) is always in the memory
+    switch (instr.code) {
+        case cmd::ADD:
+        case cmd::ADDI:
+        case cmd::SUB:
+        case cmd::SUBI:
+        case cmd::NOT:
+        case cmd::AND:
+        case cmd::ANDI:
+        case cmd::OR:
+        case cmd::ORI:
+        case cmd::XOR:
+        case cmd::XORI:
+        case cmd::CMP:
+        case cmd::CMPI:
+        case cmd::JMP:
+        case cmd::JNE:
+        case cmd::JEQ:
+        case cmd::JLE:
+        case cmd::JL:
+        case cmd::JGE:
+        case cmd::JG:
+        case cmd::LC:
+        case cmd::LA:
+        case cmd::MOV:
+        case cmd::LOAD:
+        case cmd::STORE: {
+            return true;
+        }
+
+        // the product and the real values occupy two registers
+
+        case cmd::MUL:
+        case cmd::MULI:
+        case cmd::ITOD: {
+            return HasPair(instr.recv);
+        }
+
+        case cmd::ADDD:
+        case cmd::SUBD:
+        case cmd::MULD:
+        case cmd::CMPD: {
+            return HasPair(instr.recv) && HasPair(instr.src);
+        }
+
+        case cmd::SHLI:
+        case cmd::SHRI: {
+            return instr.operand < sizeof(arch::Word) * utils::types::kByteSize;
+        }
+
+        case cmd::LOAD2:
+        case cmd::STORE2: {
+            return HasPair(instr.recv) && instr.operand + 1 < arch::kMemorySize;
+        }
+
+        // the rest of the commands depend on the values of the registers
+        // (the divisions, the shifts by a register, the register-relative
+        // addresses and the stack operations), perform the system calls
+        // or are unknown, so they are always checked
+        default: {
+            return false;
+        }
+    }
+}
+
+void Executor::Verifier::Verify(DecodeCache& decoded) {
+    for (arch::Address address = 0; address < decoded.Size(); ++address) {
+        decoded.SetVerified(address, IsProven(decoded.Get(address)));
+    }
+}
+
+}  // namespace karma
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "executor/decode_cache.hpp"
+#include "executor/executor.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+// the load-time pass proving that the commands cannot fail regardless
+// of the state of the Karma computer, provided that the config specifies
+// no access blocks (see the Storage::Verified policy)
+class Executor::Verifier : detail::utils::traits::Static {
+   private:
+    using Instruction = DecodeCache::Instruction;
+
+   private:
+    // the second register of a pair exists, i.e. the register is not r15
+    static bool HasPair(detail::specs::cmd::args::Register);
+
+   public:
+    // true if the command only accesses the existing registers and
+    // the addresses inside the memory, and its execution cannot result
+    // in any other error (e.g. a division by zero or a too big shift)
+    static bool IsProven(const Instruction&);
+
+    // classifies each command of the decoded code segment
+    static void Verify(DecodeCache&);
+};
+
+}  // namespace karma
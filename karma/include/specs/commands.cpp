@@ -1,8 +1,10 @@
 #include "commands.hpp"
 
+#include <cstdint>        // for uint8_t
 #include <string>         // for string
 #include <unordered_map>  // for unordered_map
 #include <unordered_set>  // for unordered_set
+#include <vector>         // for vector
 
 #include "specs/architecture.hpp"
 #include "utils/map.hpp"
@@ -108,6 +110,18 @@ const std::unordered_map<Code, Format> kCodeToFormat = {
     {CALL,    RR},
     {CALLI,   J },
     {RET,     J },
+
+ // Atomic operations
+
+    {CAS,     RR},
+    {XADD,    RR},
+
+ // Bulk memory operations
+
+    {MCOPY,   RR},
+    {MFILL,   RR},
+    {MCMP,    RR},
+    {MFIND,   RR},
 };
 
 const std::unordered_map<std::string, Code> kNameToCode = {
@@ -192,6 +206,18 @@ const std::unordered_map<std::string, Code> kNameToCode = {
     {"call",    CALL   },
     {"calli",   CALLI  },
     {"ret",     RET    },
+
+ // Atomic operations
+
+    {"cas",     CAS    },
+    {"xadd",    XADD   },
+
+ // Bulk memory operations
+
+    {"mcopy",   MCOPY  },
+    {"mfill",   MFILL  },
+    {"mcmp",    MCMP   },
+    {"mfind",   MFIND  },
 };
 
 const std::unordered_map<Code, std::string> kCodeToName =
@@ -229,6 +255,45 @@ args::JArgs J(Bin command) {
     };
 }
 
+args::AnyArgs Any(Bin command) {
+    const Code code = GetCode(command);
+    if (!kCodeToFormat.contains(code)) {
+        return {.recv = 0, .src = 0, .operand = 0};
+    }
+
+    switch (kCodeToFormat.at(code)) {
+        case cmd::RM: {
+            const args::RMArgs args = RM(command);
+            return {.recv = args.reg, .src = 0, .operand = args.addr};
+        }
+
+        case cmd::RR: {
+            const args::RRArgs args = RR(command);
+            return {
+                .recv    = args.recv,
+                .src     = args.src,
+                .operand = static_cast<arch::Word>(args.mod),
+            };
+        }
+
+        case cmd::RI: {
+            const args::RIArgs args = RI(command);
+            return {
+                .recv    = args.reg,
+                .src     = 0,
+                .operand = static_cast<arch::Word>(args.imm),
+            };
+        }
+
+        case cmd::J: {
+            const args::JArgs args = J(command);
+            return {.recv = 0, .src = 0, .operand = args.addr};
+        }
+    }
+
+    return {.recv = 0, .src = 0, .operand = 0};
+}
+
 }  // namespace parse
 
 namespace build {
@@ -259,4 +324,29 @@ Bin J(Code code, args::JArgs args) {
 
 }  // namespace build
 
+void MarkLeaders(Code code,
+                 arch::Word operand,
+                 arch::Address address,
+                 std::vector<uint8_t>& leaders) {
+    if (!kCodeToFormat.contains(code)) {
+        return;
+    }
+
+    const bool is_jump = kCodeToFormat.at(code) == J;
+    if (!is_jump && code != CALL) {
+        return;
+    }
+
+    // the operands of the PRC and the RET commands are not addresses,
+    // so they do not split the blocks
+    const bool has_target = is_jump && code != PRC && code != RET;
+    if (has_target && operand < leaders.size()) {
+        leaders[operand] = 1;
+    }
+
+    if (address + 1 < leaders.size()) {
+        leaders[address + 1] = 1;
+    }
+}
+
 }  // namespace karma::detail::specs::cmd
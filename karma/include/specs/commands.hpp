@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cstdint>        // for uint8_t
 #include <limits>         // for numeric_limits
 #include <string>         // for string
 #include <type_traits>    // for make_signed_t
 #include <unordered_map>  // for unordered_map
 #include <unordered_set>  // for unordered_set
+#include <vector>         // for vector
 
 #include "specs/architecture.hpp"
 
@@ -104,6 +106,18 @@ enum Code : Bin {
     CALL,
     CALLI,
     RET,
+
+    // Atomic operations
+
+    CAS,
+    XADD,
+
+    // Bulk memory operations
+
+    MCOPY,
+    MFILL,
+    MCMP,
+    MFIND,
 };
 
 struct CodeFormat {
@@ -156,6 +170,16 @@ struct JArgs {
     Address addr;
 };
 
+// the operands of a command of any format in a single layout: the register
+// operand of the RM and RI formats commands is put to the receiver, and
+// the address, the sign-extended modifier or the sign-extended immediate
+// is put to the operand
+struct AnyArgs {
+    Receiver recv;
+    Source src;
+    arch::Word operand;
+};
+
 }  // namespace args
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +200,10 @@ enum Code : cmd::args::Immediate {
     PRINTDOUBLE = 103,
     GETCHAR     = 104,
     PUTCHAR     = 105,
+    SNAPSHOT    = 106,
+    SPAWN       = 107,
+    JOIN        = 108,
+    YIELD       = 109,
 };
 
 }  // namespace syscall
@@ -191,6 +219,9 @@ args::RRArgs RR(Bin);
 args::RIArgs RI(Bin);
 args::JArgs J(Bin);
 
+// the operands of an unknown command are all zeros
+args::AnyArgs Any(Bin);
+
 }  // namespace parse
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -206,4 +237,17 @@ Bin J(Code, args::JArgs);
 
 }  // namespace build
 
+////////////////////////////////////////////////////////////////////////////////
+///                               Control flow                               ///
+////////////////////////////////////////////////////////////////////////////////
+
+// marks the basic blocks leaders following from the command at the address
+// (the target of a J format command other than PRC and RET and the command
+// following a J format or a CALL command) among the leaders of the code
+// of the leaders size
+void MarkLeaders(Code,
+                 arch::Word operand,
+                 arch::Address,
+                 std::vector<uint8_t>& leaders);
+
 }  // namespace karma::detail::specs::cmd
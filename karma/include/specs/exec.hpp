@@ -16,4 +16,34 @@ constexpr size_t kHeaderSize     = 512;
 constexpr size_t kCodeSegmentPos = kHeaderSize;
 const arch::Word kProcessorID    = 239;
 
+// the versioned layout, in which the header is followed by the section table
+// and the contents of the sections (see the exec directory README)
+
+// has the same size as the intro string of the original layout
+const std::string kVersionedIntroString = "KarmaExecutable";
+constexpr arch::Word kVersion           = 2;
+const size_t kVersionedHeaderSize       = kIntroSize + 5 * arch::kWordSize;
+constexpr size_t kSectionEntrySize      = 5 * arch::kWordSize;
+
+enum Section : arch::Word {
+    CODE      = 1,
+    CONSTANTS = 2,
+
+    // the zero-initialized words following the constants,
+    // which are only described by their number
+    ZEROS = 3,
+
+    // the debug info of the program, which is not loaded into the memory
+    SYMBOLS = 4,
+};
+
+enum Encoding : arch::Word {
+    RAW = 0,
+
+    // the runs of equal words, each one is stored as a pair of LEB128
+    // varints (the length of the run and the word), which compacts
+    // the strings (a word per character) and the tables of small numbers
+    VARINT = 1,
+};
+
 }  // namespace karma::detail::specs::exec
@@ -0,0 +1 @@
+#include "native.hpp"
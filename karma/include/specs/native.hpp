@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int32_t, uint8_t, uint32_t, uint64_t
+
+#include "specs/architecture.hpp"
+
+namespace karma::detail::specs::native {
+
+// the interface between the executor and the native modules (the shared
+// objects produced by the translator from the Karma executable files),
+// the translator emits the same declarations in C, so the kAbiVersion
+// is to be incremented on any change of the declarations below
+
+constexpr uint32_t kAbiVersion = 1;
+
+// the symbols exported by a native module
+constexpr const char* kAbiSymbol      = "karma_native_abi";
+constexpr const char* kCodeSizeSymbol = "karma_native_code_size";
+constexpr const char* kCodeSymbol     = "karma_native_code";
+constexpr const char* kRunSymbol      = "karma_native_run";
+
+// the native code marks the pages of the memory it writes to
+// (the page number is the address shifted by this value)
+constexpr size_t kPageShift = 10;
+
+enum Status : int32_t {
+    // the current command is not the first command of a translated block,
+    // so it is left for the executor, no command has been executed
+    UNHANDLED = 0,
+
+    // the execution has left the translated code at the current command
+    LEFT = 1,
+
+    // the step function has requested to stop the native execution
+    STOPPED = 2,
+};
+
+struct Context {
+    arch::Word* registers;
+    arch::Word* flags;
+    arch::Word* memory;
+    uint8_t* dirty_pages;
+
+    // the number of the retired commands per their code
+    uint64_t* retired;
+
+    uint64_t memory_reads;
+    uint64_t memory_writes;
+    uint64_t calls;
+    uint64_t returns;
+
+    // the stores below the code end are left for the step function,
+    // so that the modification of the code is noticed by the executor,
+    // and so are the pushes below the stack limit (which also includes
+    // the stack bound of the execution)
+    arch::Address code_end;
+    arch::Address stack_limit;
+
+    // the lowest stack pointer value a push has been performed at
+    arch::Address lowest_push;
+
+    // the executor the step function belongs to
+    void* executor;
+
+    // executes the command at the specified address the same way
+    // as the executor does, returns non-zero to stop the native execution
+    int32_t (*step)(Context*, arch::Address);
+};
+
+// the entry of a native module, which executes the translated code
+// starting from the command pointed to by the instruction register
+using Run = int32_t (*)(Context*);
+
+}  // namespace karma::detail::specs::native
@@ -0,0 +1,389 @@
+#include <gtest/gtest.h>
+
+#include <array>       // for array
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t, uint64_t
+#include <exception>   // for exception
+#include <filesystem>  // for path, temp_directory_path, create_directories
+#include <fstream>     // for ofstream
+#include <memory>      // for make_shared
+#include <span>        // for span
+#include <string>      // for string, to_string
+#include <utility>     // for pair
+#include <vector>      // for vector
+
+//
+#include "karma"
+
+namespace karma::test::impl {
+
+namespace {
+
+using Config = Executor::Config;
+
+// the limits of the native routines (see the executor/intrinsics.cpp file)
+constexpr size_t kMaxPrecision = 1 << 12;
+constexpr size_t kMaxTextSize  = 1 << 20;
+
+constexpr std::array kAllEngines = {Config::MAPPED, Config::TABLE, Config::JIT};
+
+// an argument of a routine: the command loading it to r0 (la, load
+// or load2, the latter pushes the two words in (r1,r0)) and the label
+using Argument = std::pair<std::string, std::string>;
+
+struct Result {
+    std::string output;
+    std::string error;
+    uint32_t return_code{0};
+    uint64_t intrinsic_calls{0};
+};
+
+std::filesystem::path TestDirectory() {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "karma_test" /
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+std::string Write(const std::filesystem::path& path, const std::string& code) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << code;
+    return path.string();
+}
+
+// the main routine of a program including the whole printing library
+std::string Program(const std::string& constants,
+                    const std::string& main,
+                    const std::string& library = KARMA_PROGRAMS_DIRECTORY
+                    "/print/printf.krm") {
+    return "include " + library + "\n\n" + constants + "\nmain:\n" + main +
+           "    lc r0 0\n"
+           "    syscall r0 0\n"
+           "end main\n";
+}
+
+// calls the routine with the arguments (the first one is pushed last),
+// setting each general purpose register rN to 1000 + N right before the call
+std::string Call(const std::string& routine,
+                 const std::vector<Argument>& arguments = {}) {
+    std::string code = "    prc 0\n";
+    for (auto argument = arguments.rbegin(); argument != arguments.rend();
+         ++argument) {
+        const auto& [command, label] = *argument;
+
+        code += "    " + command + " r0 " + label + "\n";
+        if (command == "load2") {
+            code += "    push r1 0\n";
+        }
+        code += "    push r0 0\n";
+    }
+
+    for (size_t reg = 0; reg <= 12; ++reg) {
+        code += "    lc r" + std::to_string(reg) + " " +
+                std::to_string(1000 + reg) + "\n";
+    }
+
+    return code + "    calli " + routine + "\n";
+}
+
+// prints the registers from the first one to the last one
+std::string PrintRegisters(size_t first, size_t last) {
+    std::string code;
+    for (size_t reg = first; reg <= last; ++reg) {
+        code += "    syscall r" + std::to_string(reg) + " 102\n";
+    }
+
+    return code;
+}
+
+Result Execute(const Executor::Program& program,
+               Config::Engine engine,
+               bool intrinsics) {
+    auto output = std::make_shared<Executor::StringOutput>();
+    auto stats  = std::make_shared<Executor::ExecutionStats>();
+
+    Config config;
+    config.SetEngine(engine);
+    config.SetIntrinsics(intrinsics);
+    config.SetOutput(output);
+    config.SetStats(stats);
+
+    Result result;
+    try {
+        Executor executor;
+        result.return_code = executor.MustExecute(program, config);
+    } catch (const std::exception& error) {
+        result.error = error.what();
+    }
+
+    result.output          = output->Data();
+    result.intrinsic_calls = stats->intrinsic_calls;
+    return result;
+}
+
+// executes the program with and without the intrinsics by each engine,
+// expects the same results and returns the number of the native calls
+uint64_t ExecuteBothWays(const std::string& code,
+                         std::span<const Config::Engine> engines = kAllEngines) {
+    const Executor::Program program = Executor::Program::MustCompile(
+        Write(TestDirectory() / "main.krm", code));
+
+    uint64_t intrinsic_calls = 0;
+    for (const Config::Engine engine : engines) {
+        const Result interpreted = Execute(program, engine, false);
+        const Result native      = Execute(program, engine, true);
+
+        EXPECT_EQ(interpreted.intrinsic_calls, 0);
+        EXPECT_EQ(interpreted.output, native.output);
+        EXPECT_EQ(interpreted.error, native.error);
+        EXPECT_EQ(interpreted.return_code, native.return_code);
+
+        intrinsic_calls += native.intrinsic_calls;
+    }
+
+    return intrinsic_calls;
+}
+
+}  // namespace
+
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+TEST(Intrinsics, PreservedRegisters) {
+    const std::string constants =
+        ".char:   char 'k'\n"
+        ".string: string \"karma\\n\"\n"
+        ".format: string \"%c %s %u %d %lx %lf\\n\"\n"
+        ".base:   uint32 16\n"
+        ".int32:  uint32 -12345\n"
+        ".int64:  uint64 -1234567890123\n"
+        ".double: double -2.71828\n"
+        ".precision: uint32 7\n";
+
+    // the registers each routine does not write, the 64-bit integer
+    // routines write all of them (see the programs/print directory)
+    const std::vector<std::pair<std::string, std::pair<size_t, size_t>>>
+        cases = {
+            {Call("print_newline"),                            {1, 12} },
+            {Call("print_char", {{"load", ".char"}}),          {1, 12} },
+            {Call("print_string", {{"la", ".string"}}),        {2, 12} },
+            {Call("print_uint32",
+                  {{"load", ".base"}, {"load", ".int32"}}),    {3, 12} },
+            {Call("print_uint32_decimal", {{"load", ".int32"}}),
+             {3, 12}                                                     },
+            {Call("print_int32",
+                  {{"load", ".base"}, {"load", ".int32"}}),    {4, 12} },
+            {Call("print_int32_decimal", {{"load", ".int32"}}), {4, 12}},
+            {Call("print_uint64",
+                  {{"load", ".base"}, {"load2", ".int64"}}),   {13, 12}},
+            {Call("print_uint64_decimal", {{"load2", ".int64"}}),
+             {13, 12}                                                    },
+            {Call("print_int64",
+                  {{"load", ".base"}, {"load2", ".int64"}}),   {13, 12}},
+            {Call("print_int64_decimal", {{"load2", ".int64"}}),
+             {13, 12}                                                    },
+            {Call("print_double",
+                  {{"load", ".base"},
+                   {"load2", ".double"},
+                   {"load", ".precision"}}),                   {9, 9}  },
+            {Call("print_double_decimal",
+                  {{"load2", ".double"}, {"load", ".precision"}}),
+             {9, 9}                                                      },
+            {Call("print_double_default_precision",
+                  {{"load", ".base"}, {"load2", ".double"}}),  {9, 9}  },
+            {Call("print_double_decimal_default_precision",
+                  {{"load2", ".double"}}),                     {9, 9}  },
+    };
+
+    for (const auto& [call, registers] : cases) {
+        SCOPED_TRACE(call);
+
+        const auto [first, last] = registers;
+        EXPECT_GT(ExecuteBothWays(Program(
+                      constants, call + PrintRegisters(first, last))),
+                  0);
+    }
+
+    // printf calls all the other routines, so it does not preserve anything
+    const std::string printf = Call("printf",
+                                    {
+                                        {"la",    ".format"},
+                                        {"load",  ".char"  },
+                                        {"la",    ".string"},
+                                        {"load",  ".int32" },
+                                        {"load",  ".int32" },
+                                        {"load2", ".int64" },
+                                        {"load2", ".double"},
+    });
+    EXPECT_GT(ExecuteBothWays(Program(constants, printf)), 0);
+}
+
+TEST(Intrinsics, ClobberedRegisters) {
+    const std::string constants =
+        ".char:   char 'k'\n"
+        ".string: string \"karma\"\n";
+
+    // the character is left in r0
+    EXPECT_EQ(ExecuteBothWays(Program(
+                  constants,
+                  Call("print_char", {{"load", ".char"}}) + PrintRegisters(0, 0))),
+              0);
+
+    // the terminator of the string is left in r1
+    EXPECT_EQ(ExecuteBothWays(Program(constants,
+                                      Call("print_string", {{"la", ".string"}}) +
+                                          PrintRegisters(1, 1))),
+              0);
+
+    // the flags are left equal after comparing the terminator with zero
+    EXPECT_EQ(ExecuteBothWays(Program(constants,
+                                      "    cmpi r0 1\n" +
+                                          Call("print_string", {{"la", ".string"}}) +
+                                          "    jeq main.equal\n"
+                                          "    syscall r2 102\n"
+                                          "main.equal:\n")),
+              0);
+
+    // the register is read after the return of the calling routine
+    const std::string print = "print:\n" + Call("print_char", {{"load", ".char"}}) +
+                              "    ret 0\n";
+    EXPECT_EQ(ExecuteBothWays(Program(constants + print,
+                                      "    prc 0\n"
+                                      "    calli print\n" +
+                                          PrintRegisters(0, 0))),
+              0);
+
+    // the same as the above, but the register is written first
+    EXPECT_GT(ExecuteBothWays(Program(constants + print,
+                                      "    prc 0\n"
+                                      "    calli print\n"
+                                      "    lc r0 1\n" +
+                                          PrintRegisters(0, 0))),
+              0);
+}
+
+TEST(Intrinsics, Bases) {
+    for (const size_t base : {1U, 2U, 10U, 36U, 37U}) {
+        SCOPED_TRACE(base);
+
+        const std::string constants = ".base: uint32 " + std::to_string(base) +
+                                      "\n"
+                                      ".value: uint32 1234567\n"
+                                      ".double: double 1234.5678\n";
+
+        // the invalid bases are reported by the interpreted routines,
+        // which print the error message natively before exiting
+        const size_t calls = (base >= 2 && base <= 36 ? 1 : 2) *
+                             kAllEngines.size();
+
+        EXPECT_EQ(ExecuteBothWays(Program(
+                      constants,
+                      Call("print_uint32",
+                           {{"load", ".base"}, {"load", ".value"}}))),
+                  calls);
+        EXPECT_EQ(ExecuteBothWays(Program(
+                      constants,
+                      Call("print_double_default_precision",
+                           {{"load", ".base"}, {"load2", ".double"}}))),
+                  calls);
+    }
+}
+
+TEST(Intrinsics, Precision) {
+    for (const size_t precision : {kMaxPrecision, kMaxPrecision + 1}) {
+        SCOPED_TRACE(precision);
+
+        const std::string constants = ".precision: uint32 " +
+                                      std::to_string(precision) +
+                                      "\n"
+                                      ".double: double 0.1\n";
+
+        // the larger precisions are left to the interpreted routine
+        EXPECT_EQ(ExecuteBothWays(Program(constants,
+                                          Call("print_double_decimal",
+                                               {{"load2", ".double"},
+                                                {"load", ".precision"}}))) > 0,
+                  precision <= kMaxPrecision);
+    }
+}
+
+TEST(Intrinsics, TextSize) {
+    // the string of the quarter of the maximal text size
+    // is written to the memory after the constants
+    const size_t size   = kMaxTextSize / 4 + 1;
+    const size_t string = size_t{1} << 18;
+
+    const std::string fill = "    lc r1 " + std::to_string(string) +
+                             "\n"
+                             "    lc r2 " +
+                             std::to_string(size) +
+                             "\n"
+                             "    lc r3 107\n"
+                             "    mfill r1 r3 0\n"
+                             "    add r1 r2 0\n"
+                             "    lc r3 0\n"
+                             "    storer r3 r1 0\n"
+                             "    lc r1 " +
+                             std::to_string(string) + "\n";
+
+    for (const size_t strings : {3U, 4U}) {
+        SCOPED_TRACE(strings);
+
+        std::string printf = "    prc 0\n";
+        for (size_t i = 0; i < strings; ++i) {
+            printf += "    push r1 0\n";
+        }
+        printf += "    la r0 .format\n"
+                  "    push r0 0\n"
+                  "    calli printf\n";
+
+        std::string constants = ".format: string \"";
+        for (size_t i = 0; i < strings; ++i) {
+            constants += "%s";
+        }
+        constants += "\"\n";
+
+        // the text produced by a single call is bounded, the longer one
+        // is printed by the interpreted routine, which prints each string
+        // by a native call
+        const Config::Engine engines[] = {Config::TABLE};
+        EXPECT_EQ(ExecuteBothWays(Program(constants, fill + printf), engines),
+                  strings * size <= kMaxTextSize ? 1 : strings);
+    }
+}
+
+TEST(Intrinsics, OwnRoutine) {
+    // the routine with the label and the file of the library,
+    // which prints each character twice
+    const std::string library = Write(TestDirectory() / "print" / "string.krm",
+                                      "print_string:\n"
+                                      "    loadr r0 r14 3\n"
+                                      "    __print_string.loop:\n"
+                                      "        loadr r1 r0 0\n"
+                                      "        cmpi r1 0\n"
+                                      "        jeq __print_string.out\n"
+                                      "        syscall r1 105\n"
+                                      "        syscall r1 105\n"
+                                      "        addi r0 1\n"
+                                      "        jmp __print_string.loop\n"
+                                      "    __print_string.out:\n"
+                                      "        ret 0\n");
+
+    EXPECT_EQ(ExecuteBothWays(Program(".string: string \"karma\"\n",
+                                      Call("print_string", {{"la", ".string"}}),
+                                      library)),
+              0);
+}
+
+TEST(Intrinsics, OverwrittenConstant) {
+    // the newline character of the library is replaced
+    EXPECT_EQ(ExecuteBothWays(Program("",
+                                      "    lc r0 33\n"
+                                      "    store r0 .__char.newline\n" +
+                                          Call("print_newline"))),
+              0);
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
+
+}  // namespace karma::test::impl
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <array>       // for array
+#include <cstdint>     // for uint32_t, uint64_t
+#include <filesystem>  // for path, temp_directory_path, create_directories
+#include <fstream>     // for ofstream
+#include <memory>      // for make_shared
+#include <string>      // for string
+
+//
+#include "karma"
+
+namespace karma::test::impl {
+
+namespace {
+
+using Config = Executor::Config;
+
+constexpr std::array kAllEngines = {Config::MAPPED, Config::TABLE, Config::JIT};
+
+struct Result {
+    std::string output;
+    uint32_t return_code{0};
+    uint64_t instructions{0};
+    uint64_t memory_reads{0};
+    uint64_t memory_writes{0};
+};
+
+Executor::Program Compile(const std::string& code) {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "karma_test" /
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::create_directories(directory);
+
+    const std::filesystem::path path = directory / "main.krm";
+    std::ofstream(path) << code;
+
+    return Executor::Program::MustCompile(path.string());
+}
+
+Result Execute(const Executor::Program& program, Config::Engine engine) {
+    auto output = std::make_shared<Executor::StringOutput>();
+    auto stats  = std::make_shared<Executor::ExecutionStats>();
+
+    Config config;
+    config.SetEngine(engine);
+    config.SetOutput(output);
+    config.SetStats(stats);
+
+    Executor executor;
+    const uint32_t return_code = executor.MustExecute(program, config);
+
+    return {
+        .output        = output->Data(),
+        .return_code   = return_code,
+        .instructions  = stats->instructions,
+        .memory_reads  = stats->memory_reads,
+        .memory_writes = stats->memory_writes,
+    };
+}
+
+// runs the program by each engine and expects the same results
+// as those of the TABLE one, which never compiles the code
+void ExpectSameResults(const Executor::Program& program,
+                       const std::string& output) {
+    const Result expected = Execute(program, Config::TABLE);
+    EXPECT_EQ(expected.output, output);
+
+    for (const Config::Engine engine : kAllEngines) {
+        SCOPED_TRACE(engine);
+
+        const Result result = Execute(program, engine);
+        EXPECT_EQ(result.output, expected.output);
+        EXPECT_EQ(result.return_code, expected.return_code);
+        EXPECT_EQ(result.instructions, expected.instructions);
+        EXPECT_EQ(result.memory_reads, expected.memory_reads);
+        EXPECT_EQ(result.memory_writes, expected.memory_writes);
+    }
+}
+
+}  // namespace
+
+TEST(Jit, ModifiedCompiledBlock) {
+    // the first command of the hot loop is replaced once the loop
+    // has been compiled, so its block is compiled again
+    const Executor::Program program = Compile(
+        "replacement:\n"
+        "    addi r1 2\n"
+        "main:\n"
+        "    lc r1 0\n"
+        "    lc r2 0\n"
+        "loop:\n"
+        "    addi r1 1\n"
+        "    addi r2 1\n"
+        "    cmpi r2 1000\n"
+        "    jne skip\n"
+        "    load r3 replacement\n"
+        "    store r3 loop\n"
+        "skip:\n"
+        "    cmpi r2 2000\n"
+        "    jne loop\n"
+        "    mov r0 r1 0\n"
+        "    syscall r0 102\n"
+        "    lc r0 0\n"
+        "    syscall r0 0\n"
+        "end main\n");
+
+    ExpectSameResults(program, "3000");
+}
+
+TEST(Jit, ModifiedOtherCode) {
+    // the hot loop keeps modifying the command run after it,
+    // which does not belong to any compiled block
+    const Executor::Program program = Compile(
+        "replacement:\n"
+        "    lc r0 7\n"
+        "main:\n"
+        "    lc r1 0\n"
+        "    load r3 replacement\n"
+        "loop:\n"
+        "    addi r1 1\n"
+        "    store r3 result\n"
+        "    cmpi r1 2000\n"
+        "    jne loop\n"
+        "result:\n"
+        "    lc r0 3\n"
+        "    syscall r0 102\n"
+        "    lc r0 0\n"
+        "    syscall r0 0\n"
+        "end main\n");
+
+    ExpectSameResults(program, "7");
+}
+
+TEST(Jit, NewJumpInCompiledBlock) {
+    // the command in the middle of a compiled block of the hot loop
+    // is replaced with a jump leaving the loop, so the command following
+    // the jump becomes a leader
+    const Executor::Program program = Compile(
+        "replacement:\n"
+        "    jmp done\n"
+        "main:\n"
+        "    lc r1 0\n"
+        "loop:\n"
+        "    addi r1 1\n"
+        "    cmpi r1 1000\n"
+        "    jne body\n"
+        "    load r3 replacement\n"
+        "    store r3 middle\n"
+        "body:\n"
+        "    addi r2 1\n"
+        "middle:\n"
+        "    addi r1 0\n"
+        "    jmp loop\n"
+        "done:\n"
+        "    mov r0 r1 0\n"
+        "    syscall r0 102\n"
+        "    lc r0 0\n"
+        "    syscall r0 0\n"
+        "end main\n");
+
+    ExpectSameResults(program, "1000");
+}
+
+}  // namespace karma::test::impl
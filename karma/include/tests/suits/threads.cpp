@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <unistd.h>  // for pipe, close
+
+#include <array>       // for array
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t
+#include <filesystem>  // for path, temp_directory_path, create_directories
+#include <fstream>     // for ofstream
+#include <memory>      // for make_shared, shared_ptr
+#include <string>      // for string
+
+//
+#include "karma"
+
+namespace karma::test::impl {
+
+namespace {
+
+using Config = Executor::Config;
+
+constexpr std::array kAllEngines = {Config::MAPPED, Config::TABLE, Config::JIT};
+
+struct Result {
+    std::string output;
+    uint32_t return_code{0};
+};
+
+Executor::Program Compile(const std::string& code) {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "karma_test" /
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::create_directories(directory);
+
+    const std::filesystem::path path = directory / "main.krm";
+    std::ofstream(path) << code;
+
+    return Executor::Program::MustCompile(path.string());
+}
+
+Result Execute(const Executor::Program& program,
+               Config::Engine engine,
+               const std::shared_ptr<Executor::InputDevice>& input = nullptr) {
+    auto output = std::make_shared<Executor::StringOutput>();
+
+    Config config;
+    config.SetEngine(engine);
+    config.SetOutput(output);
+    if (input) {
+        config.SetInput(input);
+    }
+
+    Executor executor;
+    const uint32_t return_code = executor.MustExecute(program, config);
+
+    return {.output = output->Data(), .return_code = return_code};
+}
+
+}  // namespace
+
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+TEST(Threads, CodeModifiedByMainThread) {
+    // the main thread replaces the endless loop of the spawned one
+    // with the command setting its return code and joins it
+    const Executor::Program program = Compile(
+        "worker:\n"
+        "    jmp worker\n"
+        "    syscall r0 0\n"
+        "replacement:\n"
+        "    lc r0 7\n"
+        "main:\n"
+        "    la r0 worker\n"
+        "    lc r1 500000\n"
+        "    syscall r0 107\n"
+        "    load r1 replacement\n"
+        "    store r1 worker\n"
+        "    syscall r0 108\n"
+        "    syscall r0 102\n"
+        "    lc r0 0\n"
+        "    syscall r0 0\n"
+        "end main\n");
+
+    for (const Config::Engine engine : kAllEngines) {
+        SCOPED_TRACE(engine);
+
+        const Result result = Execute(program, engine);
+        EXPECT_EQ(result.output, "7");
+        EXPECT_EQ(result.return_code, 0);
+    }
+}
+
+TEST(Threads, CodeModifiedBySpawnedThread) {
+    // the same as the above, but the spawned thread ends the loop
+    // of the main one
+    const Executor::Program program = Compile(
+        "worker:\n"
+        "    load r1 replacement\n"
+        "    store r1 wait\n"
+        "    lc r0 0\n"
+        "    syscall r0 0\n"
+        "replacement:\n"
+        "    lc r0 7\n"
+        "main:\n"
+        "    la r0 worker\n"
+        "    lc r1 500000\n"
+        "    syscall r0 107\n"
+        "    mov r2 r0 0\n"
+        "wait:\n"
+        "    jmp wait\n"
+        "    syscall r0 102\n"
+        "    syscall r2 108\n"
+        "    syscall r2 0\n"
+        "end main\n");
+
+    for (const Config::Engine engine : kAllEngines) {
+        SCOPED_TRACE(engine);
+
+        const Result result = Execute(program, engine);
+        EXPECT_EQ(result.output, "7");
+        EXPECT_EQ(result.return_code, 0);
+    }
+}
+
+TEST(Threads, ExitStopsHaltedThread) {
+    const Executor::Program program = Compile(
+        "worker:\n"
+        "    halt r0 0\n"
+        "    syscall r0 0\n"
+        "main:\n"
+        "    la r0 worker\n"
+        "    lc r1 500000\n"
+        "    syscall r0 107\n"
+        "    syscall r0 109\n"
+        "    syscall r0 102\n"
+        "    lc r0 3\n"
+        "    syscall r0 0\n"
+        "end main\n");
+
+    for (const Config::Engine engine : kAllEngines) {
+        SCOPED_TRACE(engine);
+
+        const Result result = Execute(program, engine);
+        EXPECT_EQ(result.output, "1");
+        EXPECT_EQ(result.return_code, 3);
+    }
+}
+
+TEST(Threads, ExitStopsThreadWaitingForInput) {
+    const Executor::Program program = Compile(
+        "worker:\n"
+        "    syscall r0 100\n"
+        "    syscall r0 0\n"
+        "main:\n"
+        "    la r0 worker\n"
+        "    lc r1 500000\n"
+        "    syscall r0 107\n"
+        "    syscall r0 109\n"
+        "    syscall r0 102\n"
+        "    lc r0 3\n"
+        "    syscall r0 0\n"
+        "end main\n");
+
+    // the input never arrives, but is never over either
+    std::array<int, 2> fds{};
+    ASSERT_EQ(pipe(fds.data()), 0);
+
+    for (const Config::Engine engine : kAllEngines) {
+        SCOPED_TRACE(engine);
+
+        const Result result =
+            Execute(program, engine, std::make_shared<Executor::FdInput>(fds[0]));
+        EXPECT_EQ(result.output, "1");
+        EXPECT_EQ(result.return_code, 3);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(Threads, NoOutputAfterExit) {
+    // the spawned thread keeps printing while the main one
+    // prints the last character and exits
+    const Executor::Program program = Compile(
+        "worker:\n"
+        "    lc r0 120\n"
+        "    syscall r0 105\n"
+        "    jmp worker\n"
+        "main:\n"
+        "    la r0 worker\n"
+        "    lc r1 500000\n"
+        "    syscall r0 107\n"
+        "    lc r2 100\n"
+        "loop:\n"
+        "    syscall r0 109\n"
+        "    subi r2 1\n"
+        "    cmpi r2 0\n"
+        "    jne loop\n"
+        "    lc r0 69\n"
+        "    syscall r0 105\n"
+        "    lc r0 0\n"
+        "    syscall r0 0\n"
+        "end main\n");
+
+    constexpr size_t kRepeats = 3;
+
+    for (const Config::Engine engine : kAllEngines) {
+        SCOPED_TRACE(engine);
+
+        for (size_t i = 0; i < kRepeats; ++i) {
+            const Result result = Execute(program, engine);
+
+            ASSERT_FALSE(result.output.empty());
+            EXPECT_EQ(result.output.back(), 'E');
+        }
+    }
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
+
+}  // namespace karma::test::impl
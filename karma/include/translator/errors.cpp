@@ -0,0 +1,41 @@
+#include "errors.hpp"
+
+#include <cstring>  // for strerror
+#include <iomanip>  // for quoted
+#include <sstream>  // for ostringstream
+#include <string>   // for string
+
+namespace karma::errors::translator {
+
+using IE = InternalError;
+using TE = TranslateError;
+
+////////////////////////////////////////////////////////////////////////////////
+///                              Internal errors                             ///
+////////////////////////////////////////////////////////////////////////////////
+
+IE IE::Builder::FailedToOpen(const std::string& path) {
+    std::ostringstream ss;
+    ss << "failed to open " << std::quoted(path);
+    return IE{ss.str()};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                            Translation errors                            ///
+////////////////////////////////////////////////////////////////////////////////
+
+TE TE::Builder::CompilerNotStarted(const std::string& command, int error) {
+    std::ostringstream ss;
+    ss << "the C compiler command " << std::quoted(command)
+       << " could not be started: " << std::strerror(error);
+    return TE{ss.str()};
+}
+
+TE TE::Builder::CompilerFailed(const std::string& command, int status) {
+    std::ostringstream ss;
+    ss << "the C compiler command " << std::quoted(command)
+       << " failed with status " << status;
+    return TE{ss.str()};
+}
+
+}  // namespace karma::errors::translator
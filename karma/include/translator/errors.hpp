@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>  // for string
+
+#include "translator/translator.hpp"
+#include "utils/traits.hpp"
+
+namespace karma::errors::translator {
+
+struct InternalError::Builder : detail::utils::traits::Static {
+    static InternalError FailedToOpen(const std::string& path);
+};
+
+struct TranslateError::Builder : detail::utils::traits::Static {
+    static TranslateError CompilerNotStarted(const std::string& command,
+                                             int error);
+    static TranslateError CompilerFailed(const std::string& command,
+                                         int status);
+};
+
+}  // namespace karma::errors::translator
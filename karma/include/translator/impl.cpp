@@ -0,0 +1,716 @@
+#include "impl.hpp"
+
+#include <spawn.h>     // for posix_spawnp
+#include <sys/wait.h>  // for waitpid, WIFEXITED, WEXITSTATUS
+#include <unistd.h>    // for environ, pid_t
+
+#include <cerrno>      // for errno, EINTR
+#include <cstdint>     // for uint8_t
+#include <cstdlib>     // for getenv
+#include <exception>   // for exception
+#include <filesystem>  // for path
+#include <fstream>     // for ofstream
+#include <iomanip>     // for quoted
+#include <iostream>    // for cerr
+#include <ostream>     // for ostream
+#include <sstream>     // for ostringstream
+#include <string>      // for string
+#include <utility>     // for move
+#include <vector>      // for vector
+
+#include "exec/exec.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "specs/flags.hpp"
+#include "specs/native.hpp"
+#include "translator/errors.hpp"
+#include "utils/error.hpp"
+
+namespace karma {
+
+namespace arch   = detail::specs::arch;
+namespace cmd    = detail::specs::cmd;
+namespace flags  = detail::specs::flags;
+namespace native = detail::specs::native;
+
+namespace {
+
+// the words are emitted as unsigned hexadecimal literals,
+// so that the arithmetic of the generated code wraps around
+std::string Hex(arch::Word word) {
+    std::ostringstream ss;
+    ss << "0x" << std::hex << word << 'u';
+    return ss.str();
+}
+
+// the declarations of the specs/native.hpp file in C,
+// the other macros are only used by the generated code itself
+const char* const kPrologue = R"(#include <stdint.h>
+
+struct karma_native_context {
+    uint32_t* registers;
+    uint32_t* flags;
+    uint32_t* memory;
+    uint8_t* dirty_pages;
+
+    uint64_t* retired;
+
+    uint64_t memory_reads;
+    uint64_t memory_writes;
+    uint64_t calls;
+    uint64_t returns;
+
+    uint32_t code_end;
+    uint32_t stack_limit;
+    uint32_t lowest_push;
+
+    void* executor;
+
+    int32_t (*step)(struct karma_native_context*, uint32_t);
+};
+
+/* execute the command with the step function, the translated code
+   is continued from the next command unless the command has jumped */
+#define STEP(address)                       \
+    do {                                    \
+        if (c->step(c, (address)) != 0) {   \
+            return STOPPED;                 \
+        }                                   \
+        if (r[15] != (address) + 1u) {      \
+            goto dispatch;                  \
+        }                                   \
+    } while (0)
+
+#define RETIRE(code) ++c->retired[(code)]
+
+#define COMPARE(lhs, rhs)                                           \
+    do {                                                            \
+        const uint32_t lhs_ = (lhs);                                \
+        const uint32_t rhs_ = (rhs);                                \
+        *f = lhs_ < rhs_ ? LESS : (lhs_ > rhs_ ? GREATER : EQUAL);  \
+    } while (0)
+
+#define WRITE(address, value)                          \
+    do {                                               \
+        m[(address)] = (value);                        \
+        c->dirty_pages[(address) >> PAGE_SHIFT] = 1;   \
+        ++c->memory_writes;                            \
+    } while (0)
+
+#define PUSHED(address)                   \
+    do {                                  \
+        if ((address) < c->lowest_push) { \
+            c->lowest_push = (address);   \
+        }                                 \
+    } while (0)
+)";
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Analysis                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+Translator::Impl::Command Translator::Impl::Decode(cmd::Bin command) {
+    // an unknown command is left for the executor to report
+    const cmd::args::AnyArgs args = cmd::parse::Any(command);
+
+    return {
+        .code    = cmd::GetCode(command),
+        .recv    = args.recv,
+        .src     = args.src,
+        .operand = args.operand,
+    };
+}
+
+std::vector<uint8_t> Translator::Impl::FindLeaders(const Exec::Data& data) {
+    const size_t size = data.code.size();
+
+    std::vector<uint8_t> leaders(size, 0);
+
+    if (data.entrypoint < size) {
+        leaders[data.entrypoint] = 1;
+    }
+
+    for (Address address = 0; address < size; ++address) {
+        const Command command = Decode(data.code[address]);
+        cmd::MarkLeaders(command.code, command.operand, address, leaders);
+
+        // unlike the JIT compiled blocks, the translated code is also
+        // continued after the system calls, which may stop the execution
+        if (command.code == cmd::SYSCALL && address + 1 < size) {
+            leaders[address + 1] = 1;
+        }
+    }
+
+    return leaders;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Emitting                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+void Translator::Impl::EmitPrologue(const Exec::Data& data,
+                                    const std::string& src,
+                                    std::ostream& out) {
+    out << "/* generated by the karma translator from " << std::quoted(src)
+        << " */\n\n"
+        << kPrologue << '\n';
+
+    out << "#define MEMORY_SIZE " << Hex(arch::kMemorySize) << '\n'
+        << "#define CODE_END "
+        << Hex(static_cast<arch::Word>(data.code.size())) << '\n'
+        << "#define PAGE_SHIFT " << native::kPageShift << "\n\n";
+
+    out << "#define EQUAL " << Hex(flags::kEqual) << '\n'
+        << "#define GREATER " << Hex(flags::kGreater) << '\n'
+        << "#define LESS " << Hex(flags::kLess) << "\n\n";
+
+    out << "#define UNHANDLED " << native::UNHANDLED << '\n'
+        << "#define LEFT " << native::LEFT << '\n'
+        << "#define STOPPED " << native::STOPPED << "\n\n";
+
+    // the code is exported to check that the module is executed
+    // for the same program it has been translated from
+    out << "const uint32_t " << native::kAbiSymbol << " = "
+        << native::kAbiVersion << ";\n"
+        << "const uint32_t " << native::kCodeSizeSymbol << " = "
+        << data.code.size() << ";\n"
+        << "const uint32_t " << native::kCodeSymbol << "[] = {";
+
+    for (size_t i = 0; i < data.code.size(); ++i) {
+        out << (i % 8 == 0 ? "\n    " : " ") << Hex(data.code[i]) << ',';
+    }
+
+    // an empty initializer is not allowed in C
+    if (data.code.empty()) {
+        out << "0u";
+    }
+
+    out << "\n};\n\n";
+}
+
+void Translator::Impl::EmitDispatch(const std::vector<uint8_t>& leaders,
+                                    const std::string& status,
+                                    std::ostream& out) {
+    out << "    switch (r[15]) {\n";
+
+    for (Address address = 0; address < leaders.size(); ++address) {
+        if (leaders[address] != 0) {
+            out << "        case " << address << "u: goto L" << address
+                << ";\n";
+        }
+    }
+
+    out << "        default: return " << status << ";\n"
+        << "    }\n";
+}
+
+void Translator::Impl::EmitJump(Address dst,
+                                const std::vector<uint8_t>& leaders,
+                                std::ostream& out) {
+    if (dst < leaders.size() && leaders[dst] != 0) {
+        out << "goto L" << dst << ';';
+        return;
+    }
+
+    out << "r[15] = " << Hex(dst) << "; goto dispatch;";
+}
+
+// NOLINTNEXTLINE(*-function-size)
+void Translator::Impl::EmitCommand(const Command& command,
+                                   Address address,
+                                   const std::vector<uint8_t>& leaders,
+                                   std::ostream& out) {
+    const std::string a   = Hex(address);
+    const std::string op  = Hex(command.operand);
+    const std::string rr  = "r[" + std::to_string(command.recv) + "]";
+    const std::string rs  = "r[" + std::to_string(command.src) + "]";
+    const std::string rhs = rs + " + " + op;
+
+    const std::string retire =
+        "RETIRE(" + std::to_string(static_cast<arch::Word>(command.code)) +
+        ");";
+    const std::string step = "STEP(" + a + ");";
+
+    // the commands reading or writing the instruction register
+    // directly are left for the step function to keep its value
+    // up to date (the translated code only updates it on the jumps)
+    bool uses_ip = false;
+    if (cmd::kCodeToFormat.contains(command.code)) {
+        switch (cmd::kCodeToFormat.at(command.code)) {
+            case cmd::RR: {
+                uses_ip = command.recv == arch::kInstructionRegister ||
+                          command.src == arch::kInstructionRegister;
+                break;
+            }
+
+            case cmd::RM:
+            case cmd::RI: {
+                uses_ip = command.recv == arch::kInstructionRegister;
+                break;
+            }
+
+            case cmd::J: {
+                break;
+            }
+        }
+    }
+
+    const auto binary = [&](const std::string& assign) {
+        out << retire << ' ' << rr << ' ' << assign << ' ' << rhs << ';';
+    };
+
+    const auto immediate = [&](const std::string& assign) {
+        out << retire << ' ' << rr << ' ' << assign << ' ' << op << ';';
+    };
+
+    const auto conditional_jump = [&](flags::Flag flag) {
+        out << retire << " if ((*f & " << Hex(flag) << ") != 0) { ";
+        EmitJump(command.operand, leaders, out);
+        out << " }";
+    };
+
+    out << "    ";
+
+    if (uses_ip) {
+        out << step << '\n';
+        return;
+    }
+
+    switch (command.code) {
+        case cmd::ADD: {
+            binary("+=");
+            break;
+        }
+
+        case cmd::ADDI: {
+            immediate("+=");
+            break;
+        }
+
+        case cmd::SUB: {
+            binary("-=");
+            break;
+        }
+
+        case cmd::SUBI: {
+            immediate("-=");
+            break;
+        }
+
+        case cmd::MUL:
+        case cmd::MULI: {
+            // the product is written to two registers
+            if (command.recv + 1 >= arch::kInstructionRegister) {
+                out << step;
+                break;
+            }
+
+            const std::string factor = command.code == cmd::MUL ? rhs : op;
+            out << "{ const uint64_t x = (uint64_t)" << rr
+                << " * (uint64_t)(uint32_t)(" << factor << "); " << retire
+                << ' ' << rr << " = (uint32_t)x; r[" << command.recv + 1
+                << "] = (uint32_t)(x >> 32); }";
+            break;
+        }
+
+        case cmd::NOT: {
+            out << retire << ' ' << rr << " = ~" << rr << ';';
+            break;
+        }
+
+        case cmd::SHL:
+        case cmd::SHR: {
+            const char* shift = command.code == cmd::SHL ? "<<=" : ">>=";
+            out << "{ const uint32_t x = " << rhs << "; if (x < 32u) { "
+                << retire << ' ' << rr << ' ' << shift << " x; } else { "
+                << step << " } }";
+            break;
+        }
+
+        case cmd::SHLI:
+        case cmd::SHRI: {
+            if (command.operand >= 32) {
+                out << step;
+                break;
+            }
+
+            immediate(command.code == cmd::SHLI ? "<<=" : ">>=");
+            break;
+        }
+
+        case cmd::AND: {
+            binary("&=");
+            break;
+        }
+
+        case cmd::ANDI: {
+            immediate("&=");
+            break;
+        }
+
+        case cmd::OR: {
+            binary("|=");
+            break;
+        }
+
+        case cmd::ORI: {
+            immediate("|=");
+            break;
+        }
+
+        case cmd::XOR: {
+            binary("^=");
+            break;
+        }
+
+        case cmd::XORI: {
+            immediate("^=");
+            break;
+        }
+
+        case cmd::CMP: {
+            out << retire << " COMPARE(" << rr << ", " << rhs << ");";
+            break;
+        }
+
+        case cmd::CMPI: {
+            out << retire << " COMPARE(" << rr << ", " << op << ");";
+            break;
+        }
+
+        case cmd::JMP: {
+            out << retire << ' ';
+            EmitJump(command.operand, leaders, out);
+            break;
+        }
+
+        case cmd::JNE: {
+            conditional_jump(flags::NOT_EQUAL);
+            break;
+        }
+
+        case cmd::JEQ: {
+            conditional_jump(flags::EQUAL);
+            break;
+        }
+
+        case cmd::JLE: {
+            conditional_jump(flags::LESS_OR_EQUAL);
+            break;
+        }
+
+        case cmd::JL: {
+            conditional_jump(flags::LESS);
+            break;
+        }
+
+        case cmd::JGE: {
+            conditional_jump(flags::GREATER_OR_EQUAL);
+            break;
+        }
+
+        case cmd::JG: {
+            conditional_jump(flags::GREATER);
+            break;
+        }
+
+        case cmd::PUSH: {
+            out << "{ const uint32_t v = " << rr << " + " << op
+                << "; const uint32_t sp = r[14]; if (sp < MEMORY_SIZE && sp "
+                   ">= c->stack_limit) { "
+                << retire
+                << " WRITE(sp, v); PUSHED(sp); r[14] = sp - 1u; } else { "
+                << step << " } }";
+            break;
+        }
+
+        case cmd::POP: {
+            out << "{ const uint32_t a = r[14] + 1u; if (a < MEMORY_SIZE) { "
+                << retire << " r[14] = a; " << rr << " = m[a] + " << op
+                << "; ++c->memory_reads; } else { " << step << " } }";
+            break;
+        }
+
+        case cmd::LC:
+        case cmd::LA: {
+            immediate("=");
+            break;
+        }
+
+        case cmd::MOV: {
+            binary("=");
+            break;
+        }
+
+        case cmd::LOAD: {
+            out << retire << ' ' << rr << " = m[" << op
+                << "]; ++c->memory_reads;";
+            break;
+        }
+
+        case cmd::STORE: {
+            // the writes to the code are left for the step function,
+            // so that the executor notices the modification of the code
+            if (command.operand < leaders.size()) {
+                out << step;
+                break;
+            }
+
+            out << retire << " WRITE(" << op << ", " << rr << ");";
+            break;
+        }
+
+        case cmd::LOADR: {
+            out << "{ const uint32_t a = " << rhs
+                << "; if (a < MEMORY_SIZE) { " << retire << ' ' << rr
+                << " = m[a]; ++c->memory_reads; } else { " << step << " } }";
+            break;
+        }
+
+        case cmd::STORER: {
+            out << "{ const uint32_t a = " << rhs
+                << "; if (a >= CODE_END && a < MEMORY_SIZE) { " << retire
+                << " WRITE(a, " << rr << "); } else { " << step << " } }";
+            break;
+        }
+
+        case cmd::PRC: {
+            out << "{ const uint32_t sp = r[14]; if (sp < MEMORY_SIZE && sp >= "
+                   "c->stack_limit) { "
+                << retire
+                << " WRITE(sp, r[13]); PUSHED(sp); r[14] = sp - 1u; r[13] = "
+                   "r[14]; } else { "
+                << step << " } }";
+            break;
+        }
+
+        case cmd::CALLI: {
+            // both the return address and the call frame are pushed
+            out << "{ const uint32_t sp = r[14]; if (sp < MEMORY_SIZE && sp > "
+                   "c->stack_limit) { "
+                << retire << " ++c->calls; WRITE(sp, " << Hex(address + 1)
+                << "); WRITE(sp - 1u, r[13]); PUSHED(sp - 1u); r[14] = sp - "
+                   "2u; r[13] = r[14]; ";
+            EmitJump(command.operand, leaders, out);
+            out << " } else { " << step << " } }";
+            break;
+        }
+
+        case cmd::RET: {
+            // the return address and the caller call frame are read
+            // relatively to the call frame, and then the caller call frame
+            // is restored the same way as the CommonExecutor::Return does
+            out << "{ const uint32_t fp = r[13]; if (fp < MEMORY_SIZE - 2u && "
+                   "m[fp + 1u] < MEMORY_SIZE - 1u) { "
+                << retire
+                << " ++c->returns; const uint32_t caller = m[fp + 1u]; r[15] "
+                   "= m[fp + 2u]; r[14] = caller + 1u; r[13] = m[caller + 1u]; "
+                   "c->memory_reads += 3u; goto dispatch; } else { "
+                << step << " } }";
+            break;
+        }
+
+        default: {
+            // the system calls, the divisions, the real-valued operations,
+            // the two-word transfers, the calls by register, the bulk memory
+            // operations and the atomic operations (the threads are never
+            // run by the native modules)
+            out << step;
+            break;
+        }
+    }
+
+    out << '\n';
+}
+
+void Translator::Impl::EmitSource(const Exec::Data& data,
+                                  const std::string& src,
+                                  std::ostream& out) {
+    const std::vector<uint8_t> leaders = FindLeaders(data);
+
+    EmitPrologue(data, src, out);
+
+    out << "int32_t " << native::kRunSymbol
+        << "(struct karma_native_context* c) {\n"
+        << "    uint32_t* const r = c->registers;\n"
+        << "    uint32_t* const f = c->flags;\n"
+        << "    uint32_t* const m = c->memory;\n"
+        // the programs without the comparisons or the memory accesses
+        // do not use the flags or the memory
+        << "    (void)f;\n"
+        << "    (void)m;\n\n";
+
+    EmitDispatch(leaders, "UNHANDLED", out);
+
+    out << "\ndispatch:\n";
+
+    EmitDispatch(leaders, "LEFT", out);
+
+    for (Address address = 0; address < data.code.size(); ++address) {
+        const Command command = Decode(data.code[address]);
+
+        out << '\n';
+
+        if (leaders[address] != 0) {
+            out << 'L' << address << ":\n";
+        }
+
+        const auto name = cmd::kCodeToName.find(command.code);
+        out << "    /* " << address << ": "
+            << (name == cmd::kCodeToName.end() ? "unknown" : name->second)
+            << " */\n";
+
+        EmitCommand(command, address, leaders, out);
+    }
+
+    // the execution has run past the end of the code
+    out << "\n    r[15] = CODE_END;\n"
+        << "    return LEFT;\n"
+        << "}\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///                                Translating                               ///
+////////////////////////////////////////////////////////////////////////////////
+
+void Translator::Impl::CompileSource(const std::string& source,
+                                     const std::string& module,
+                                     std::ostream& log) {
+    // the C compiler is chosen the same way as by make, but its words
+    // are only split by the whitespace rather than expanded by a shell,
+    // so the paths are passed to it as they are
+    const char* compiler = std::getenv("CC");
+
+    std::vector<std::string> args;
+    {
+        std::istringstream words(
+            compiler != nullptr && *compiler != '\0' ? compiler : "cc");
+
+        for (std::string word; words >> word;) {
+            args.push_back(std::move(word));
+        }
+    }
+
+    if (args.empty()) {
+        args.emplace_back("cc");
+    }
+
+    args.insert(args.end(), {"-O2", "-fPIC", "-shared", "-o", module, source});
+
+    std::ostringstream ss;
+    for (const std::string& arg : args) {
+        ss << (&arg == &args.front() ? "" : " ") << std::quoted(arg);
+    }
+
+    const std::string command = ss.str();
+
+    log << "[translator]: running " << command << '\n';
+
+    std::vector<char*> argv;
+    for (std::string& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+    if (const int error = posix_spawnp(
+            &pid, argv.front(), nullptr, nullptr, argv.data(), environ);
+        error != 0) {
+        throw TranslateError::CompilerNotStarted(command, error);
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            throw TranslateError::CompilerNotStarted(command, errno);
+        }
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw TranslateError::CompilerFailed(command, status);
+    }
+}
+
+void Translator::Impl::TranslateImpl(const std::string& src,
+                                     const std::string& dst,
+                                     std::ostream& log) {
+    std::filesystem::path module = dst;
+    if (module.empty()) {
+        const std::filesystem::path src_path(src);
+
+        module = src_path.parent_path();
+        module /= src_path.stem();
+        module += ".so";
+    }
+
+    // the generated source is kept next to the module for the inspection
+    std::filesystem::path source = module;
+    source.replace_extension(".c");
+
+    log << "[translator]: reading the executable file\n";
+
+    const Exec::Data data = Exec::Read(src);
+
+    log << "[translator]: successfully read the executable file\n";
+
+    log << "[translator]: generating the C source\n";
+
+    {
+        std::ofstream out(source);
+        if (out.fail()) {
+            throw InternalError::FailedToOpen(source.string());
+        }
+
+        EmitSource(data, src, out);
+    }
+
+    log << "[translator]: successfully generated the C source\n";
+
+    log << "[translator]: compiling the native module\n";
+
+    CompileSource(source.string(), module.string(), log);
+
+    log << "[translator]: successfully compiled the native module\n";
+}
+
+void Translator::Impl::MustTranslate(const std::string& src,
+                                     const std::string& dst,
+                                     std::ostream& log) {
+    using std::string_literals::operator""s;
+
+    try {
+        TranslateImpl(src, dst, log);
+    } catch (const errors::translator::Error& e) {
+        log << "[translator]: error: " << e.what() << '\n';
+        throw;
+    } catch (const errors::Error& e) {
+        log << "[translator]: error: " << e.what() << '\n';
+        throw errors::translator::Error(
+            "error during translation process "
+            "(not directly related to the translation itself): "s +
+            e.what());
+    } catch (const std::exception& e) {
+        log << "[translator]: unexpected exception: " << e.what() << '\n';
+        throw errors::translator::Error(
+            "unexpected exception in translator: "s + e.what());
+    } catch (...) {
+        log << "[translator]: unexpected exception\n";
+        throw errors::translator::Error(
+            "unexpected exception in translator "
+            "(no additional info can be provided)");
+    }
+}
+
+void Translator::Impl::Translate(const std::string& src,
+                                 const std::string& dst,
+                                 std::ostream& log) {
+    try {
+        MustTranslate(src, dst, log);
+    } catch (const errors::Error& e) {
+        std::cerr << e.what() << '\n';
+    }
+}
+
+}  // namespace karma
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>  // for uint8_t
+#include <ostream>  // for ostream
+#include <string>   // for string
+#include <vector>   // for vector
+
+#include "exec/exec.hpp"
+#include "specs/architecture.hpp"
+#include "specs/commands.hpp"
+#include "translator/errors.hpp"
+#include "translator/translator.hpp"
+#include "utils/traits.hpp"
+
+namespace karma {
+
+class Translator::Impl : detail::utils::traits::Static {
+   private:
+    using InternalError  = errors::translator::InternalError::Builder;
+    using TranslateError = errors::translator::TranslateError::Builder;
+
+    using Address = detail::specs::arch::Address;
+
+    // the command operands decoded the same way as the executor does
+    struct Command {
+        detail::specs::cmd::Code code;
+
+        detail::specs::cmd::args::Register recv;
+        detail::specs::cmd::args::Source src;
+
+        // the address, the sign-extended modifier or immediate
+        detail::specs::arch::Word operand;
+    };
+
+   private:
+    static Command Decode(detail::specs::cmd::Bin);
+
+    // the commands the execution may enter the translated code at: the entry
+    // point, the targets of the jumps and the calls, and the commands
+    // following the jumps, the calls and the system calls
+    static std::vector<uint8_t> FindLeaders(const Exec::Data&);
+
+    static void EmitPrologue(const Exec::Data&,
+                             const std::string& src,
+                             std::ostream&);
+
+    // the switch over the leaders, the execution returns the status
+    // if the instruction register does not point to a leader
+    static void EmitDispatch(const std::vector<uint8_t>& leaders,
+                             const std::string& status,
+                             std::ostream&);
+
+    static void EmitJump(Address dst,
+                         const std::vector<uint8_t>& leaders,
+                         std::ostream&);
+
+    // emits the command as C code (or as the call of the step function for
+    // the commands which may fail or are too rare to be worth translating)
+    static void EmitCommand(const Command&,
+                            Address,
+                            const std::vector<uint8_t>& leaders,
+                            std::ostream&);
+
+    static void EmitSource(const Exec::Data&,
+                           const std::string& src,
+                           std::ostream&);
+
+    static void CompileSource(const std::string& source,
+                              const std::string& module,
+                              std::ostream& log);
+
+    static void TranslateImpl(const std::string& src,
+                              const std::string& dst,
+                              std::ostream& log);
+
+   public:
+    static void MustTranslate(const std::string& src,
+                              const std::string& dst,
+                              std::ostream& log);
+
+    static void Translate(const std::string& src,
+                          const std::string& dst,
+                          std::ostream& log);
+};
+
+}  // namespace karma
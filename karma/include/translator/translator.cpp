@@ -0,0 +1,30 @@
+#include "translator.hpp"
+
+#include <string>  // for string
+
+#include "translator/impl.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+void Translator::MustTranslate(const std::string& src,
+                               const std::string& dst,
+                               Logger log) {
+    Impl::MustTranslate(src, dst, log.log);
+}
+
+void Translator::Translate(const std::string& src,
+                           const std::string& dst,
+                           Logger log) {
+    Impl::Translate(src, dst, log.log);
+}
+
+void Translator::MustTranslate(const std::string& src, Logger log) {
+    MustTranslate(src, "", log);
+}
+
+void Translator::Translate(const std::string& src, Logger log) {
+    Translate(src, "", log);
+}
+
+}  // namespace karma
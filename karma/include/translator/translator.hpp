@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>  // for string
+
+#include "utils/error.hpp"
+#include "utils/logger.hpp"
+
+namespace karma {
+
+namespace errors::translator {
+
+struct Error;
+struct InternalError;
+struct TranslateError;
+
+}  // namespace errors::translator
+
+class Translator {
+   private:
+    friend struct errors::translator::Error;
+    friend struct errors::translator::InternalError;
+    friend struct errors::translator::TranslateError;
+
+   private:
+    class Impl;
+
+   public:
+    // utils::traits::Static
+
+    // do not include utils/traits, because we don't want to expose
+    // internal features of the karma library to the user
+
+    Translator()  = delete;
+    ~Translator() = delete;
+
+    Translator(const Translator&)            = delete;
+    Translator& operator=(const Translator&) = delete;
+
+    Translator(Translator&&)            = delete;
+    Translator& operator=(Translator&&) = delete;
+
+   public:
+    // translates the Karma executable file to C and compiles it with
+    // the system C compiler into a native module (a shared object),
+    // which can be executed with the NATIVE engine of the executor
+    // (see Executor::Config::SetNativeModule)
+
+    static void MustTranslate(const std::string& src,
+                              const std::string& dst = "",
+                              Logger log             = Logger::NoOp());
+
+    static void Translate(const std::string& src,
+                          const std::string& dst = "",
+                          Logger log             = Logger::NoOp());
+
+    static void MustTranslate(const std::string& src, Logger log);
+
+    static void Translate(const std::string& src, Logger log);
+};
+
+namespace errors::translator {
+
+struct Error : errors::Error {
+   private:
+    friend class Translator::Impl;
+
+   protected:
+    explicit Error(const std::string& message)
+        : errors::Error(message) {}
+};
+
+struct InternalError : Error {
+   private:
+    friend class Translator::Impl;
+
+   private:
+    struct Builder;
+
+   private:
+    explicit InternalError(const std::string& message)
+        : Error("internal translator error: " + message) {}
+};
+
+struct TranslateError : Error {
+   private:
+    friend class Translator::Impl;
+
+   private:
+    struct Builder;
+
+   private:
+    explicit TranslateError(const std::string& message)
+        : Error("translation error: " + message) {}
+};
+
+}  // namespace errors::translator
+
+}  // namespace karma